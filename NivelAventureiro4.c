@@ -2,6 +2,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+#define MAXPISTA 100
+#define ARENA_BLOCO (64 * 1024)  // tamanho padrao de cada bloco da arena
+#define ALTURA_MAX_AVL 64     // altura maxima possivel de uma AVL com 2^44 nos
+#define BUFFER_SAIDA 4096     // buffer da listagem de pistas (maior que uma linha)
+
 // ============================
 // ESTRUTURAS DE DADOS
 // ============================
@@ -9,18 +14,39 @@
 // Estrutura para representar uma sala da mansao
 typedef struct Sala {
     char nome[50];
-    char pista[100];
+    char pista[MAXPISTA];
     struct Sala *esquerda;
     struct Sala *direita;
 } Sala;
 
-// Estrutura para representar um no da arvore de pistas (BST)
+// Estrutura para representar um no da arvore de pistas (AVL)
+// o texto da pista fica na arena, logo apos o proprio no
 typedef struct PistaNode {
-    char pista[100];
+    char *pista;
     struct PistaNode *esquerda;
     struct PistaNode *direita;
+    int altura;
 } PistaNode;
 
+// Bloco de memoria de uma arena (alocacao sequencial, liberado de uma vez)
+typedef struct BlocoArena {
+    struct BlocoArena *anterior;
+    size_t capacidade;
+    size_t usados;
+    _Alignas(16) unsigned char dados[];
+} BlocoArena;
+
+typedef struct Arena {
+    BlocoArena *atual;
+} Arena;
+
+// Colecao de pistas coletadas: raiz da AVL + arena que guarda os nos
+typedef struct ArvorePistas {
+    PistaNode *raiz;
+    size_t total;
+    Arena arena;
+} ArvorePistas;
+
 // ============================
 // FUNCOES PARA SALAS
 // ============================
@@ -39,47 +65,179 @@ Sala* criarSala(const char *nome, const char *pista) {
     return novaSala;
 }
 
+// Libera a sala e todas as salas abaixo dela (pos-ordem), qualquer que seja o formato do mapa
+void liberarSalas(Sala *raiz) {
+    if (raiz == NULL) return;
+    liberarSalas(raiz->esquerda);
+    liberarSalas(raiz->direita);
+    free(raiz);
+}
+
 // ============================
-// FUNCOES PARA A ARVORE DE PISTAS (BST)
+// ARENA DE MEMORIA
 // ============================
 
-// Insere uma pista na BST em ordem alfabetica
-PistaNode* inserirPista(PistaNode *raiz, const char *pista) {
-    if (pista == NULL || strlen(pista) == 0)
-        return raiz; // ignora pistas vazias
-
-    if (raiz == NULL) {
-        PistaNode *novo = (PistaNode*) malloc(sizeof(PistaNode));
-        strcpy(novo->pista, pista);
-        novo->esquerda = NULL;
-        novo->direita = NULL;
-        return novo;
+// aloca um bloco novo para a arena com pelo menos 'minimo' bytes livres
+static void arenaNovoBloco(Arena *a, size_t minimo) {
+    size_t cap = minimo > ARENA_BLOCO ? minimo : ARENA_BLOCO;
+    BlocoArena *b = (BlocoArena*) malloc(sizeof(BlocoArena) + cap);
+    if (b == NULL) { printf("Erro ao alocar memoria para a arena.\n"); exit(1); }
+    b->anterior = a->atual;
+    b->capacidade = cap;
+    b->usados = 0;
+    a->atual = b;
+}
+
+// inicializa uma arena vazia (o primeiro bloco so e criado na primeira alocacao)
+void inicializarArena(Arena *a) {
+    a->atual = NULL;
+}
+
+// arenaAlocar() – reserva 'tam' bytes alinhados a 16 (bump allocation)
+void* arenaAlocar(Arena *a, size_t tam) {
+    tam = (tam + 15) & ~(size_t)15;
+    if (a->atual == NULL || a->atual->capacidade - a->atual->usados < tam)
+        arenaNovoBloco(a, tam);
+    void *p = a->atual->dados + a->atual->usados;
+    a->atual->usados += tam;
+    return p;
+}
+
+// libera todos os blocos da arena de uma vez
+void liberarArena(Arena *a) {
+    BlocoArena *b = a->atual;
+    while (b != NULL) {
+        BlocoArena *ant = b->anterior;
+        free(b);
+        b = ant;
     }
+    a->atual = NULL;
+}
+
+// ============================
+// FUNCOES PARA A ARVORE DE PISTAS (AVL)
+// ============================
+
+static int alturaNo(const PistaNode *n) {
+    return n != NULL ? n->altura : 0;
+}
 
-    if (strcmp(pista, raiz->pista) < 0)
-        raiz->esquerda = inserirPista(raiz->esquerda, pista);
-    else if (strcmp(pista, raiz->pista) > 0)
-        raiz->direita = inserirPista(raiz->direita, pista);
+static void atualizarAltura(PistaNode *n) {
+    int he = alturaNo(n->esquerda), hd = alturaNo(n->direita);
+    n->altura = 1 + (he > hd ? he : hd);
+}
 
-    return raiz;
+static PistaNode* rotacionarDireita(PistaNode *y) {
+    PistaNode *x = y->esquerda;
+    y->esquerda = x->direita;
+    x->direita = y;
+    atualizarAltura(y);
+    atualizarAltura(x);
+    return x;
 }
 
-// Exibe as pistas em ordem alfabetica (in-order)
-void exibirPistas(PistaNode *raiz) {
-    if (raiz != NULL) {
-        exibirPistas(raiz->esquerda);
-        printf("- %s\n", raiz->pista);
-        exibirPistas(raiz->direita);
+static PistaNode* rotacionarEsquerda(PistaNode *x) {
+    PistaNode *y = x->direita;
+    x->direita = y->esquerda;
+    y->esquerda = x;
+    atualizarAltura(x);
+    atualizarAltura(y);
+    return y;
+}
+
+// restaura o balanceamento AVL de um no e devolve a nova raiz da subarvore
+static PistaNode* balancear(PistaNode *n) {
+    atualizarAltura(n);
+    int fator = alturaNo(n->esquerda) - alturaNo(n->direita);
+    if (fator > 1) {
+        if (alturaNo(n->esquerda->esquerda) < alturaNo(n->esquerda->direita))
+            n->esquerda = rotacionarEsquerda(n->esquerda);
+        return rotacionarDireita(n);
+    }
+    if (fator < -1) {
+        if (alturaNo(n->direita->direita) < alturaNo(n->direita->esquerda))
+            n->direita = rotacionarDireita(n->direita);
+        return rotacionarEsquerda(n);
     }
+    return n;
 }
 
-// Libera memoria da arvore de pistas
-void liberarPistas(PistaNode *raiz) {
-    if (raiz != NULL) {
-        liberarPistas(raiz->esquerda);
-        liberarPistas(raiz->direita);
-        free(raiz);
+// inicializa a colecao de pistas vazia
+void inicializarPistas(ArvorePistas *arv) {
+    arv->raiz = NULL;
+    arv->total = 0;
+    inicializarArena(&arv->arena);
+}
+
+// inserirPista() – insere a pista coletada na AVL (ignora duplicatas e pistas vazias)
+// retorna 1 se a pista foi inserida e 0 caso contrario
+int inserirPista(ArvorePistas *arv, const char *pista) {
+    if (pista == NULL || pista[0] == '\0') return 0; // ignora
+    PistaNode **caminho[ALTURA_MAX_AVL];
+    int prof = 0;
+    PistaNode **p = &arv->raiz;
+    while (*p != NULL) {
+        int cmp = strcmp(pista, (*p)->pista);
+        if (cmp == 0) return 0; // se igual, nao insere duplicata
+        caminho[prof++] = p;
+        p = (cmp < 0) ? &(*p)->esquerda : &(*p)->direita;
     }
+
+    // no e texto vem da arena da colecao
+    size_t n = strlen(pista);
+    if (n > MAXPISTA-1) n = MAXPISTA-1;
+    PistaNode *novo = (PistaNode*) arenaAlocar(&arv->arena, sizeof(PistaNode) + n + 1);
+    novo->pista = (char*) (novo + 1);
+    memcpy(novo->pista, pista, n);
+    novo->pista[n] = '\0';
+    novo->esquerda = novo->direita = NULL;
+    novo->altura = 1;
+    *p = novo;
+    arv->total++;
+
+    // sobe pelo caminho rebalanceando; para quando a altura deixa de mudar
+    while (prof > 0) {
+        PistaNode **q = caminho[--prof];
+        int alturaAntes = (*q)->altura;
+        *q = balancear(*q);
+        if ((*q)->altura == alturaAntes) break;
+    }
+    return 1;
+}
+
+// Exibe as pistas em ordem alfabetica (in-order iterativo)
+// as linhas sao acumuladas em um buffer e escritas de uma vez quando ele enche
+void exibirPistas(const ArvorePistas *arv) {
+    char buffer[BUFFER_SAIDA];
+    size_t usado = 0;
+    PistaNode *pilha[ALTURA_MAX_AVL];
+    int topo = 0;
+    PistaNode *cur = arv->raiz;
+    while (cur != NULL || topo > 0) {
+        while (cur != NULL) {
+            pilha[topo++] = cur;
+            cur = cur->esquerda;
+        }
+        cur = pilha[--topo];
+        size_t n = strlen(cur->pista);
+        if (usado + n + 3 > sizeof buffer) {
+            fwrite(buffer, 1, usado, stdout);
+            usado = 0;
+        }
+        memcpy(buffer + usado, "- ", 2);
+        memcpy(buffer + usado + 2, cur->pista, n);
+        buffer[usado + 2 + n] = '\n';
+        usado += n + 3;
+        cur = cur->direita;
+    }
+    fwrite(buffer, 1, usado, stdout);
+}
+
+// Libera memoria da arvore de pistas (uma unica operacao sobre a arena)
+void liberarPistas(ArvorePistas *arv) {
+    liberarArena(&arv->arena);
+    arv->raiz = NULL;
+    arv->total = 0;
 }
 
 // ============================
@@ -87,7 +245,7 @@ void liberarPistas(PistaNode *raiz) {
 // ============================
 
 // Permite explorar as salas da mansao e coletar pistas
-void explorarSalasComPistas(Sala *salaAtual, PistaNode **raizPistas) {
+void explorarSalasComPistas(Sala *salaAtual, ArvorePistas *pistas) {
     char escolha;
 
     while (salaAtual != NULL) {
@@ -96,7 +254,7 @@ void explorarSalasComPistas(Sala *salaAtual, PistaNode **raizPistas) {
         // Coleta de pista, se houver
         if (strlen(salaAtual->pista) > 0) {
             printf("Voce encontrou uma pista: \"%s\"\n", salaAtual->pista);
-            *raizPistas = inserirPista(*raizPistas, salaAtual->pista);
+            inserirPista(pistas, salaAtual->pista);
         } else {
             printf("Nao ha pistas nesta sala.\n");
         }
@@ -109,7 +267,7 @@ void explorarSalasComPistas(Sala *salaAtual, PistaNode **raizPistas) {
             printf("  (d) Ir para %s\n", salaAtual->direita->nome);
         printf("  (s) Sair da exploracao\n");
         printf("Opcao: ");
-        scanf(" %c", &escolha);
+        if (scanf(" %c", &escolha) != 1) break; // fim da entrada
 
         if (escolha == 'e' && salaAtual->esquerda != NULL) {
             salaAtual = salaAtual->esquerda;
@@ -147,28 +305,23 @@ int main() {
     cozinha->direita = quarto;
 
     // Arvore de pistas (inicialmente vazia)
-    PistaNode *raizPistas = NULL;
+    ArvorePistas pistas;
+    inicializarPistas(&pistas);
 
     // Inicio do jogo
     printf("=== DETECTIVE QUEST: COLETA DE PISTAS ===\n");
-    explorarSalasComPistas(hall, &raizPistas);
+    explorarSalasComPistas(hall, &pistas);
 
     // Exibe pistas coletadas
     printf("\n===== PISTAS COLETADAS (ORDEM ALFABETICA) =====\n");
-    if (raizPistas == NULL)
+    if (pistas.raiz == NULL)
         printf("Nenhuma pista foi coletada.\n");
     else
-        exibirPistas(raizPistas);
+        exibirPistas(&pistas);
 
     // Libera memoria
-    free(hall);
-    free(salaEstar);
-    free(cozinha);
-    free(biblioteca);
-    free(jardim);
-    free(porao);
-    free(quarto);
-    liberarPistas(raizPistas);
+    liberarSalas(hall);
+    liberarPistas(&pistas);
 
     printf("\nFim da investigacao. Ate a proxima, detetive!\n");
     return 0;
@@ -1,342 +1,292 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <ctype.h>
+// Compilar: make (ou make INSTRUMENTAR=1 para contadores, histogramas de latencia e memoria por categoria)
+// Com uma mansao fixa compilada em tabelas constantes: ./NivelMestre4 --gerar-c mapa.txt mansao.h
+// e make MANSAO_FIXA=mansao.h (a mansao e a hash deixam de ser montadas ao iniciar)
 
-#define MAXNOME 64
-#define MAXPISTA 128
-#define HASH_SIZE 101   // numero primo razoavel para tabela hash
+#include "NivelMestre4.h"
 
 // =========================
-// ESTRUTURAS
-// =========================
-
-// No da arvore binaria que representa cada sala da mansao
-typedef struct Sala {
-    char nome[MAXNOME];
-    char pista[MAXPISTA]; // string vazia se nao houver pista
-    struct Sala *esquerda;
-    struct Sala *direita;
-} Sala;
-
-// No da BST que armazena pistas coletadas (ordenadas)
-typedef struct PistaNode {
-    char pista[MAXPISTA];
-    struct PistaNode *esquerda;
-    struct PistaNode *direita;
-} PistaNode;
-
-// No da lista encadeada usada em cada bucket da hash (chave: pista, valor: suspeito)
-typedef struct HashNode {
-    char pista[MAXPISTA];
-    char suspeito[MAXNOME];
-    struct HashNode *proximo;
-} HashNode;
-
-// Tabela hash (array de ponteiros para HashNode)
-typedef struct HashTable {
-    HashNode *buckets[HASH_SIZE];
-} HashTable;
-
-// =========================
-// FUNCOES AUXILIARES
+// FUNCAO PRINCIPAL (main)
 // =========================
 
-// Converte string para minusculas (resultado em buffer, que deve ter espaco suficiente)
-void strToLower(const char *src, char *buffer) {
-    int i;
-    for (i = 0; src[i] != '\0' && i < MAXPISTA-1; ++i)
-        buffer[i] = (char) tolower((unsigned char) src[i]);
-    buffer[i] = '\0';
-}
 
-// Calcula hash simples a partir da string (usando djb2 mod HASH_SIZE)
-unsigned int hashFunc(const char *str) {
-    unsigned long hash = 5381;
-    int c;
-    while ((c = *str++))
-        hash = ((hash << 5) + hash) + (unsigned char)c; /* hash * 33 + c */
-    return (unsigned int)(hash % HASH_SIZE);
-}
+int main(int argc, char *argv[]) {
+    // semente dos hashes: aleatoria por execucao, ou fixa com --semente <n> (em qualquer posicao);
+    // --memoria e --alocador tambem valem em qualquer posicao e para todos os modos
+    inicializarSementeHash();
+    for (int i = 1; i + 1 < argc; ++i)
+        if (opcaoGlobal(argv[i])) { aplicarOpcaoGlobal(argv[i], argv[i + 1]); i++; }
 
-// =========================
-// FUNCOES PARA SALAS
-// =========================
-
-// criarSala() – cria dinamicamente um comodo (nome, pista)
-Sala* criarSala(const char *nome, const char *pista) {
-    Sala *nova = (Sala*) malloc(sizeof(Sala));
-    if (nova == NULL) {
-        printf("Erro: memoria insuficiente para criar sala.\n");
-        exit(1);
+    // modo compilacao: ./NivelMestre4 --compilar mapa.txt mapa.dqm
+    if (argc > 1 && strcmp(argv[1], "--compilar") == 0) {
+        if (argc != 4) {
+            printf("Uso: %s --compilar <mapa.txt> <mapa.dqm>\n", argv[0]);
+            return 1;
+        }
+        return compilarMansao(argv[2], argv[3]) ? 0 : 1;
     }
-    strncpy(nova->nome, nome, MAXNOME-1);
-    nova->nome[MAXNOME-1] = '\0';
-    if (pista != NULL)
-        strncpy(nova->pista, pista, MAXPISTA-1);
-    else
-        nova->pista[0] = '\0';
-    nova->pista[MAXPISTA-1] = '\0';
-    nova->esquerda = nova->direita = NULL;
-    return nova;
-}
 
-// =========================
-// FUNCOES PARA BST DE PISTAS
-// =========================
-
-// inserirPista() – insere a pista coletada na BST (ignora duplicatas e pistas vazias)
-PistaNode* inserirPista(PistaNode *raiz, const char *pista) {
-    if (pista == NULL || strlen(pista) == 0) return raiz; // ignora
-    if (raiz == NULL) {
-        PistaNode *novo = (PistaNode*) malloc(sizeof(PistaNode));
-        if (novo == NULL) { printf("Erro: memoria insuficiente (pista).\n"); exit(1); }
-        strncpy(novo->pista, pista, MAXPISTA-1);
-        novo->pista[MAXPISTA-1] = '\0';
-        novo->esquerda = novo->direita = NULL;
-        return novo;
+    // modo compilacao para C: ./NivelMestre4 --gerar-c mapa.txt mansao.h (ver gerarMansaoC)
+    if (argc > 1 && strcmp(argv[1], "--gerar-c") == 0) {
+        if (argc != 4) {
+            printf("Uso: %s --gerar-c <mapa.txt|mapa.dqm> <mansao.h|->\n", argv[0]);
+            printf("  depois: make MANSAO_FIXA=mansao.h\n");
+            return 1;
+        }
+        return gerarMansaoC(argv[2], argv[3]) ? 0 : 1;
     }
-    int cmp = strcmp(pista, raiz->pista);
-    if (cmp < 0) raiz->esquerda = inserirPista(raiz->esquerda, pista);
-    else if (cmp > 0) raiz->direita = inserirPista(raiz->direita, pista);
-    // se igual, nao insere duplicata
-    return raiz;
-}
-
-// exibirPistasInOrder - imprime as pistas em ordem alfabetica
-void exibirPistasInOrder(PistaNode *raiz) {
-    if (raiz == NULL) return;
-    exibirPistasInOrder(raiz->esquerda);
-    printf("- %s\n", raiz->pista);
-    exibirPistasInOrder(raiz->direita);
-}
-
-// liberar memoria da BST de pistas
-void liberarPistas(PistaNode *raiz) {
-    if (raiz == NULL) return;
-    liberarPistas(raiz->esquerda);
-    liberarPistas(raiz->direita);
-    free(raiz);
-}
-
-// =========================
-// FUNCOES PARA TABELA HASH
-// =========================
-
-// inicializa a hash (todos os buckets com NULL)
-void inicializarHash(HashTable *ht) {
-    for (int i = 0; i < HASH_SIZE; ++i) ht->buckets[i] = NULL;
-}
 
-// inserirNaHash() – insere associacao pista -> suspeito
-// se a pista ja existir, sobrescreve o suspeito
-void inserirNaHash(HashTable *ht, const char *pista, const char *suspeito) {
-    if (pista == NULL || strlen(pista) == 0) return;
-    unsigned int h = hashFunc(pista);
-    HashNode *cur = ht->buckets[h];
-    while (cur != NULL) {
-        if (strcmp(cur->pista, pista) == 0) {
-            // atualiza suspeito
-            strncpy(cur->suspeito, suspeito, MAXNOME-1);
-            cur->suspeito[MAXNOME-1] = '\0';
-            return;
+    // modo gerador: ./NivelMestre4 --gerar grafo:1000000:semente=7 mapa.dqm ('-' = saida padrao)
+    if (argc > 1 && strcmp(argv[1], "--gerar") == 0) {
+        ParamGeracao g;
+        if (argc != 4) {
+            printf("Uso: %s --gerar <forma>:<salas>[:chave=valor...] <mapa.dqm|->\n", argv[0]);
+            printf("  formas: balanceada, degenerada, grafo\n");
+            printf("  chaves: semente, grau, densidade, pistas, nomes (aleatorio, ordenado, colidindo, longo),\n");
+            printf("          suspeitos, implicados, limiar\n");
+            return 1;
         }
-        cur = cur->proximo;
+        if (!lerParamGeracao(argv[2], &g)) return 1;
+        return gerarMansaoArquivo(&g, argv[3]) ? 0 : 1;
     }
-    // nao existe: cria novo no no inicio da lista
-    HashNode *novo = (HashNode*) malloc(sizeof(HashNode));
-    if (novo == NULL) { printf("Erro: memoria insuficiente (hash node).\n"); exit(1); }
-    strncpy(novo->pista, pista, MAXPISTA-1);
-    novo->pista[MAXPISTA-1] = '\0';
-    strncpy(novo->suspeito, suspeito, MAXNOME-1);
-    novo->suspeito[MAXNOME-1] = '\0';
-    novo->proximo = ht->buckets[h];
-    ht->buckets[h] = novo;
-}
 
-// encontrarSuspeito() – consulta o suspeito correspondente a uma pista
-// retorna NULL se nao encontrar
-const char* encontrarSuspeito(HashTable *ht, const char *pista) {
-    if (pista == NULL || strlen(pista) == 0) return NULL;
-    unsigned int h = hashFunc(pista);
-    HashNode *cur = ht->buckets[h];
-    while (cur != NULL) {
-        if (strcmp(cur->pista, pista) == 0)
-            return cur->suspeito;
-        cur = cur->proximo;
+    // opcoes gerais:
+    //   --replay <roteiros|->  reproduz roteiros sem interface ('-' = entrada padrao)
+    //   --threads <n>          trabalhadores do motor paralelo (replay e simulacao)
+    //   --resolver             lista, por suspeito, os caminhos que o condenam (ou um roteiro com 'v')
+    //   --relatorio <arq|->    ao fim do jogo, grava as pistas coletadas em JSON (uma por linha)
+    //   --salvar <arq>         grava o progresso a cada sala e retoma dele se o arquivo existir
+    //   --limiar <pontos>      pontos de evidencia para condenar (padrao: o do mapa, ou LIMIAR_CULPA)
+    //   --instrumentos <fmt>   com -DINSTRUMENTAR: despeja contadores em stderr ao sair ('texto' ou 'json');
+    //                          SIGUSR1 despeja a qualquer momento
+    //   --gerado <especif.>    gera a mansao em memoria em vez de carregar um mapa (ver --gerar)
+    //   --servir <socket>      atende jogadores num socket local, uma sessao por conexao (epoll)
+    //   --memoria <fmt>        com -DINSTRUMENTAR: ao sair, despeja em stderr a memoria por
+    //                          categoria, o pico e os vazamentos ('texto' ou 'json')
+    //   --alocador <modo>      nos das pistas coletadas: 'arena' (padrao), 'pool' ou 'sistema'
+    //   --simular <especif.>   investigacoes automaticas por estrategia em todos os nucleos (ou
+    //                          --threads), com resumo de condenacoes, pistas e caminhos (ver
+    //                          lerParamSimulacao)
+    //   --registros <arq|->    com --simular, grava tambem uma linha por agente (TSV)
+    //   [mapa]                 mapa texto ou binario (padrao: mansao embutida)
+    const char *roteiros = NULL, *caminhoMapa = NULL, *gerado = NULL, *servir = NULL;
+    const char *simular = NULL, *registros = NULL;
+    int numThreads = 0;
+    int resolver = 0;
+    const char *relatorio = NULL, *salvar = NULL;
+    const char *instrumentos = NULL;
+    long limiar = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) roteiros = argv[++i];
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) numThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--resolver") == 0) resolver = 1;
+        else if (strcmp(argv[i], "--relatorio") == 0 && i + 1 < argc) relatorio = argv[++i];
+        else if (strcmp(argv[i], "--salvar") == 0 && i + 1 < argc) salvar = argv[++i];
+        else if (strcmp(argv[i], "--instrumentos") == 0 && i + 1 < argc) instrumentos = argv[++i];
+        else if (strcmp(argv[i], "--gerado") == 0 && i + 1 < argc) gerado = argv[++i];
+        else if (strcmp(argv[i], "--servir") == 0 && i + 1 < argc) servir = argv[++i];
+        else if (strcmp(argv[i], "--simular") == 0 && i + 1 < argc) simular = argv[++i];
+        else if (strcmp(argv[i], "--registros") == 0 && i + 1 < argc) registros = argv[++i];
+        else if (strcmp(argv[i], "--limiar") == 0 && i + 1 < argc) {
+            limiar = atol(argv[++i]);
+            if (limiar <= 0 || limiar >= UINT32_MAX) {
+                printf("Erro: limiar invalido: %s (use um inteiro positivo)\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (opcaoGlobal(argv[i]) && i + 1 < argc) i++; // ja tratadas acima
+        else if (strncmp(argv[i], "--", 2) == 0) {
+            printf("Opcao desconhecida ou incompleta: %s\n", argv[i]);
+            return 1;
+        } else caminhoMapa = argv[i];
     }
-    return NULL;
-}
 
-// libera memoria da hash table
-void liberarHash(HashTable *ht) {
-    for (int i = 0; i < HASH_SIZE; ++i) {
-        HashNode *cur = ht->buckets[i];
-        while (cur != NULL) {
-            HashNode *tmp = cur;
-            cur = cur->proximo;
-            free(tmp);
-        }
-        ht->buckets[i] = NULL;
+    if (instrumentos != NULL && strcmp(instrumentos, "texto") != 0 && strcmp(instrumentos, "json") != 0) {
+        printf("Erro: formato de instrumentos invalido: %s (use 'texto' ou 'json')\n", instrumentos);
+        return 1;
     }
-}
+    ParamSimulacao paramSim;
+    if (simular != NULL && !lerParamSimulacao(simular, &paramSim)) return 1;
+#ifdef INSTRUMENTAR
+    iniciarInstrumentos(instrumentos != NULL && strcmp(instrumentos, "json") == 0, instrumentos != NULL);
+#else
+    if (instrumentos != NULL)
+        fprintf(stderr, "Aviso: compilado sem -DINSTRUMENTAR; --instrumentos ignorado.\n");
+#endif
+
+    // mapa informado na linha de comando (texto ou binario) ou mansao padrao
+    // com -DMANSAO_FIXA, a mansao padrao e a hash ja estao prontas no binario
+    const MansaoFixa *fixa = (gerado == NULL && caminhoMapa == NULL) ? mansaoFixaCompilada() : NULL;
+    Mansao mansao;
+    HashTable ht;
+    INSTR_INICIO(tCarga);
+    if (fixa != NULL) {
+        abrirMansaoFixa(fixa, &mansao, &ht);
+    } else if (gerado != NULL) {
+        ParamGeracao g;
+        if (!lerParamGeracao(gerado, &g)) return 1;
+        gerarMansao(&g, &mansao);
+    } else if (caminhoMapa != NULL) {
+        if (!carregarMansao(caminhoMapa, &mansao)) return 1;
+    } else {
+        montarMansaoPadrao(&mansao);
+    }
+    INSTR_FIM(MED_CARREGAR_MAPA, tCarga);
+    uint32_t limiarCaso = limiarDoCaso(&mansao, (uint32_t) limiar);
 
-// =========================
-// EXPLORACAO DA MANSAO
-// =========================
+    // Criar e popular a tabela hash pista -> suspeito
+    INSTR_INICIO(tHash);
+    if (fixa == NULL) {
+        inicializarHash(&ht, &mansao.textos);
+        popularHash(&ht, &mansao);
+    }
+    INSTR_FIM(MED_POPULAR_HASH, tHash);
+
+    if (resolver) {
+        SolucaoCaminhos sol;
+        resolverCaminhos(&mansao, &ht, limiarCaso, &sol);
+        exibirSolucao(&mansao, &ht, &sol);
+        liberarSolucao(&sol);
+        liberarHash(&ht);
+        liberarMansao(&mansao);
+        return 0;
+    }
 
-// explorarSalas() – navega pela arvore e ativa o sistema de pistas
-// entrada: salaAtual (ponteiro para Sala), raizPistas (ponteiro para ponteiro da BST), ht (tabela hash com relacao pista->suspeito)
-// ao visitar, exibe pista (se existir) e adiciona na BST automaticamente
-void explorarSalas(Sala *salaAtual, PistaNode **raizPistas, HashTable *ht) {
-    char escolha;
-    while (salaAtual != NULL) {
-        printf("\nVocê esta na sala: %s\n", salaAtual->nome);
-        if (strlen(salaAtual->pista) > 0) {
-            printf("Voce encontrou uma pista: \"%s\"\n", salaAtual->pista);
-            *raizPistas = inserirPista(*raizPistas, salaAtual->pista);
-            // opcional: mostrar suspeito ligado a esta pista
-            const char *sus = encontrarSuspeito(ht, salaAtual->pista);
-            if (sus != NULL) {
-                printf("  (essa pista esta ligada ao suspeito: %s)\n", sus);
-            } else {
-                printf("  (nenhum suspeito associado a esta pista no momento)\n");
+    if (simular != NULL) {
+        FILE *f = NULL;
+        if (registros != NULL) {
+            f = strcmp(registros, "-") == 0 ? stdout : fopen(registros, "w");
+            if (f == NULL) {
+                printf("Erro: nao foi possivel criar os registros '%s'.\n", registros);
+                liberarHash(&ht);
+                liberarMansao(&mansao);
+                return 1;
             }
-        } else {
-            printf("Nao ha pista nesta sala.\n");
         }
+        static char bufSaida[1 << 16];
+        setvbuf(stdout, bufSaida, _IOFBF, sizeof bufSaida);
+        int threads = numThreads > 0 ? numThreads : (int) sysconf(_SC_NPROCESSORS_ONLN);
+        paramSim.limiar = limiarCaso;
+        int ok = simularAgentes(stdout, &mansao, &ht, &paramSim, threads > 0 ? threads : 1, f);
+        if (f != NULL && f != stdout) fclose(f);
+        fflush(stdout);
+        liberarHash(&ht);
+        liberarMansao(&mansao);
+        return ok ? 0 : 1;
+    }
 
-        // opcoes
-        printf("\nEscolha seu proximo caminho:\n");
-        if (salaAtual->esquerda != NULL) printf("  (e) Esquerda -> %s\n", salaAtual->esquerda->nome);
-        if (salaAtual->direita != NULL)  printf("  (d) Direita  -> %s\n", salaAtual->direita->nome);
-        printf("  (s) Sair e ir ao julgamento\n");
-        printf("Opcao: ");
-        scanf(" %c", &escolha);
-        // limpar resto da linha
-        while (getchar() != '\n');
-
-        if (escolha == 'e' && salaAtual->esquerda != NULL) salaAtual = salaAtual->esquerda;
-        else if (escolha == 'd' && salaAtual->direita != NULL) salaAtual = salaAtual->direita;
-        else if (escolha == 's') {
-            printf("\nExploracao encerrada. Seguindo para o julgamento...\n");
-            break;
+    if (roteiros != NULL) {
+        FILE *f = strcmp(roteiros, "-") == 0 ? stdin : fopen(roteiros, "r");
+        if (f == NULL) {
+            printf("Erro: nao foi possivel abrir os roteiros '%s'.\n", roteiros);
+            liberarHash(&ht);
+            liberarMansao(&mansao);
+            return 1;
+        }
+        // saida totalmente bufferizada: um registro por sessao, sem menus
+        static char bufSaida[1 << 16];
+        setvbuf(stdout, bufSaida, _IOFBF, sizeof bufSaida);
+        if (numThreads > 0) {
+            // motor paralelo: carrega todos os roteiros e escreve os resultados em ordem
+            char *texto;
+            Roteiro *lista;
+            size_t n = carregarRoteiros(f, &texto, &lista);
+            ResultadoSessao *res = (ResultadoSessao*) memAlocar(MEM_GERAL, (n ? n : 1) * sizeof(ResultadoSessao));
+            if (res == NULL) { printf("Erro: memoria insuficiente (resultados).\n"); exit(1); }
+            executarSessoesParalelo(&mansao, &ht, limiarCaso, lista, n, numThreads, res);
+            escreverResultados(stdout, lista, res, n, limiarCaso);
+            memLiberar(res);
+            memLiberar(lista); // alocados pelo motor
+            memLiberar(texto);
         } else {
-            printf("Opcao invalida ou caminho inexistente. Tente novamente.\n");
+            reproduzirRoteiros(f, stdout, &mansao, &ht, limiarCaso);
         }
+        if (f != stdin) fclose(f);
+        fflush(stdout);
+        liberarHash(&ht);
+        liberarMansao(&mansao);
+        return 0;
     }
-}
 
-// =========================
-// AVALIACAO FINAL
-// =========================
-
-// Funcao recursiva que conta quantas pistas da BST apontam para 'suspeitoAlvo'
-// Para cada pista no no, busca na hash quem eh o suspeito e compara (case-insensitive)
-int contarPistasParaSuspeitoRec(PistaNode *raiz, HashTable *ht, const char *suspeitoAlvo) {
-    if (raiz == NULL) return 0;
-    int total = 0;
-    // esquerda
-    total += contarPistasParaSuspeitoRec(raiz->esquerda, ht, suspeitoAlvo);
-    // atual
-    const char *sus = encontrarSuspeito(ht, raiz->pista);
-    if (sus != NULL) {
-        char susLower[MAXNOME], alvoLower[MAXNOME];
-        strToLower(sus, susLower);
-        strToLower(suspeitoAlvo, alvoLower);
-        if (strcmp(susLower, alvoLower) == 0) total++;
+    // servidor: muitos jogadores ao mesmo tempo, sem diario nem relatorio; o caso carregado vira
+    // a versao 1 e SIGHUP carrega de novo a mesma fonte (mapa, --gerado ou mansao padrao)
+    if (servir != NULL) {
+        FonteCaso fonte = { .caminho = caminhoMapa, .gerado = gerado, .fixa = fixa, .limiar = (uint32_t) limiar };
+        PublicadorCasos casos;
+        iniciarPublicador(&casos, montarVersaoCaso(&mansao, &ht, fonte.limiar));
+        RecargaCaso recarga;
+        iniciarRecarga(&recarga, &casos, &fonte);
+        int ok = servirSessoes(servir, &casos);
+        pararRecarga(&recarga);
+        encerrarPublicador(&casos);
+        return ok ? 0 : 1;
     }
-    // direita
-    total += contarPistasParaSuspeitoRec(raiz->direita, ht, suspeitoAlvo);
-    return total;
-}
 
-// verificarSuspeitoFinal() – conduz a fase de julgamento final
-// requisito: ao menos 2 pistas devem apontar para o suspeito acusado
-void verificarSuspeitoFinal(PistaNode *raizPistas, HashTable *ht) {
-    if (raizPistas == NULL) {
-        printf("\nNenhuma pista foi coletada. Nao ha como acusar alguem com base em evidencias.\n");
-        return;
+    // jogo no terminal: cada turno e descarregado de uma vez antes de ler a opcao, entao a
+    // saida padrao nao precisa descarregar por linha (num terminal seria uma escrita por linha)
+    static char bufTerminal[BUFFER_SAIDA];
+    setvbuf(stdout, bufTerminal, _IOFBF, sizeof bufTerminal);
+
+    // sessao do jogador: sala atual, AVL de pistas coletadas e contadores de evidencias
+    Sessao sessao;
+    iniciarSessao(&sessao, &mansao, &ht, limiarCaso);
+
+    // progresso salvo: retoma a investigacao gravada e continua gravando a cada sala
+    DiarioSessoes diario;
+    if (salvar != NULL) {
+        size_t restauradas;
+        if (!abrirDiario(&diario, salvar, &mansao, &ht, &sessao, 1, &restauradas)) {
+            liberarSessao(&sessao);
+            liberarHash(&ht);
+            liberarMansao(&mansao);
+            return 1;
+        }
+        diario.sincronizar = 1;
+        if (restauradas > 0)
+            printf("Investigacao retomada em '%s': %s, %zu pista(s) coletada(s).\n",
+                   salvar, nomeSala(&mansao, sessao.salaAtual), sessao.pistas.total);
     }
 
-    printf("\n===== PISTAS COLETADAS =====\n");
-    exibirPistasInOrder(raizPistas);
+    // Inicio do jogo
+    fputs(TEXTO_ABERTURA, stdout);
 
-    char acusado[MAXNOME];
-    printf("\nDigite o nome do suspeito que deseja acusar: ");
-    if (fgets(acusado, MAXNOME, stdin) == NULL) {
-        printf("Entrada invalida.\n");
-        return;
-    }
-    // remover newline
-    acusado[strcspn(acusado, "\n")] = '\0';
+    ConsultasMansao consultas;
+    prepararConsultas(&consultas, &mansao, &ht);
+    LeitorEntrada entrada;
+    inicializarLeitor(&entrada, STDIN_FILENO);
+    explorarSalas(&mansao, &sessao, &ht, salvar != NULL ? &diario : NULL, &consultas, &entrada);
+    liberarConsultas(&consultas);
 
-    if (strlen(acusado) == 0) {
-        printf("Nenhum nome informado. Acusacao abortada.\n");
-        return;
+    // Fase de julgamento: exibe pistas coletadas e pede o acusado
+    IndiceNomes nomes;
+    construirIndiceNomes(&nomes, &ht);
+    int concluido = verificarSuspeitoFinal(&sessao, &ht, &nomes, &entrada);
+    liberarIndiceNomes(&nomes);
+    if (salvar != NULL) {
+        // investigacao encerrada com veredito: nao ha mais o que retomar
+        fecharDiario(&diario);
+        if (concluido) remove(salvar);
     }
 
-    int cont = contarPistasParaSuspeitoRec(raizPistas, ht, acusado);
-    printf("\nPistas que apontam para %s: %d\n", acusado, cont);
-
-    if (cont >= 2) {
-        printf("\nResultado: Ha evidencias suficientes! %s eh considerado(a) culpado(a).\n", acusado);
-    } else {
-        printf("\nResultado: Nao ha evidencias suficientes para sustentar a acusacao contra %s.\n", acusado);
+    // relatorio para coleta de logs: uma linha JSON por pista, em ordem alfabetica
+    if (relatorio != NULL) {
+        FILE *f = strcmp(relatorio, "-") == 0 ? stdout : fopen(relatorio, "w");
+        if (f == NULL) {
+            printf("Erro: nao foi possivel gravar o relatorio '%s'.\n", relatorio);
+        } else {
+            char memoria[BUFFER_SAIDA];
+            BufferSaida b;
+            inicializarBufferSaida(&b, f, memoria, sizeof memoria);
+            fflush(stdout);
+            relatorioPistas(&sessao.pistas, &ht, &b, RELATORIO_JSON, NULL, NULL, NULL);
+            if (f != stdout) fclose(f);
+        }
     }
-}
-
-// =========================
-// FUNCAO PRINCIPAL (main)
-// =========================
-
-int main() {
-    // Montagem manual do mapa da mansao (arvore binaria de Salas)
-    Sala *hall = criarSala("Hall de Entrada", "pegadas_no_chao");
-    Sala *salaEstar = criarSala("Sala de Estar", "livro_aberto_sobre_enigmas");
-    Sala *cozinha = criarSala("Cozinha", "faca_limpa_na_mesa");
-    Sala *biblioteca = criarSala("Biblioteca", "mapa_rasgado_com_x");
-    Sala *jardim = criarSala("Jardim", "vaso_quebrado");
-    Sala *porao = criarSala("Porao", "cofre_trancado_com_simbolos");
-    Sala *quarto = criarSala("Quarto Principal", "retrato_antigo_quebrado");
-
-    // ligar as salas
-    hall->esquerda = salaEstar;
-    hall->direita  = cozinha;
-    salaEstar->esquerda = biblioteca;
-    salaEstar->direita  = jardim;
-    cozinha->esquerda = porao;
-    cozinha->direita  = quarto;
-
-    // Criar e popular a tabela hash pista -> suspeito
-    HashTable ht;
-    inicializarHash(&ht);
-    // A associacao e definida aqui (simplificacao: pistas estaticas associadas a suspeitos)
-    inserirNaHash(&ht, "pegadas_no_chao", "Sr. Silva");
-    inserirNaHash(&ht, "livro_aberto_sobre_enigmas", "Sra. Almeida");
-    inserirNaHash(&ht, "faca_limpa_na_mesa", "Sr. Silva");
-    inserirNaHash(&ht, "mapa_rasgado_com_x", "Dr. Costa");
-    inserirNaHash(&ht, "vaso_quebrado", "Sra. Almeida");
-    inserirNaHash(&ht, "cofre_trancado_com_simbolos", "Dr. Costa");
-    inserirNaHash(&ht, "retrato_antigo_quebrado", "Sr. Oliveira");
-
-    // BST de pistas coletadas (inicialmente vazia)
-    PistaNode *raizPistas = NULL;
-
-    // Inicio do jogo
-    printf("=== DETECTIVE QUEST: JULGAMENTO FINAL (COLETA, ASSOCIACAO E ACUSACAO) ===\n");
-    printf("Instrucoes: em cada sala escolha 'e' para esquerda, 'd' para direita ou 's' para sair.\n");
-
-    explorarSalas(hall, &raizPistas, &ht);
-
-    // Fase de julgamento: exibe pistas coletadas e pede o acusado
-    verificarSuspeitoFinal(raizPistas, &ht);
 
     // Liberar memoria (boas praticas)
-    liberarPistas(raizPistas);
+    liberarSessao(&sessao);
     liberarHash(&ht);
-    free(hall); free(salaEstar); free(cozinha); free(biblioteca); free(jardim); free(porao); free(quarto);
+    liberarMansao(&mansao);
 
-    printf("\nFim do jogo. Obrigado por jogar, detetive!\n");
+    fputs(TEXTO_DESPEDIDA, stdout);
     return 0;
 }
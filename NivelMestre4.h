@@ -0,0 +1,1322 @@
+// NivelMestre4.h – tipos, constantes e funcoes compartilhados pelos modulos do Detetive Quest
+// (nivel mestre): mestre_nucleo.c, mestre_jogo.c, mestre_simulacao.c, mestre_servidor.c,
+// mestre_codegen.c, os benchmarks mestre_bench.c e o programa principal NivelMestre4.c
+#ifndef NIVEL_MESTRE4_H
+#define NIVEL_MESTRE4_H
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/random.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+#define MAXNOME 64
+#define MAXPISTA 128
+#define HASH_CAP_INICIAL 16   // capacidade inicial da hash (potencia de 2)
+#define HASH_PERFEITA_SEMENTE 0x2545F491u // semente fixa das hashes perfeitas (gravadas em --gerar-c)
+#define HASH_PERFEITA_TENTATIVAS 65536   // deslocamentos tentados por balde antes de dobrar a tabela
+#define ARENA_BLOCO (64 * 1024)  // tamanho padrao de cada bloco da arena
+#define POOL_OBJETOS 1024     // objetos por bloco do alocador em pool
+#define ALTURA_MAX_AVL 64     // altura maxima possivel de uma AVL com 2^44 nos
+#define MANSAO_MAGICA "DQM1"  // assinatura do formato binario de mapas
+#define MANSAO_VERSAO 4       // 4: associacoes com peso e limiar no cabecalho; 3: saidas em CSR (grafo)
+#define TEXTO_VAZIO 0u        // id interno da string vazia
+#define LIMIAR_CULPA 2        // pontos de evidencia necessarios para condenar (padrao; ver limiarDoCaso)
+#define RANKING_EXIBIDOS 10   // suspeitos listados no ranking do julgamento
+#define SUGESTOES_NOME 8      // candidatos mostrados quando o nome acusado e ambiguo ou termina em '?'
+#define TRILHA_MAX 65536      // salas guardadas para voltar ('v'); alem disso as mais antigas sao esquecidas
+#define MOTOR_LOTE 64         // roteiros retirados por vez da faixa de um trabalhador
+#define SIM_PASSOS 256        // movimentos maximos de um agente da simulacao (padrao; ver passos=)
+#define SIM_SUSPEITOS_LOCAIS 65536 // ate aqui cada thread conta as acusacoes por suspeito num vetor proprio
+#define SIM_BUFFER (64 * 1024)     // registros por agente acumulados por thread antes de cada escrita
+#define ORDENACAO_MAX_THREADS 64     // trechos da ordenacao paralela
+#define ORDENACAO_MIN_PARALELO 65536 // abaixo disso ordena numa thread so
+#define PAGINA_PISTAS 256     // pistas por pagina do relatorio (uma escrita por pagina)
+#define BUFFER_SAIDA (16 * 1024) // buffer do relatorio; comporta uma pagina tipica
+#define BUFFER_ENTRADA 4096   // leitor de linhas do jogo (linhas maiores sao truncadas)
+#define ALCANCE_PALAVRAS (1u << 23) // resumo de pistas por componente fora da floresta: ate 2^23 palavras (64 MB)
+#define SERVIDOR_EVENTOS 64   // eventos tratados por chamada a epoll_wait
+#define SERVIDOR_PENDENTE (256 * 1024) // saida acumulada acima da qual a conexao para de ser lida
+#define EPOCA_LEITORES 16     // threads que podem ler versoes do caso ao mesmo tempo
+#define EPOCA_OCIOSO UINT64_MAX // epoca anunciada por um leitor fora de leitura
+#define DIARIO_MAGICA "DQS1"  // assinatura do diario de sessoes (snapshots + deltas)
+#define DIARIO_VERSAO 2
+#define DIARIO_SEMENTE 0x4451533144515331ull // semente fixa: impressao do mapa e checagem dos registros
+#define DIARIO_COMPACTAR 256  // registros gravados desde a ultima compactacao que sugerem compactar
+#define INSTR_SUB_BITS 3      // histogramas: 2^3 baldes por potencia de 2 (erro relativo <= 12,5%)
+#define INSTR_BALDES ((64 - INSTR_SUB_BITS + 1) << INSTR_SUB_BITS)
+
+// Contabilidade de memoria (com -DCONTABILIZAR_MEMORIA, ligada tambem por -DINSTRUMENTAR; o binario
+// de benchmarks a usa sem os histogramas). Quem e dono da memoria aloca com
+// memAlocar/memZerada/memRealocar passando a sua categoria (a arena e o alocador de objetos
+// guardam a deles); cada bloco leva um cabecalho com tamanho e categoria, entao memLiberar
+// debita a categoria de quem alocou, seja quem for que libere. Sem ela as funcoes
+// sao malloc/calloc/realloc/free diretos, sem cabecalho nem contadores. O relatorio sai com --memoria.
+typedef enum CategoriaMemoria {
+    MEM_GERAL, MEM_MAPA, MEM_TEXTOS, MEM_PISTAS, MEM_HASH, MEM_EVIDENCIAS, MEM_NOMES, MEM_SESSOES,
+    MEM_DIARIO, MEM_CONSULTAS, MEM_BUFFERS, MEM_MOTOR, MEM_SIMULACAO, MEM_SOLUCAO, MEM_SERVIDOR, MEM_BENCH,
+    NUM_CATEGORIAS_MEMORIA
+} CategoriaMemoria;
+
+#if defined(INSTRUMENTAR) && !defined(CONTABILIZAR_MEMORIA)
+#define CONTABILIZAR_MEMORIA
+#endif
+
+#ifdef CONTABILIZAR_MEMORIA
+
+// Contadores de uma categoria (atomicos: o motor paralelo aloca em varias threads)
+typedef struct ContadorMemoria {
+    _Atomic size_t objetos;     // blocos vivos
+    _Atomic size_t bytes;       // bytes vivos (pedidos + cabecalho)
+    _Atomic size_t pico;        // maior valor de 'bytes'
+    _Atomic size_t alocacoes;   // total de alocacoes e realocacoes bem-sucedidas
+} ContadorMemoria;
+
+// Cabecalho de cada bloco contabilizado; 16 bytes mantem o alinhamento que o malloc garante
+typedef struct CabecalhoMemoria {
+    _Alignas(16) size_t tamanho;
+    uint32_t categoria;
+} CabecalhoMemoria;
+
+extern ContadorMemoria contadoresMemoria[NUM_CATEGORIAS_MEMORIA];
+extern _Atomic size_t memoriaViva, memoriaPico;
+
+// contador de alocacoes da thread atual (os benchmarks medem alocacoes por operacao)
+extern _Thread_local size_t totalAlocacoes;
+
+static inline void memMaximo(_Atomic size_t *pico, size_t v) {
+    size_t atual = atomic_load_explicit(pico, memory_order_relaxed);
+    while (v > atual && !atomic_compare_exchange_weak_explicit(pico, &atual, v, memory_order_relaxed,
+                                                               memory_order_relaxed)) {}
+}
+
+// soma 'mais' e subtrai 'menos' bytes (e 'objetos' blocos) da categoria 'c'
+static inline void memContabilizar(CategoriaMemoria c, size_t mais, size_t menos, int objetos) {
+    ContadorMemoria *k = &contadoresMemoria[c];
+    if (objetos != 0) atomic_fetch_add_explicit(&k->objetos, (size_t) objetos, memory_order_relaxed);
+    size_t b = atomic_fetch_add_explicit(&k->bytes, mais - menos, memory_order_relaxed) + mais - menos;
+    size_t t = atomic_fetch_add_explicit(&memoriaViva, mais - menos, memory_order_relaxed) + mais - menos;
+    if (mais > menos) {
+        memMaximo(&k->pico, b);
+        memMaximo(&memoriaPico, t);
+    }
+}
+
+// preenche o cabecalho de um bloco recem-alocado e devolve a area do usuario
+static inline void* memRegistrar(CategoriaMemoria c, CabecalhoMemoria *h, size_t n) {
+    if (h == NULL) return NULL;
+    h->tamanho = n;
+    h->categoria = (uint32_t) c;
+    totalAlocacoes++;
+    atomic_fetch_add_explicit(&contadoresMemoria[c].alocacoes, 1, memory_order_relaxed);
+    memContabilizar(c, n + sizeof *h, 0, 1);
+    return h + 1;
+}
+
+static inline void* memAlocar(CategoriaMemoria c, size_t n) {
+    if (n > SIZE_MAX - sizeof(CabecalhoMemoria)) return NULL;
+    return memRegistrar(c, (CabecalhoMemoria*) malloc(sizeof(CabecalhoMemoria) + n), n);
+}
+
+static inline void* memZerada(CategoriaMemoria c, size_t n, size_t tam) {
+    if (tam != 0 && n > (SIZE_MAX - sizeof(CabecalhoMemoria)) / tam) return NULL;
+    return memRegistrar(c, (CabecalhoMemoria*) calloc(1, sizeof(CabecalhoMemoria) + n * tam), n * tam);
+}
+
+// libera um bloco de memAlocar/memZerada/memRealocar, debitando a categoria gravada nele
+static inline void memLiberar(void *p) {
+    if (p == NULL) return;
+    CabecalhoMemoria *h = (CabecalhoMemoria*) p - 1;
+    memContabilizar((CategoriaMemoria) h->categoria, 0, h->tamanho + sizeof *h, -1);
+    free(h);
+}
+
+// o bloco continua na categoria de quem o alocou; 'c' so vale quando 'p' e NULL
+static inline void* memRealocar(CategoriaMemoria c, void *p, size_t n) {
+    if (p == NULL) return memAlocar(c, n);
+    if (n > SIZE_MAX - sizeof(CabecalhoMemoria)) return NULL;
+    CabecalhoMemoria *h = (CabecalhoMemoria*) p - 1;
+    size_t antes = h->tamanho;
+    CabecalhoMemoria *q = (CabecalhoMemoria*) realloc(h, sizeof *q + n);
+    if (q == NULL) return NULL; // 'p' continua valido (e contado)
+    CategoriaMemoria dono = (CategoriaMemoria) q->categoria;
+    q->tamanho = n;
+    totalAlocacoes++;
+    atomic_fetch_add_explicit(&contadoresMemoria[dono].alocacoes, 1, memory_order_relaxed);
+    memContabilizar(dono, n, antes, 0);
+    return q + 1;
+}
+
+#else
+
+static inline void* memAlocar(CategoriaMemoria c, size_t n) {
+    (void) c;
+    return malloc(n);
+}
+
+static inline void* memZerada(CategoriaMemoria c, size_t n, size_t tam) {
+    (void) c;
+    return calloc(n, tam);
+}
+
+static inline void memLiberar(void *p) {
+    free(p);
+}
+
+static inline void* memRealocar(CategoriaMemoria c, void *p, size_t n) {
+    (void) c;
+    return realloc(p, n);
+}
+
+#endif
+
+// =========================
+// ESTRUTURAS
+// =========================
+
+// Bloco de memoria de uma arena (alocacao sequencial, liberado de uma vez)
+typedef struct BlocoArena {
+    struct BlocoArena *anterior;
+    size_t capacidade;
+    size_t usados;
+    _Alignas(16) unsigned char dados[];
+} BlocoArena;
+
+typedef struct Arena {
+    BlocoArena *atual;
+    CategoriaMemoria categoria;   // onde os blocos sao contabilizados
+} Arena;
+
+// Estrategias do alocador de objetos de tamanho fixo (nos da arvore de pistas)
+typedef enum ModoAlocador {
+    ALOCADOR_ARENA,     // sequencial em blocos grandes; so devolve tudo de uma vez
+    ALOCADOR_POOL,      // blocos de POOL_OBJETOS objetos + lista de livres (devolucao individual)
+    ALOCADOR_SISTEMA,   // um malloc por objeto (referencia para comparar o consumo)
+    NUM_MODOS_ALOCADOR
+} ModoAlocador;
+
+// Bloco do pool: POOL_OBJETOS objetos de 'tamObjeto' bytes
+typedef struct BlocoPool {
+    struct BlocoPool *anterior;
+    _Alignas(16) unsigned char dados[];
+} BlocoPool;
+
+// Alocador de objetos de tamanho fixo com estrategia escolhida na inicializacao
+typedef struct AlocadorObjetos {
+    ModoAlocador modo;
+    CategoriaMemoria categoria; // conta de memoria dos blocos e objetos deste alocador
+    size_t tamObjeto;       // arredondado para multiplo do alinhamento de ponteiro
+    Arena arena;            // ALOCADOR_ARENA
+    BlocoPool *blocos;      // ALOCADOR_POOL: bloco mais recente primeiro
+    size_t usadosNoBloco;   // objetos ja entregues do bloco mais recente
+    void *livres;           // objetos devolvidos (o proximo fica nos primeiros bytes de cada um)
+} AlocadorObjetos;
+
+// Entrada do indice texto -> id da tabela de textos internados
+typedef struct IndiceTexto {
+    uint32_t hash;
+    uint32_t idMais1;   // 0 indica posicao vazia
+} IndiceTexto;
+
+// Tabela de textos internados: cada string distinta e guardada uma unica vez
+// e identificada por um id compacto. Os ids [0, numBase) vem da imagem da
+// mansao (somente leitura); os seguintes sao internados em tempo de execucao.
+typedef struct InternPool {
+    const uint32_t *baseDesloc;
+    const char *baseTextos;
+    uint32_t numBase;
+    uint32_t tamBase;
+    const char **proprios;    // textos internados em tempo de execucao (na arena)
+    uint32_t numProprios, capProprios;
+    Arena arena;
+    IndiceTexto *indice;      // construido sob demanda na primeira busca por texto
+    size_t capIndice;
+} InternPool;
+
+// Registro de uma sala da mansao; as salas ficam num unico array contiguo
+// as saidas ficam a parte, em CSR: as da sala i sao saidas[inicioSaidas[i] .. inicioSaidas[i+1])
+typedef struct Sala {
+    uint32_t nome;      // id interno do nome
+    uint32_t pista;     // id interno da pista (TEXTO_VAZIO = sem pista)
+} Sala;
+
+// Saida de uma sala registrada no construtor (-1 = posicao sem caminho, p.ex. "ligar 3 - 7")
+typedef struct Ligacao {
+    int32_t origem;
+    int32_t destino;
+} Ligacao;
+
+// Associacao pista -> suspeito definida no mapa (ids internos)
+// 'chave' e o id do nome do suspeito em minusculas, usado nas comparacoes
+// uma pista pode ter varias associacoes (uma por suspeito que ela implica)
+typedef struct Associacao {
+    uint32_t pista;
+    uint32_t suspeito;
+    uint32_t chave;
+    uint32_t peso;      // pontos de evidencia que a pista soma contra o suspeito
+} Associacao;
+
+// Cabecalho do formato binario da mansao; logo apos vem, em ordem:
+// Sala[numSalas], Associacao[numAssociacoes], uint32_t desloc[numTextos]
+// e a area de textos (tamTextos bytes); o id interno de um texto e seu indice em desloc
+// os inteiros sao gravados na ordem de bytes da maquina
+typedef struct CabecalhoMansao {
+    char magica[4];
+    uint32_t versao;
+    uint32_t numSalas;
+    uint32_t raiz;
+    uint32_t numAssociacoes;
+    uint32_t numTextos;
+    uint32_t tamTextos;
+    uint32_t numSaidas;
+    uint32_t limiar;        // pontos para condenar definidos pelo mapa (0 = LIMIAR_CULPA)
+} CabecalhoMansao;
+
+// Mansao pronta para uso: secoes apontam para uma imagem binaria (mmap ou malloc)
+typedef struct Mansao {
+    const Sala *salas;
+    uint32_t numSalas;
+    int32_t raiz;
+    const uint32_t *inicioSaidas;   // numSalas + 1 deslocamentos em 'saidas'
+    const int32_t *saidas;          // destino de cada saida (-1 = sem caminho)
+    uint32_t numSaidas;
+    const Associacao *associacoes;
+    uint32_t numAssociacoes;
+    uint32_t limiar;        // 0 = sem limiar proprio
+    InternPool textos;
+    unsigned char *imagem;  // imagem alocada com malloc (mapa texto ou padrao)
+    void *mapeada;          // imagem mapeada com mmap (mapa binario)
+    size_t tamImagem;
+} Mansao;
+
+// Construtor usado para montar uma mansao em memoria antes de gerar a imagem
+typedef struct ConstrutorMansao {
+    Sala *salas;
+    uint32_t numSalas, capSalas;
+    Ligacao *ligacoes;      // saidas na ordem em que foram declaradas
+    uint32_t numLigacoes, capLigacoes;
+    Associacao *associacoes;
+    uint32_t numAssociacoes, capAssociacoes;
+    uint32_t limiar;
+    InternPool textos;
+} ConstrutorMansao;
+
+// No da arvore AVL que armazena pistas coletadas (ordenadas)
+typedef struct PistaNode {
+    uint32_t pista;     // id interno da pista
+    int altura;
+    struct PistaNode *esquerda;
+    struct PistaNode *direita;
+} PistaNode;
+
+// Colecao de pistas coletadas: raiz da AVL + alocador que guarda os nos
+typedef struct ArvorePistas {
+    PistaNode *raiz;
+    size_t total;
+    AlocadorObjetos nos;
+    InternPool *textos;
+} ArvorePistas;
+
+// Cursor ordenado sobre as pistas coletadas: percorre a AVL sem recursao,
+// a partir da primeira pista >= 'de' e ate 'ate' (inclusive) ou enquanto houver o prefixo
+typedef struct CursorPistas {
+    const ArvorePistas *arv;
+    PistaNode *pilha[ALTURA_MAX_AVL];
+    int topo;
+    const char *ate;       // limite superior inclusivo (NULL = sem limite)
+    const char *prefixo;   // so pistas com este prefixo (NULL = todas)
+    size_t tamPrefixo;
+    size_t lidas;          // pistas ja devolvidas
+} CursorPistas;
+
+// Buffer de saida reutilizavel: acumula linhas e escreve no destino com um unico fwrite
+// a memoria e fornecida por quem chama (normalmente um vetor na pilha). Sem destino, o buffer
+// cresce em vez de descarregar e a memoria e dele (saida de uma conexao do servidor)
+typedef struct BufferSaida {
+    char *dados;
+    size_t usado, cap;
+    FILE *destino;
+} BufferSaida;
+
+// Leitor de linhas sobre um descritor, sem stdio: os bytes lidos ficam em 'dados' ate formar
+// uma linha, entregue sem o '\n' (linhas maiores que o buffer sao truncadas). Num descritor
+// nao bloqueante, a falta de linha completa e devolvida em vez de esperar
+typedef struct LeitorEntrada {
+    int fd;
+    int terminou;          // fim da entrada (EOF ou erro de leitura)
+    int descartando;       // linha longa ja entregue: descarta ate o proximo '\n'
+    size_t ini, fim;       // bytes ainda nao entregues: dados[ini, fim)
+    char dados[BUFFER_ENTRADA];
+} LeitorEntrada;
+
+typedef enum {
+    LINHA_OK,
+    LINHA_PENDENTE,        // descritor nao bloqueante sem linha completa
+    LINHA_FIM
+} ResultadoLinha;
+
+typedef enum FormatoRelatorio { RELATORIO_TEXTO, RELATORIO_JSON } FormatoRelatorio;
+
+// Item de uma lista de postagens: suspeito (indice denso) nas listas de uma pista,
+// id da pista nas listas de um suspeito; 'peso' sao os pontos de evidencia da associacao
+typedef struct Postagem {
+    uint32_t id;
+    uint32_t peso;
+} Postagem;
+
+// Lista de postagens: trecho contiguo [inicio, inicio + quantidade) de um PoolPostagens
+typedef struct ListaPostagens {
+    uint32_t inicio;
+    uint32_t quantidade;
+} ListaPostagens;
+
+// Vetor unico com todas as listas de uma direcao. Uma lista que cresce e nao esta no fim do
+// vetor e copiada para o fim (o trecho antigo vira lixo); o lixo e recolhido quando passa
+// da metade. Assim cada lista continua contigua e a leitura e uma varredura linear
+typedef struct PoolPostagens {
+    Postagem *itens;
+    uint32_t usados, cap;
+    uint32_t lixo;
+} PoolPostagens;
+
+// Entrada da tabela hash com enderecamento aberto (chave: id da pista)
+typedef struct HashEntrada {
+    uint32_t pista;          // TEXTO_VAZIO indica posicao vazia
+    ListaPostagens suspeitos;// suspeitos que a pista implica, com peso (em HashTable.postagensPistas)
+} HashEntrada;
+
+// Entrada do indice chave do suspeito -> indice denso
+typedef struct IndiceSuspeito {
+    uint32_t chave;
+    uint32_t idxMais1;   // 0 indica posicao vazia
+} IndiceSuspeito;
+
+// Tabela hash redimensionavel (sondagem linear, capacidade potencia de 2)
+// os suspeitos distintos (comparados sem diferenciar maiusculas) recebem
+// indices densos 0..numSuspeitos-1, usados pelos contadores de evidencias
+// a relacao pista <-> suspeito e muitos-para-muitos, indexada nas duas direcoes
+typedef struct HashTable {
+    HashEntrada *entradas;
+    size_t capacidade;
+    size_t quantidade;
+    InternPool *textos;
+    uint32_t *chaveSuspeito;   // id do nome em minusculas, por indice
+    uint32_t *nomeSuspeito;    // id do nome como foi cadastrado pela primeira vez
+    ListaPostagens *pistasSuspeito; // pistas que implicam cada suspeito (em postagensSuspeitos)
+    uint32_t numSuspeitos, capSuspeitos;
+    IndiceSuspeito *indiceSuspeitos;
+    size_t capIndiceSuspeitos;
+    PoolPostagens postagensPistas;    // pista -> [suspeito, peso]
+    PoolPostagens postagensSuspeitos; // suspeito -> [pista, peso]
+    size_t numAssociacoes;
+    uint32_t semente;                 // semente de hashId usada nas duas tabelas
+    // hash perfeita (abrirHashPerfeita): vetores somente leitura, sem colisoes; NULL na hash comum
+    const uint32_t *deslocPistas, *deslocSuspeitos;
+    uint32_t mascaraBaldesPistas, mascaraBaldesSuspeitos;
+    const uint64_t *mascaras;         // por entrada: bit s = a pista soma pontos contra o suspeito s
+} HashTable;
+
+// Hash pista -> suspeitos sem colisoes, em vetores prontos: cada id tem uma unica posicao
+// possivel. O balde do id (hashId & mascara de baldes) guarda o deslocamento que o separa dos
+// demais ids, e a posicao e hashId(hash do id, deslocamento) & (capacidade - 1). Montada por
+// construirHashPerfeita() ou gravada como tabelas constantes por --gerar-c
+typedef struct HashPerfeita {
+    const HashEntrada *entradas;
+    uint32_t capacidade, quantidade;
+    const uint32_t *deslocPistas;
+    uint32_t numBaldesPistas;
+    const IndiceSuspeito *indiceSuspeitos;
+    uint32_t capIndiceSuspeitos;
+    const uint32_t *deslocSuspeitos;
+    uint32_t numBaldesSuspeitos;
+    const uint32_t *chaveSuspeito;
+    const uint32_t *nomeSuspeito;
+    const ListaPostagens *pistasSuspeito;
+    uint32_t numSuspeitos;
+    const Postagem *postagensPistas;
+    uint32_t numPostagensPistas;
+    const Postagem *postagensSuspeitos;
+    uint32_t numPostagensSuspeitos;
+    const uint64_t *mascaras;          // NULL com mais de 64 suspeitos
+    uint32_t numAssociacoes;
+    uint32_t semente;
+} HashPerfeita;
+
+// Mansao compilada em tabelas constantes (-DMANSAO_FIXA): imagem binaria e hash prontas
+typedef struct MansaoFixa {
+    const unsigned char *imagem;
+    size_t tamImagem;
+    HashPerfeita hash;
+} MansaoFixa;
+
+// Contadores de evidencias de uma investigacao: pontos (soma dos pesos das pistas
+// coletadas) contra cada suspeito, por indice denso, atualizados a cada coleta, e o limiar
+// de pontos que condena no caso em que a investigacao acontece
+typedef struct Evidencias {
+    uint32_t *pontos;
+    uint32_t numSuspeitos;
+    uint32_t limiar;
+} Evidencias;
+
+// Conjunto de salas ja visitadas (enderecamento aberto; 0 = vazio, guarda sala + 1)
+// cresce com as salas visitadas, e nao com o mapa: zerar custa o que a sessao andou
+typedef struct ConjuntoSalas {
+    uint32_t *itens;
+    uint32_t cap, quantidade;
+} ConjuntoSalas;
+
+// Estado privado de uma investigacao: sala atual, pistas coletadas e evidencias
+typedef struct Sessao {
+    int32_t salaAtual;
+    uint32_t movimentos;
+    ArvorePistas pistas;
+    Evidencias ev;
+    uint32_t *coletadas;          // ids das pistas na ordem de coleta (pistas.total itens)
+    uint32_t capColetadas;
+    uint32_t salvas;              // quantas de 'coletadas' ja estao no diario
+    uint32_t movimentosSalvos;    // 'movimentos' no ultimo registro gravado
+    int snapshotPendente;         // o proximo registro precisa ser completo (sessao nova ou reiniciada)
+    ConjuntoSalas visitadas;      // salas cuja pista ja foi recolhida
+    int32_t *trilha;              // salas anteriores, para voltar ('v'): anel com as ultimas TRILHA_MAX
+    uint32_t inicioTrilha, profTrilha, capTrilha;
+    uint32_t trilhaMantida;       // fundo da trilha intocado desde o ultimo registro do diario
+    uint32_t trilhaDescartada;    // salas esquecidas no fundo do anel desde o ultimo registro
+} Sessao;
+
+// Cabecalho do diario de sessoes; seguido de registros
+//   [tipo 'S'|'D'][tamanho varint][conteudo][checagem u32]
+// 'S' (snapshot): sessao, sala, movimentos, contadores, o conjunto de pistas (lista ou bitset)
+//                 e a trilha de volta (do fundo para o topo)
+// 'D' (delta):    sessao, sala, movimentos, as pistas coletadas desde o registro anterior e a
+//                 trilha: salas esquecidas no fundo, quantas do resto ficam e as empilhadas depois
+typedef struct CabecalhoDiario {
+    char magica[4];
+    uint32_t versao;
+    uint64_t impressao;       // impressao digital do mapa (ids de salas e textos precisam bater)
+    uint32_t numSuspeitos;
+    uint32_t reservado;
+} CabecalhoDiario;
+
+// Diario de sessoes aberto para acrescimo; os registros ficam no buffer ate gravarDiario()
+typedef struct DiarioSessoes {
+    int fd;
+    char *caminho;
+    uint64_t impressao;
+    uint32_t numSuspeitos;
+    unsigned char *buf;       // registros pendentes (uma escrita por rodada)
+    size_t usado, cap;
+    uint32_t *ids;            // rascunho para ordenar as pistas de um snapshot
+    uint32_t capIds;
+    size_t pendentes;         // registros no buffer
+    size_t registros;         // registros no arquivo desde a ultima compactacao
+    int sincronizar;          // fdatasync a cada gravacao
+} DiarioSessoes;
+
+// Resultado de um movimento aplicado a uma sessao
+typedef enum {
+    MOV_OK,        // a sessao entrou em outra sala
+    MOV_INVALIDO,  // opcao invalida ou caminho inexistente
+    MOV_SAIR       // jogador encerrou a exploracao
+} ResultadoMovimento;
+
+// Resultado de uma linha digitada durante a exploracao
+typedef enum {
+    COMANDO_VAZIO,      // linha em branco: nada a fazer, a tela nao e repetida
+    COMANDO_FEITO,      // comando tratado: mostrar a tela da sala de novo
+    COMANDO_SAIR        // exploracao encerrada, segue para o julgamento
+} ResultadoComando;
+
+// Resultado de uma linha digitada no julgamento
+typedef enum {
+    ACUSACAO_REPETIR,   // nome ambiguo ou pedido de sugestoes: pergunte de novo
+    ACUSACAO_ABORTADA,  // nenhum nome informado
+    ACUSACAO_CONCLUIDA  // veredito dado
+} ResultadoAcusacao;
+
+// Fases de uma conexao do servidor de sessoes
+typedef enum { FASE_EXPLORANDO, FASE_JULGANDO, FASE_ENCERRANDO } FaseConexao;
+
+// Conexao do servidor: um jogador com sessao, leitor e saida proprios
+typedef struct Conexao {
+    int fd;
+    FaseConexao fase;
+    Sessao se;
+    LeitorEntrada entrada;
+    BufferSaida saida;
+    size_t enviado;        // bytes de 'saida' ja escritos no socket
+    uint32_t eventos;      // eventos registrados no epoll
+    int pausada;           // parou de tratar linhas com saida demais pendente
+    size_t pos;            // indice em ServidorSessoes.conexoes
+    struct VersaoCaso *versao; // versao do caso que a sessao le (presa ate migrar ou fechar)
+} Conexao;
+
+// Roteiro de uma sessao sem interface: movimentos e nome do acusado
+typedef struct Roteiro {
+    const char *movimentos;
+    uint32_t n;
+    const char *acusado;
+} Roteiro;
+
+// Registro compacto do resultado de uma sessao reproduzida
+typedef struct ResultadoSessao {
+    int32_t salaFinal;
+    uint32_t movimentos;
+    uint32_t pistas;
+    uint32_t evidencias;
+} ResultadoSessao;
+
+// Faixa de roteiros de um trabalhador, disputada por roubo de trabalho
+typedef struct FaixaTrabalho {
+    _Alignas(64) _Atomic uint64_t faixa;
+} FaixaTrabalho;
+
+struct MotorSessoes;
+
+// Trabalhador do motor paralelo: faixa propria e sessao privada (arena da propria thread)
+typedef struct TrabalhadorSessoes {
+    FaixaTrabalho faixa;
+    struct MotorSessoes *motor;
+    int indice;
+    Sessao sessao;
+} TrabalhadorSessoes;
+
+// Motor paralelo: mansao e hash compartilhadas (somente leitura) entre os trabalhadores
+typedef struct MotorSessoes {
+    const Mansao *mansao;
+    const HashTable *ht;
+    uint32_t limiar;
+    const Roteiro *roteiros;
+    ResultadoSessao *resultados;
+    TrabalhadorSessoes *trabalhadores;
+    int numTrabalhadores;
+} MotorSessoes;
+
+// Estrategias dos agentes da simulacao
+typedef enum EstrategiaAgente {
+    ESTRATEGIA_ALEATORIA,  // sorteia uma saida a cada passo; para num beco sem saida
+    ESTRATEGIA_GULOSA,     // prefere salas novas com pista, depois salas novas; sem elas, volta
+    ESTRATEGIA_INFORMADA,  // como a gulosa, mas conhece a hash: prefere pistas contra o suspeito
+                           // lider e para assim que ele atinge o limiar
+    NUM_ESTRATEGIAS
+} EstrategiaAgente;
+
+// Parametros de uma simulacao (--simular)
+typedef struct ParamSimulacao {
+    uint32_t estrategias;      // bit 'e' ligado = roda a estrategia 'e'
+    uint32_t agentes;          // investigacoes por estrategia
+    uint64_t semente;
+    uint32_t passos;           // movimentos maximos de cada agente
+    char culpado[MAXNOME];     // suspeito que deveria ser condenado ("" = o de maior peso total)
+    uint32_t limiar;           // pontos que condenam (preenchido com limiarDoCaso)
+} ParamSimulacao;
+
+// Estatisticas de uma estrategia; so somas e contagens, entao o total nao depende de como os
+// agentes foram divididos entre as threads. Os histogramas sao exatos (passos + 2 baldes)
+typedef struct EstatisticasSim {
+    uint64_t agentes;
+    uint64_t semAcusacao;      // nenhuma pista contra ninguem: o agente nao acusa
+    uint64_t condenacoes;      // acusado com pontos >= limiar
+    uint64_t acertos;          // condenou o culpado
+    uint64_t somaMovimentos, somaPistas;
+    uint64_t *movimentos;      // histograma do comprimento do caminho
+    uint64_t *pistas;          // histograma das pistas coletadas
+    uint64_t *acusacoes;       // por suspeito (NULL: a thread conta direto no total da simulacao)
+    uint64_t *condenados;
+} EstatisticasSim;
+
+// Agente de uma thread: sessao, salas vistas e gerador reaproveitados de um agente para o outro
+typedef struct AgenteSim {
+    Sessao se;
+    ConjuntoSalas vistas;      // todas as salas por onde passou (a sessao so guarda as com pista)
+    uint64_t sorteio;          // estado do xorshift64, refeito a partir da semente a cada agente
+    uint32_t lider;            // suspeito com mais pontos (UINT32_MAX = nenhum)
+} AgenteSim;
+
+struct Simulacao;
+
+// Trabalhador da simulacao: faixa de agentes, agente e estatisticas privados
+typedef struct TrabalhadorSim {
+    FaixaTrabalho faixa;
+    struct Simulacao *sim;
+    int indice;
+    AgenteSim agente;
+    EstatisticasSim est;
+    BufferSaida registros;     // uma linha por agente (so com --registros)
+} TrabalhadorSim;
+
+// Simulacao de uma estrategia: mansao e hash compartilhadas (somente leitura)
+typedef struct Simulacao {
+    const Mansao *mansao;
+    const HashTable *ht;
+    const ParamSimulacao *p;
+    EstrategiaAgente estrategia;
+    uint32_t culpado;
+    TrabalhadorSim *trabalhadores;
+    int numTrabalhadores;
+    FILE *registros;
+    _Atomic uint64_t *acusacoes, *condenados; // totais por suspeito
+} Simulacao;
+
+// Sala com pista, posicionada pela ordem de entrada (Euler) da sua componente; fora da floresta,
+// 'entrada' e a posicao da sala entre as salas com pista (o bit dela no resumo por componente)
+typedef struct ItemAlcance {
+    uint32_t entrada;
+    int32_t sala;
+} ItemAlcance;
+
+// Motor de consultas de caminho e alcance sobre o grafo de salas.
+// Quando as componentes fortemente conexas formam uma floresta (toda arvore forma, e tambem mapas
+// cujos ciclos ficam dentro de alas), "v alcanca u" vira "u esta no intervalo de Euler de v": O(1).
+// Contar as pistas alcancaveis e uma busca binaria no intervalo. Fora disso, cada componente pode
+// guardar o conjunto (bitset) das salas com pista que alcanca, montado na ordem topologica do grafo
+// condensado, se couber em ALCANCE_PALAVRAS; sem ele, alcance e contagem caem para uma busca em
+// largura. Os vetores de rascunho usam marcas por epoca: nenhuma limpeza entre consultas
+typedef struct ConsultasMansao {
+    const Mansao *m;
+    const HashTable *ht;
+    uint32_t *inicioEntradas;      // CSR transposto (de onde se chega a cada sala)
+    int32_t *entradas;
+    uint32_t *componente;          // componente fortemente conexa de cada sala
+    uint32_t numComponentes;
+    uint32_t *entradaComp, *saidaComp; // intervalo de Euler [entrada, saida] de cada componente
+    int floresta;                  // 1 se as componentes formam uma floresta (consultas O(1)/O(log n))
+    ItemAlcance *pistasPorEntrada; // salas com pista ordenadas pela entrada da componente
+    ItemAlcance *pistasPorSuspeito;// idem, agrupadas por suspeito (uma vez por suspeito implicado)
+    uint32_t numPistas;
+    uint32_t *inicioSuspeito;      // numSuspeitos + 1 deslocamentos em pistasPorSuspeito
+    uint64_t *pistasComp;          // fora da floresta: palavrasPistas palavras por componente (NULL = sem resumo)
+    uint32_t palavrasPistas;
+    uint32_t *marca, *marcaVolta;  // rascunho das buscas (epoca em que a sala foi vista)
+    int32_t *pai, *paiVolta, *fila, *filaVolta;
+    uint32_t *marcaPista;          // pistas ja coletadas pela sessao consultada (por epoca)
+    uint32_t epoca, epocaPista;
+} ConsultasMansao;
+
+// Resultado do solucionador para um suspeito
+typedef struct ResumoSuspeito {
+    uint64_t caminhos;       // caminhos que o condenam (saindo em qualquer sala)
+    uint64_t caminhosFolha;  // caminhos raiz-folha que o condenam
+    int32_t melhorSala;      // fim do caminho condenatorio mais curto (-1 = nenhum)
+    uint32_t pontosAlcancaveis; // pontos das pistas de todas as salas alcancaveis (voltando com 'v')
+} ResumoSuspeito;
+
+// Resumos por sala (indexados pela sala) e resultado por suspeito
+typedef struct SolucaoCaminhos {
+    int32_t *pai;            // arvore de caminhos minimos a partir da sala inicial (-1 = raiz/inalcancavel)
+    uint32_t *saidaPai;      // saida do pai que leva a sala
+    uint32_t *profundidade;
+    uint64_t *tamanho;   // salas na subarvore
+    uint64_t *folhas;    // folhas na subarvore
+    ResumoSuspeito *suspeitos;
+    uint32_t numSuspeitos;
+    uint32_t limiar;     // pontos que condenam
+    int arvore;          // 1 se as salas alcancaveis formam uma arvore (sem ciclos nem salas compartilhadas)
+} SolucaoCaminhos;
+
+// Distribuicoes de chaves (pistas) usadas pelos benchmarks e pelo gerador de mansoes
+typedef enum DistribuicaoChaves {
+    CHAVES_ALEATORIAS,
+    CHAVES_ORDENADAS,
+    CHAVES_COLIDINDO,
+    CHAVES_LONGAS,
+    NUM_DISTRIBUICOES
+} DistribuicaoChaves;
+
+// Formas de mansao do gerador procedural
+typedef enum FormaMansao {
+    FORMA_BALANCEADA,      // arvore binaria completa (sala i -> 2i+1, 2i+2)
+    FORMA_DEGENERADA,      // corrente: cada sala leva so a seguinte, por um lado sorteado
+    FORMA_GRAFO,           // arvore larga (grau-1 filhos) mais um atalho sorteado por sala
+    NUM_FORMAS
+} FormaMansao;
+
+// Parametros do gerador; cada sala e funcao apenas de (semente, indice), entao o mapa pode
+// ser escrito em varias passadas sem guardar nada por sala
+typedef struct ParamGeracao {
+    FormaMansao forma;
+    uint32_t numSalas;
+    uint64_t semente;
+    uint32_t grau;           // saidas por sala na forma grafo (>= 2)
+    uint32_t densidade;      // % de salas com pista
+    uint32_t numPistas;      // pistas distintas
+    DistribuicaoChaves nomes;// como os nomes das pistas sao formados
+    uint32_t numSuspeitos;
+    uint32_t implicados;     // maximo de suspeitos que uma pista implica
+    uint32_t limiar;         // limiar gravado no mapa (0 = LIMIAR_CULPA)
+} ParamGeracao;
+
+// Textos preparados antes das salas: nomes de comodos e suspeitos ficam numa tabela de textos;
+// as pistas tem nomes distintos por construcao e recebem os ids seguintes (basePistas + j),
+// sendo refeitas na hora de gravar, assim como as associacoes
+typedef struct PreparoGeracao {
+    InternPool textos;
+    uint32_t *comodos;       // ids dos nomes de sala sorteados
+    uint32_t numComodos;
+    uint32_t *suspeitos;     // id do nome e da chave (minusculas) de cada suspeito
+    uint32_t *chaves;
+    uint32_t basePistas;     // id do texto da pista 0
+    unsigned bits;           // bits da distribuicao 'colidindo'
+    uint32_t tamPista;       // todas as pistas de uma distribuicao tem o mesmo tamanho
+    CabecalhoMansao cab;
+    size_t tamanho;          // bytes da imagem completa
+} PreparoGeracao;
+
+typedef int (*ComparadorContexto)(const void*, const void*, void*);
+
+// Trecho da ordenacao paralela: ordenar [ini, fim) ou intercalar [ini, meio) com [meio, fim)
+typedef struct TarefaOrdenacao {
+    unsigned char *origem, *destino;
+    size_t ini, meio, fim, tam;
+    ComparadorContexto cmp;
+    void *ctx;
+} TarefaOrdenacao;
+
+// Associacao preparada para a carga em lote da hash ('pos' = ordem na entrada)
+typedef struct RegistroCarga {
+    uint32_t pista;
+    uint32_t idx;            // indice denso do suspeito (UINT32_MAX = repetida, descartada)
+    uint32_t peso;
+    uint32_t pos;
+} RegistroCarga;
+
+// Destino da imagem gerada: memoria ja alocada com o tamanho final ou arquivo sequencial
+typedef struct DestinoImagem {
+    unsigned char *memoria;
+    FILE *arquivo;
+    size_t pos;
+    int erro;
+} DestinoImagem;
+
+// Chave do indice de nomes: o nome normalizado inteiro ou o trecho a partir de uma das palavras
+// seguintes ("sr joao silva", "joao silva", "silva"), apontando para o suspeito
+typedef struct ChaveNome {
+    uint32_t texto;        // deslocamento do texto normalizado em IndiceNomes.textos
+    uint32_t idxSuspeito;
+} ChaveNome;
+
+// No da trie de nomes: os filhos de um no ficam contiguos e ordenados pelo simbolo; as chaves
+// da subarvore formam o trecho [lo, hi) do vetor ordenado de chaves (as que terminam no proprio
+// no vem primeiro), de modo que completar um prefixo e so descer ate o no
+typedef struct NoNome {
+    uint32_t filhos;       // indice do primeiro filho
+    uint32_t lo, hi;
+    uint8_t numFilhos;     // alfabeto normalizado: a-z, 0-9 e espaco
+    char simbolo;
+} NoNome;
+
+// Indice de nomes de suspeitos (construido depois que a hash esta populada)
+typedef struct IndiceNomes {
+    NoNome *nos;
+    uint32_t numNos;
+    ChaveNome *chaves;
+    uint32_t numChaves;
+    char *textos;          // nomes normalizados, terminados em '\0'
+    uint32_t *marca;       // rascunho para nao repetir suspeitos numa resposta (por epoca)
+    uint32_t epoca;
+    uint32_t numSuspeitos;
+} IndiceNomes;
+
+// Como o nome digitado na acusacao foi reconhecido
+typedef enum ResultadoNome {
+    NOME_EXATO,            // igual a um nome cadastrado (sem diferenciar maiusculas)
+    NOME_NORMALIZADO,      // igual depois de normalizar, ou igual ao sobrenome/fim do nome
+    NOME_PREFIXO,          // prefixo de um unico suspeito
+    NOME_APROXIMADO,       // a poucas edicoes de um unico suspeito
+    NOME_AMBIGUO,          // varios candidatos (devolvidos para o jogador escolher)
+    NOME_DESCONHECIDO
+} ResultadoNome;
+
+// Item do ranking de suspeitos por evidencias
+typedef struct ItemRanking {
+    uint32_t idxSuspeito;
+    uint32_t evidencias;
+} ItemRanking;
+
+// Grandezas acompanhadas pela instrumentacao (-DINSTRUMENTAR): as fases sao latencias em ns,
+// as duas ultimas sao distribuicoes (comprimento de sondagem da hash e profundidade na AVL)
+typedef enum MedidaInstr {
+    MED_CARREGAR_MAPA,
+    MED_POPULAR_HASH,
+    MED_MOVIMENTO,
+    MED_INSERIR_PISTA,
+    MED_JULGAMENTO,
+    MED_SESSAO_REPLAY,
+    MED_SONDAGEM_HASH,
+    MED_PROFUNDIDADE_AVL,
+    NUM_MEDIDAS
+} MedidaInstr;
+
+// Histograma log-linear (estilo HDR): valores < 2^INSTR_SUB_BITS sao exatos, os demais
+// caem em 2^INSTR_SUB_BITS baldes por potencia de 2
+typedef struct HistogramaInstr {
+    uint64_t contagem, soma, maximo;
+    uint64_t baldes[INSTR_BALDES];
+} HistogramaInstr;
+
+// Contadores de uma thread; os blocos ficam numa lista global para o despejo
+typedef struct BlocoInstr {
+    struct BlocoInstr *proximo;
+    HistogramaInstr medidas[NUM_MEDIDAS];
+} BlocoInstr;
+
+// Servidor de sessoes: uma thread com epoll atende todas as conexoes; mapa, hash, consultas
+// e indice de nomes sao compartilhados
+// De onde o caso e (re)carregado: os mesmos argumentos que escolheram a mansao ao iniciar
+typedef struct FonteCaso {
+    const char *caminho;           // mapa texto ou binario (NULL = gerado ou padrao)
+    const char *gerado;            // especificacao do gerador (--gerado)
+    const MansaoFixa *fixa;        // mansao compilada no binario (-DMANSAO_FIXA)
+    uint32_t limiar;               // --limiar (0 = o do mapa)
+} FonteCaso;
+
+// Versao imutavel do caso: mansao, hash e indices derivados, trocados sempre juntos. So o
+// estado de busca das consultas muda depois de publicada (e so a thread do servidor consulta)
+typedef struct VersaoCaso {
+    uint64_t numero;               // 1, 2, ... na ordem de publicacao
+    Mansao mansao;
+    HashTable ht;
+    ConsultasMansao consultas;
+    IndiceNomes nomes;
+    uint32_t limiar;
+    uint64_t impressaoSalas;       // salas, saidas e textos das salas: igual = sessoes podem migrar
+    _Atomic uint32_t sessoes;      // sessoes presas a esta versao
+    uint64_t epocaRetirada;        // epoca global em que deixou de ser a atual
+    struct VersaoCaso *proximaRetirada;
+} VersaoCaso;
+
+// Publicacao de versoes com recuperacao por epocas: um leitor anuncia a epoca global ao entrar
+// numa leitura e EPOCA_OCIOSO ao sair; quem publica troca o ponteiro e avanca a epoca. Uma versao
+// retirada na epoca E so e liberada quando todo leitor esta ocioso ou anunciou >= E (ja le a
+// nova) e nenhuma sessao a prende. Ler nao trava nada; a trava so protege a lista de retiradas
+typedef struct PublicadorCasos {
+    _Atomic(VersaoCaso*) atual;
+    _Atomic uint64_t epoca;
+    struct { _Alignas(64) _Atomic uint64_t epoca; } leitores[EPOCA_LEITORES];
+    _Atomic int numLeitores;
+    pthread_mutex_t trava;
+    VersaoCaso *retiradas;
+    _Atomic size_t numRetiradas;
+    uint64_t publicadas;
+} PublicadorCasos;
+
+// Thread que recarrega o caso a cada SIGHUP
+typedef struct RecargaCaso {
+    pthread_t thread;
+    PublicadorCasos *casos;
+    const FonteCaso *fonte;
+    _Atomic int parar;
+} RecargaCaso;
+
+typedef struct ServidorSessoes {
+    int fdEscuta, fdEpoll;
+    PublicadorCasos *casos;
+    int leitor;            // vaga de leitor do servidor no publicador
+    VersaoCaso *atual;     // versao lida no lote de eventos em andamento
+    Conexao **conexoes;
+    size_t numConexoes, capConexoes;
+    size_t atendidas;      // conexoes aceitas desde o inicio
+} ServidorSessoes;
+
+// =========================
+// INSTRUMENTACAO (-DINSTRUMENTAR)
+// =========================
+
+// Sem -DINSTRUMENTAR as macros abaixo nao geram codigo algum
+#ifdef INSTRUMENTAR
+
+static inline uint64_t instrAgora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+void instrRegistrar(MedidaInstr m, uint64_t v);
+void iniciarInstrumentos(int json, int naSaida);
+
+#define INSTR_INICIO(var) uint64_t var = instrAgora()
+#define INSTR_FIM(medida, var) instrRegistrar((medida), instrAgora() - (var))
+#define INSTR_VALOR(medida, v) instrRegistrar((medida), (uint64_t) (v))
+
+#else
+
+#define INSTR_INICIO(var) ((void) 0)
+#define INSTR_FIM(medida, var) ((void) 0)
+#define INSTR_VALOR(medida, v) ((void) 0)
+
+#endif
+
+// =========================
+// FUNCOES AUXILIARES (mestre_nucleo.c)
+// =========================
+
+void strToLower(const char *src, char *buffer);
+unsigned int hashFunc(const char *str);
+extern uint64_t sementeHash;
+void inicializarSementeHash(void);
+uint64_t hashTexto(const void *dados, size_t n, uint64_t semente);
+double agoraNs(void);
+int opcaoGlobal(const char *opcao);
+void aplicarOpcaoGlobal(const char *opcao, const char *valor);
+
+// =========================
+// CONTABILIDADE DE MEMORIA (mestre_nucleo.c)
+// =========================
+
+#ifdef CONTABILIZAR_MEMORIA
+void iniciarRelatorioMemoria(int json);
+#endif
+
+// =========================
+// ALOCADOR DE OBJETOS (mestre_nucleo.c)
+// =========================
+
+void inicializarAlocadorObjetos(AlocadorObjetos *a, ModoAlocador modo, size_t tamObjeto,
+                                CategoriaMemoria categoria);
+extern const char *nomesModosAlocador[NUM_MODOS_ALOCADOR];
+
+// =========================
+// TEXTOS INTERNADOS (mestre_nucleo.c)
+// =========================
+
+void liberarInternos(InternPool *p);
+uint32_t internar(InternPool *p, const char *s, size_t max);
+void inicializarInternos(InternPool *p);
+uint32_t totalInternos(const InternPool *p);
+const char* textoInterno(const InternPool *p, uint32_t id);
+void prepararInternos(InternPool *p);
+
+// =========================
+// FUNCOES PARA SALAS E MANSAO (mestre_nucleo.c)
+// =========================
+
+void inicializarConstrutor(ConstrutorMansao *c, uint32_t numSalas);
+void descartarConstrutor(ConstrutorMansao *c);
+int32_t criarSala(ConstrutorMansao *c, const char *nome, const char *pista);
+int abrirImagem(Mansao *m, const unsigned char *base, size_t tam);
+int salaValida(const Mansao *m, int32_t i);
+const char* nomeSala(const Mansao *m, int32_t i);
+const char* pistaSala(const Mansao *m, int32_t i);
+int carregarMansao(const char *caminho, Mansao *m);
+void liberarMansao(Mansao *m);
+int compilarMansao(const char *entrada, const char *saida);
+
+// numero de saidas da sala valida 'i' (0 se os deslocamentos da imagem forem inconsistentes)
+static inline uint32_t numSaidasSala(const Mansao *m, int32_t i) {
+    uint32_t a = m->inicioSaidas[i], b = m->inicioSaidas[i + 1];
+    return (a <= b && b <= m->numSaidas) ? b - a : 0;
+}
+
+// destino da k-esima saida (a partir de 0) da sala valida 'i'; -1 se nao houver
+static inline int32_t saidaSala(const Mansao *m, int32_t i, uint32_t k) {
+    return k < numSaidasSala(m, i) ? m->saidas[m->inicioSaidas[i] + k] : -1;
+}
+
+// =========================
+// GERADOR DE MANSOES (mestre_nucleo.c)
+// =========================
+
+extern const char *NOMES_DISTRIBUICAO[NUM_DISTRIBUICOES];
+void chaveDistribuicao(DistribuicaoChaves d, uint64_t i, unsigned bits, uint64_t semente, char *k);
+int lerLimitado(const char *txt, unsigned long long min, unsigned long long max, uint64_t *v);
+int lerParamGeracao(const char *spec, ParamGeracao *g);
+void gerarMansao(const ParamGeracao *g, Mansao *m);
+int gerarMansaoArquivo(const ParamGeracao *g, const char *saida);
+
+// sorteioGerador() – numero pseudoaleatorio do item 'i' no 'canal' (splitmix64 sobre a semente)
+// o gerador nao tem estado: qualquer sala pode ser refeita isoladamente, em qualquer passada
+static inline uint64_t sorteioGerador(uint64_t semente, uint64_t i, uint64_t canal) {
+    uint64_t z = semente + (i + 1) * 0x9E3779B97F4A7C15ull + canal * 0xD1B54A32D192ED03ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// reduz um sorteio de 64 bits ao intervalo [0, n) com uma multiplicacao (sem divisao)
+static inline uint32_t sorteioAte(uint64_t r, uint32_t n) {
+    return (uint32_t) (((r >> 32) * (uint64_t) n) >> 32);
+}
+
+// =========================
+// FUNCOES PARA ARVORE AVL DE PISTAS (mestre_nucleo.c)
+// =========================
+
+void liberarPistas(ArvorePistas *arv);
+int inserirPistaId(ArvorePistas *arv, uint32_t pista);
+int inserirPista(ArvorePistas *arv, const char *pista);
+void inicializarPistas(ArvorePistas *arv, InternPool *textos);
+size_t construirPistas(ArvorePistas *arv, const uint32_t *ids, size_t n, int numThreads);
+void limparPistas(ArvorePistas *arv);
+void abrirCursor(CursorPistas *c, const ArvorePistas *arv, const char *de, const char *ate);
+uint32_t proximaPista(CursorPistas *c);
+extern ModoAlocador modoAlocadorPistas;
+
+// =========================
+// FUNCOES PARA TABELA HASH (mestre_nucleo.c)
+// =========================
+
+void inserirNaHashId(HashTable *ht, uint32_t pista, uint32_t suspeito, uint32_t chave, uint32_t peso);
+void inserirNaHash(HashTable *ht, const char *pista, const char *suspeito);
+const char* encontrarSuspeito(HashTable *ht, const char *pista);
+void carregarHashEmLote(HashTable *ht, const Associacao *a, size_t n);
+void liberarHashPerfeita(HashPerfeita *hp);
+void construirHashPerfeita(const HashTable *ht, HashPerfeita *hp);
+uint32_t pesoContra(const HashTable *ht, const HashEntrada *e, uint32_t idx);
+void inicializarHash(HashTable *ht, InternPool *textos);
+const HashEntrada* encontrarEntrada(const HashTable *ht, uint32_t pista);
+void liberarHash(HashTable *ht);
+void popularHash(HashTable *ht, const Mansao *m);
+void abrirHashPerfeita(HashTable *ht, const HashPerfeita *hp, InternPool *textos);
+
+// suspeitos implicados pela pista da entrada 'e' (e->suspeitos.quantidade postagens, na ordem de cadastro)
+static inline const Postagem* suspeitosDaPista(const HashTable *ht, const HashEntrada *e) {
+    return ht->postagensPistas.itens + e->suspeitos.inicio;
+}
+
+// pistas que implicam o suspeito 'idx' (ht->pistasSuspeito[idx].quantidade postagens)
+static inline const Postagem* pistasDoSuspeito(const HashTable *ht, uint32_t idx) {
+    return ht->postagensSuspeitos.itens + ht->pistasSuspeito[idx].inicio;
+}
+
+// implicaSuspeito() – 1 se a pista da entrada 'e' soma pontos contra o suspeito 'idx';
+// com mascaras precalculadas (hash perfeita, ate 64 suspeitos) e um teste de bit
+static inline int implicaSuspeito(const HashTable *ht, const HashEntrada *e, uint32_t idx) {
+    if (ht->mascaras != NULL) return (int) ((ht->mascaras[e - ht->entradas] >> idx) & 1);
+    return pesoContra(ht, e, idx) > 0;
+}
+
+// =========================
+// RELATORIO DE PISTAS (SAIDA BUFERIZADA) (mestre_nucleo.c)
+// =========================
+
+void exibirPistasInOrder(const ArvorePistas *arv);
+void inicializarBufferSaida(BufferSaida *b, FILE *destino, char *memoria, size_t cap);
+void inicializarBufferCrescente(BufferSaida *b, size_t cap);
+void liberarBufferCrescente(BufferSaida *b);
+void descarregarBuffer(BufferSaida *b);
+__attribute__((format(printf, 2, 3)))
+void bufFormatar(BufferSaida *b, const char *fmt, ...);
+void bufTexto(BufferSaida *b, const char *s);
+void bufSuspeitos(BufferSaida *b, const HashTable *ht, const HashEntrada *e);
+size_t relatorioPistas(const ArvorePistas *arv, const HashTable *ht, BufferSaida *b,
+                       FormatoRelatorio formato, const char *de, const char *ate, const char *prefixo);
+
+// =========================
+// ENTRADA BUFERIZADA (mestre_nucleo.c)
+// =========================
+
+void inicializarLeitor(LeitorEntrada *l, int fd);
+ResultadoLinha lerLinhaEntrada(LeitorEntrada *l, char **linha, size_t *tam);
+
+// =========================
+// CONTADORES DE EVIDENCIAS (mestre_nucleo.c)
+// =========================
+
+void liberarEvidencias(Evidencias *ev);
+void inicializarEvidencias(Evidencias *ev, const HashTable *ht, uint32_t limiar);
+uint32_t limiarDoCaso(const Mansao *m, uint32_t pedido);
+void pontuarSuspeitos(Evidencias *ev, const HashTable *ht, const uint32_t *pistas, size_t n);
+uint32_t suspeitoPorNome(const HashTable *ht, const char *nome);
+uint32_t evidenciasContra(const Evidencias *ev, const HashTable *ht, const char *nome);
+void escreverRanking(BufferSaida *b, const Evidencias *ev, const HashTable *ht);
+
+// =========================
+// INDICE DE NOMES DE SUSPEITOS (mestre_nucleo.c)
+// =========================
+
+size_t normalizarNome(const char *src, char *dst, size_t cap);
+uint32_t buscarNomeAproximado(IndiceNomes *ix, const char *nome, uint32_t limite,
+                              uint32_t *saida, uint32_t max, uint32_t *dist);
+void* alocarIndiceNomes(size_t n, size_t tam);
+void construirIndiceNomes(IndiceNomes *ix, const HashTable *ht);
+uint32_t completarNome(IndiceNomes *ix, const char *prefixo, uint32_t *saida, uint32_t max);
+ResultadoNome resolverNomeAcusado(IndiceNomes *ix, const HashTable *ht, const char *nome,
+                                  uint32_t *candidatos, uint32_t max, uint32_t *numCandidatos);
+void liberarIndiceNomes(IndiceNomes *ix);
+
+// =========================
+// SESSOES DE INVESTIGACAO (mestre_nucleo.c)
+// =========================
+
+int marcarVisita(ConjuntoSalas *c, int32_t sala);
+int salaMarcada(const ConjuntoSalas *c, int32_t sala);
+void limparVisitas(ConjuntoSalas *c);
+void iniciarSessao(Sessao *se, const Mansao *m, const HashTable *ht, uint32_t limiar);
+void reiniciarSessao(Sessao *se, const Mansao *m);
+int coletarPistaSala(Sessao *se, const Mansao *m, const HashTable *ht);
+int32_t salaAnterior(const Sessao *se);
+int32_t salaMaisAntiga(const Sessao *se);
+ResultadoMovimento moverParaSaida(Sessao *se, const Mansao *m, uint32_t k);
+ResultadoMovimento moverSessao(Sessao *se, const Mansao *m, char escolha);
+void liberarSessao(Sessao *se);
+
+// =========================
+// DIARIO DE SESSOES (SNAPSHOTS E DELTAS) (mestre_nucleo.c)
+// =========================
+
+void registrarSessao(DiarioSessoes *d, uint32_t id, Sessao *se);
+int gravarDiario(DiarioSessoes *d);
+int abrirDiario(DiarioSessoes *d, const char *caminho, const Mansao *m, const HashTable *ht,
+                Sessao *sessoes, size_t numSessoes, size_t *restauradas);
+int compactarDiario(DiarioSessoes *d, Sessao *sessoes, size_t numSessoes);
+void fecharDiario(DiarioSessoes *d);
+
+// =========================
+// CONSULTAS DE CAMINHO E ALCANCE (mestre_nucleo.c)
+// =========================
+
+int32_t caminhoMaisCurto(ConsultasMansao *cq, int32_t de, int32_t para, char *rota, size_t cap);
+void* alocarConsulta(size_t n, size_t tam);
+int alcanca(ConsultasMansao *cq, int32_t de, int32_t para);
+char letraSaida(uint32_t k);
+void prepararConsultas(ConsultasMansao *cq, const Mansao *m, const HashTable *ht);
+int resumoAlcance(const ConsultasMansao *cq);
+uint32_t contarPistasAlcancaveis(ConsultasMansao *cq, int32_t de, uint32_t idxSuspeito);
+int32_t rotaPistaMaisProxima(ConsultasMansao *cq, const Sessao *se, uint32_t idxSuspeito,
+                             char *rota, size_t cap, int32_t *destino);
+void liberarConsultas(ConsultasMansao *cq);
+
+// =========================
+// EXPLORACAO DA MANSAO (mestre_jogo.c)
+// =========================
+
+extern const char TEXTO_ABERTURA[];
+extern const char TEXTO_DESPEDIDA[];
+void escreverTelaSala(BufferSaida *b, const Mansao *m, const Sessao *se, const HashTable *ht,
+                      ConsultasMansao *cq);
+ResultadoComando processarComando(BufferSaida *b, const Mansao *m, Sessao *se, const HashTable *ht,
+                                  ConsultasMansao *cq, const char *linha);
+void explorarSalas(const Mansao *m, Sessao *se, HashTable *ht, DiarioSessoes *diario, ConsultasMansao *cq,
+                   LeitorEntrada *entrada);
+
+// =========================
+// MODO REPLAY (SEM INTERFACE) (mestre_jogo.c)
+// =========================
+
+size_t reproduzirRoteiros(FILE *entrada, FILE *saida, const Mansao *m, HashTable *ht, uint32_t limiar);
+
+// =========================
+// MOTOR PARALELO DE SESSOES (mestre_jogo.c)
+// =========================
+
+size_t carregarRoteiros(FILE *entrada, char **buffer, Roteiro **roteiros);
+int pegarLote(FaixaTrabalho *f, uint32_t lote, uint32_t *ini, uint32_t *fim);
+int roubarMetade(FaixaTrabalho *vitima, uint32_t *ini, uint32_t *fim);
+void executarSessoesParalelo(const Mansao *m, HashTable *ht, uint32_t limiar, const Roteiro *roteiros, size_t n,
+                             int numThreads, ResultadoSessao *resultados);
+void escreverResultados(FILE *saida, const Roteiro *roteiros, const ResultadoSessao *res, size_t n, uint32_t limiar);
+
+// faixa [inicio, fim) de roteiros compactada num unico inteiro atomico (inicio nos 32 bits altos)
+static inline uint64_t empacotarFaixa(uint32_t inicio, uint32_t fim) {
+    return ((uint64_t) inicio << 32) | fim;
+}
+
+// =========================
+// SIMULACAO DE AGENTES (mestre_simulacao.c)
+// =========================
+
+int lerParamSimulacao(const char *spec, ParamSimulacao *p);
+int simularAgentes(FILE *saida, const Mansao *m, const HashTable *ht, const ParamSimulacao *p,
+                   int numThreads, FILE *registros);
+
+// =========================
+// SOLUCIONADOR DE CAMINHOS (mestre_jogo.c)
+// =========================
+
+void resolverCaminhos(const Mansao *m, const HashTable *ht, uint32_t limiar, SolucaoCaminhos *sol);
+void exibirSolucao(const Mansao *m, const HashTable *ht, const SolucaoCaminhos *sol);
+void liberarSolucao(SolucaoCaminhos *sol);
+
+// =========================
+// AVALIACAO FINAL (mestre_jogo.c)
+// =========================
+
+int iniciarJulgamento(BufferSaida *b, const Sessao *se);
+ResultadoAcusacao processarAcusacao(BufferSaida *b, Sessao *se, const HashTable *ht, IndiceNomes *nomes,
+                                    const char *linha);
+int verificarSuspeitoFinal(Sessao *se, HashTable *ht, IndiceNomes *nomes, LeitorEntrada *entrada);
+
+// =========================
+// VERSOES DO CASO (PUBLICACAO POR EPOCAS) (mestre_servidor.c)
+// =========================
+
+VersaoCaso* montarVersaoCaso(Mansao *m, HashTable *ht, uint32_t limiar);
+void liberarVersaoCaso(VersaoCaso *v);
+void iniciarPublicador(PublicadorCasos *pub, VersaoCaso *inicial);
+int registrarLeitor(PublicadorCasos *pub);
+size_t recolherVersoes(PublicadorCasos *pub);
+void publicarVersao(PublicadorCasos *pub, VersaoCaso *nova);
+void encerrarPublicador(PublicadorCasos *pub);
+
+// entrarLeitura() – anuncia a epoca e devolve a versao atual, valida ate sairLeitura(). Sem travas:
+// um store e dois loads. O anuncio vem antes da leitura do ponteiro (seq_cst), entao quem publica
+// e ve este leitor ocioso ou numa epoca nova sabe que ele nao pode estar com a versao retirada
+static inline VersaoCaso* entrarLeitura(PublicadorCasos *pub, int leitor) {
+    atomic_store(&pub->leitores[leitor].epoca, atomic_load(&pub->epoca));
+    return atomic_load(&pub->atual);
+}
+
+static inline void sairLeitura(PublicadorCasos *pub, int leitor) {
+    atomic_store_explicit(&pub->leitores[leitor].epoca, EPOCA_OCIOSO, memory_order_release);
+}
+
+// uma sessao que vai continuar usando a versao depois de sairLeitura() precisa prende-la antes
+static inline void prenderVersao(VersaoCaso *v) {
+    atomic_fetch_add_explicit(&v->sessoes, 1, memory_order_relaxed);
+}
+
+static inline void soltarVersao(VersaoCaso *v) {
+    atomic_fetch_sub_explicit(&v->sessoes, 1, memory_order_release);
+}
+
+// =========================
+// SERVIDOR DE SESSOES (mestre_servidor.c)
+// =========================
+
+int servirSessoes(const char *caminho, PublicadorCasos *casos);
+
+// =========================
+// MANSAO COMPILADA EM C (mestre_codegen.c)
+// =========================
+
+int gerarMansaoC(const char *entrada, const char *saida);
+void abrirMansaoFixa(const MansaoFixa *fixa, Mansao *m, HashTable *ht);
+
+// =========================
+// MANSAO PADRAO (mestre_nucleo.c)
+// =========================
+
+const MansaoFixa* mansaoFixaCompilada(void);
+void montarMansaoPadrao(Mansao *m);
+
+// =========================
+// RECARGA DO CASO (mestre_servidor.c)
+// =========================
+
+void iniciarRecarga(RecargaCaso *r, PublicadorCasos *casos, const FonteCaso *fonte);
+void pararRecarga(RecargaCaso *r);
+
+#endif
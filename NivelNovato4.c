@@ -22,6 +22,14 @@ Sala* criarSala(const char *nome) {
     return novaSala;
 }
 
+// Libera a sala e todas as salas abaixo dela (pos-ordem), qualquer que seja o formato do mapa
+void liberarSalas(Sala *raiz) {
+    if (raiz == NULL) return;
+    liberarSalas(raiz->esquerda);
+    liberarSalas(raiz->direita);
+    free(raiz);
+}
+
 // Funcao que permite explorar as salas da mansao
 void explorarSalas(Sala *salaAtual) {
     char escolha;
@@ -44,7 +52,7 @@ void explorarSalas(Sala *salaAtual) {
             printf("  (d) %s\n", salaAtual->direita->nome);
         printf("  (s) Sair da exploracao\n");
         printf("Escolha: ");
-        scanf(" %c", &escolha);
+        if (scanf(" %c", &escolha) != 1) break; // fim da entrada
 
         if (escolha == 'e' && salaAtual->esquerda != NULL) {
             salaAtual = salaAtual->esquerda;
@@ -85,13 +93,7 @@ int main() {
     explorarSalas(hall);
 
     // Libera memoria (boa pratica)
-    free(hall);
-    free(salaEstar);
-    free(cozinha);
-    free(biblioteca);
-    free(jardim);
-    free(porao);
-    free(quarto);
+    liberarSalas(hall);
 
     return 0;
 }
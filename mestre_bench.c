@@ -0,0 +1,733 @@
+// Benchmarks do Detetive Quest (nivel mestre): suite de micro-benchmarks das estruturas e
+// medicoes de sessoes, diario e consultas sobre um mapa. Compilar: make NivelMestre4_bench
+
+#include "NivelMestre4.h"
+
+#define BENCH_FORMATO 2       // versao do formato JSON dos benchmarks
+#define BENCH_BITS_COLISAO 13 // a distribuicao 'colidindo' gera ate 2^13 chaves
+#define BENCH_SUSPEITOS 4096  // suspeitos do benchmark de pontuacao
+
+// Estado de uma medicao da suite de benchmarks
+typedef struct MedicaoBench {
+    double inicio;
+    size_t alocacoes;
+    size_t memoria;   // bytes vivos no heap no inicio (contabilidade de memoria)
+    int fdCache;   // contador de falhas de cache (-1 se indisponivel)
+} MedicaoBench;
+
+// =========================
+// SUITE DE MICRO-BENCHMARKS
+// =========================
+
+
+// abre um contador de falhas de cache do processo (perf_event_open); -1 se indisponivel
+static int abrirContadorCache(void) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof attr;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    return -1;
+#endif
+}
+
+static void iniciarMedicao(MedicaoBench *md) {
+#ifdef CONTABILIZAR_MEMORIA
+    md->alocacoes = totalAlocacoes;
+    md->memoria = atomic_load(&memoriaViva);
+#endif
+#ifdef __linux__
+    if (md->fdCache >= 0) {
+        ioctl(md->fdCache, PERF_EVENT_IOC_RESET, 0);
+        ioctl(md->fdCache, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+    md->inicio = agoraNs();
+}
+
+// encerra a medicao de 'ops' operacoes e escreve uma linha JSON em 'saida'
+static void terminarMedicao(MedicaoBench *md, FILE *saida, const char *operacao, const char *dist, size_t ops) {
+    double ns = agoraNs() - md->inicio;
+    long long falhas = -1;
+#ifdef __linux__
+    if (md->fdCache >= 0) {
+        uint64_t v;
+        ioctl(md->fdCache, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(md->fdCache, &v, sizeof v) == (ssize_t) sizeof v) falhas = (long long) v;
+    }
+#endif
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    if (ops == 0) ops = 1;
+    fprintf(saida, "{\"formato\":%d,\"operacao\":\"%s\",\"distribuicao\":\"%s\",\"n\":%zu,\"ns_por_op\":%.2f,",
+            BENCH_FORMATO, operacao, dist, ops, ns / (double) ops);
+    // alocacoes e bytes so sao contados com a contabilidade de memoria (make NivelMestre4_bench a liga)
+#ifdef CONTABILIZAR_MEMORIA
+    size_t aloc = totalAlocacoes - md->alocacoes;
+    double bytes = (double) atomic_load(&memoriaViva) - (double) md->memoria;
+    fprintf(saida, "\"alocacoes_por_op\":%.3f,\"bytes_por_op\":%.2f,",
+            (double) aloc / (double) ops, bytes / (double) ops);
+#else
+    fprintf(saida, "\"alocacoes_por_op\":null,\"bytes_por_op\":null,");
+#endif
+    fprintf(saida, "\"rss_pico_kb\":%ld,", ru.ru_maxrss);
+    if (falhas >= 0) fprintf(saida, "\"falhas_cache_por_op\":%.3f}\n", (double) falhas / (double) ops);
+    else fprintf(saida, "\"falhas_cache_por_op\":null}\n");
+}
+
+// gerarChavesBench() – preenche 'n' chaves (passo MAXPISTA) segundo a distribuicao (semente fixa)
+// retorna o numero de chaves geradas ('colidindo' limita n a 2^BENCH_BITS_COLISAO)
+static size_t gerarChavesBench(char *chaves, size_t n, DistribuicaoChaves d) {
+    if (d == CHAVES_COLIDINDO && n > ((size_t) 1 << BENCH_BITS_COLISAO))
+        n = (size_t) 1 << BENCH_BITS_COLISAO;
+    for (size_t i = 0; i < n; ++i)
+        chaveDistribuicao(d, i, BENCH_BITS_COLISAO, 0x2545F4914F6CDD1Dull, chaves + i * MAXPISTA);
+    return n;
+}
+
+// executa a suite para uma distribuicao de chaves
+static void benchDistribuicao(FILE *saida, size_t n, DistribuicaoChaves d, int fdCache) {
+    char *chaves = (char*) memAlocar(MEM_BENCH, n * MAXPISTA);
+    if (chaves == NULL) { printf("Erro: memoria insuficiente (benchmark).\n"); exit(1); }
+    n = gerarChavesBench(chaves, n, d);
+    const char *dist = NOMES_DISTRIBUICAO[d];
+    MedicaoBench md;
+    md.fdCache = fdCache;
+
+    volatile unsigned int soma = 0;
+    iniciarMedicao(&md);
+    for (size_t i = 0; i < n; ++i) soma += hashFunc(chaves + i * MAXPISTA);
+    terminarMedicao(&md, saida, "hashFunc", dist, n);
+
+    // criarSala: salas com as chaves como nome e pista
+    ConstrutorMansao c;
+    inicializarConstrutor(&c, 0);
+    iniciarMedicao(&md);
+    for (size_t i = 0; i < n; ++i) criarSala(&c, chaves + i * MAXPISTA, chaves + i * MAXPISTA);
+    terminarMedicao(&md, saida, "criarSala", dist, n);
+    descartarConstrutor(&c);
+
+    InternPool textos;
+    inicializarInternos(&textos);
+    HashTable ht;
+    inicializarHash(&ht, &textos);
+    iniciarMedicao(&md);
+    for (size_t i = 0; i < n; ++i) inserirNaHash(&ht, chaves + i * MAXPISTA, (i & 1) ? "Sr. Silva" : "Dra. Costa");
+    terminarMedicao(&md, saida, "inserirNaHash", dist, n);
+
+    iniciarMedicao(&md);
+    for (size_t i = 0; i < n; ++i) if (encontrarSuspeito(&ht, chaves + ((i * 7919) % n) * MAXPISTA) != NULL) soma++;
+    terminarMedicao(&md, saida, "encontrarSuspeito", dist, n);
+
+    // buscas que falham: as mesmas chaves com um primeiro caractere que nenhuma distribuicao gera
+    char *ausentes = (char*) memAlocar(MEM_BENCH, n * MAXPISTA);
+    if (ausentes == NULL) { printf("Erro: memoria insuficiente (benchmark).\n"); exit(1); }
+    memcpy(ausentes, chaves, n * MAXPISTA);
+    for (size_t i = 0; i < n; ++i) ausentes[i * MAXPISTA] = '#';
+    iniciarMedicao(&md);
+    for (size_t i = 0; i < n; ++i) if (encontrarSuspeito(&ht, ausentes + ((i * 7919) % n) * MAXPISTA) != NULL) soma++;
+    terminarMedicao(&md, saida, "encontrarSuspeito(ausente)", dist, n);
+    memLiberar(ausentes);
+
+    // as pistas ja estao internadas: mede a arvore (e nao a tabela de textos)
+    ArvorePistas arv;
+    inicializarPistas(&arv, &textos);
+    iniciarMedicao(&md);
+    for (size_t i = 0; i < n; ++i) inserirPista(&arv, chaves + i * MAXPISTA);
+    terminarMedicao(&md, saida, "inserirPista", dist, n);
+
+    // exibirPistasInOrder com a saida padrao redirecionada para /dev/null
+    fflush(stdout);
+    int salvo = dup(STDOUT_FILENO), nulo = open("/dev/null", O_WRONLY);
+    if (salvo >= 0 && nulo >= 0) {
+        dup2(nulo, STDOUT_FILENO);
+        iniciarMedicao(&md);
+        exibirPistasInOrder(&arv);
+        fflush(stdout);
+        dup2(salvo, STDOUT_FILENO);
+        terminarMedicao(&md, saida, "exibirPistasInOrder", dist, arv.total);
+    }
+    if (salvo >= 0) close(salvo);
+    if (nulo >= 0) close(nulo);
+
+    // relatorio JSON completo (com o suspeito de cada pista) descartado em /dev/null
+    FILE *fnulo = fopen("/dev/null", "w");
+    if (fnulo != NULL) {
+        char memoria[BUFFER_SAIDA];
+        BufferSaida b;
+        inicializarBufferSaida(&b, fnulo, memoria, sizeof memoria);
+        iniciarMedicao(&md);
+        size_t escritas = relatorioPistas(&arv, &ht, &b, RELATORIO_JSON, NULL, NULL, NULL);
+        fflush(fnulo);
+        terminarMedicao(&md, saida, "relatorioPistasJson", dist, escritas);
+        fclose(fnulo);
+    }
+
+    size_t total = arv.total;
+    iniciarMedicao(&md);
+    liberarPistas(&arv);
+    terminarMedicao(&md, saida, "liberarPistas", dist, total);
+
+    total = ht.quantidade;
+    iniciarMedicao(&md);
+    liberarHash(&ht);
+    terminarMedicao(&md, saida, "liberarHash", dist, total);
+
+    total = totalInternos(&textos);
+    iniciarMedicao(&md);
+    liberarInternos(&textos);
+    terminarMedicao(&md, saida, "liberarInternos", dist, total);
+
+    memLiberar(chaves);
+}
+
+// executarBenchmarks() – roda a suite completa e escreve uma linha JSON por medicao
+static void executarBenchmarks(FILE *saida, size_t n) {
+    int fdCache = abrirContadorCache();
+    for (int d = 0; d < NUM_DISTRIBUICOES; ++d)
+        benchDistribuicao(saida, n, (DistribuicaoChaves) d, fdCache);
+    if (fdCache >= 0) close(fdCache);
+}
+
+// =========================
+// BUSCAS NA HASH POR TAMANHO DA TABELA
+// =========================
+
+#define BENCH_TAM_CHAVE_BUSCA 24 // "pista_%07zu_quebrado" e "pista_%07zu_ausente" cabem com folga
+
+// benchmarkBuscas() – encontrarSuspeito numa hash com 'n' associacoes, acertando e errando
+// (pistas ausentes) em ordem espalhada, ao menos 1M buscas de cada. As chaves sao geradas antes
+// da medicao. A distribuicao e o tamanho da tabela: a suite roda com 1K, 100K e 1M entradas
+static void benchmarkBuscas(FILE *saida, size_t n) {
+    InternPool textos;
+    inicializarInternos(&textos);
+    HashTable ht;
+    inicializarHash(&ht, &textos);
+    char *presentes = (char*) memAlocar(MEM_BENCH, n * BENCH_TAM_CHAVE_BUSCA);
+    char *ausentes = (char*) memAlocar(MEM_BENCH, n * BENCH_TAM_CHAVE_BUSCA);
+    if (presentes == NULL || ausentes == NULL) { printf("Erro: memoria insuficiente (benchmark).\n"); exit(1); }
+    for (size_t i = 0; i < n; ++i) {
+        snprintf(presentes + i * BENCH_TAM_CHAVE_BUSCA, BENCH_TAM_CHAVE_BUSCA, "pista_%07zu_quebrado", i);
+        snprintf(ausentes + i * BENCH_TAM_CHAVE_BUSCA, BENCH_TAM_CHAVE_BUSCA, "pista_%07zu_ausente", i);
+        inserirNaHash(&ht, presentes + i * BENCH_TAM_CHAVE_BUSCA, (i % 3 == 0) ? "Sr. Silva" : "Dra. Costa");
+    }
+
+    char dist[32];
+    snprintf(dist, sizeof dist, "tabela_%zu", n);
+    size_t buscas = n < 1000000 ? 1000000 : n, achados = 0;
+    MedicaoBench md = { .fdCache = abrirContadorCache() };
+    iniciarMedicao(&md);
+    for (size_t k = 0; k < buscas; ++k)
+        achados += encontrarSuspeito(&ht, presentes + (k * 2654435761u) % n * BENCH_TAM_CHAVE_BUSCA) != NULL;
+    terminarMedicao(&md, saida, "encontrarSuspeito", dist, buscas);
+    iniciarMedicao(&md);
+    for (size_t k = 0; k < buscas; ++k)
+        achados += encontrarSuspeito(&ht, ausentes + (k * 2654435761u) % n * BENCH_TAM_CHAVE_BUSCA) != NULL;
+    terminarMedicao(&md, saida, "encontrarSuspeito(ausente)", dist, buscas);
+    if (achados != buscas) fprintf(stderr, "Aviso: %zu buscas acertaram, esperado %zu.\n", achados, buscas);
+
+    if (md.fdCache >= 0) close(md.fdCache);
+    memLiberar(presentes);
+    memLiberar(ausentes);
+    liberarHash(&ht);
+    liberarInternos(&textos);
+}
+
+// =========================
+// BENCHMARK DA PONTUACAO DE SUSPEITOS
+// =========================
+
+// benchmarkPontuacao() – 'n' pistas, cada uma implicando de 1 a 3 de BENCH_SUSPEITOS suspeitos
+// com pesos de 1 a 4; mede o cadastro das associacoes e a pontuacao de sessoes com 64 pistas
+// (JSON, uma linha por medicao, no formato da --suite)
+static void benchmarkPontuacao(FILE *saida, size_t n) {
+    InternPool textos;
+    inicializarInternos(&textos);
+    HashTable ht;
+    inicializarHash(&ht, &textos);
+    char nome[MAXNOME], chave[MAXNOME];
+    uint32_t *suspeitos = (uint32_t*) memAlocar(MEM_EVIDENCIAS, BENCH_SUSPEITOS * 2 * sizeof(uint32_t));
+    uint32_t *pistas = (uint32_t*) memAlocar(MEM_EVIDENCIAS, n * sizeof(uint32_t));
+    if (suspeitos == NULL || pistas == NULL) { printf("Erro: memoria insuficiente (benchmark).\n"); exit(1); }
+    for (uint32_t s = 0; s < BENCH_SUSPEITOS; ++s) {
+        snprintf(nome, sizeof nome, "Suspeito %u", s);
+        strToLower(nome, chave);
+        suspeitos[2 * s] = internar(&textos, nome, MAXNOME);
+        suspeitos[2 * s + 1] = internar(&textos, chave, MAXNOME);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        snprintf(nome, sizeof nome, "pista_%zu", i);
+        pistas[i] = internar(&textos, nome, MAXPISTA);
+    }
+
+    MedicaoBench md = { .fdCache = -1 };
+    const char *dist = "muitos_suspeitos";
+    uint64_t x = 0x2545F4914F6CDD1Dull;
+    size_t associacoes = 0;
+    iniciarMedicao(&md);
+    for (size_t i = 0; i < n; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17; // xorshift64
+        for (uint32_t k = 0; k <= x % 3; ++k) {
+            uint32_t s = (uint32_t) ((x >> (8 + 12 * k)) % BENCH_SUSPEITOS);
+            inserirNaHashId(&ht, pistas[i], suspeitos[2 * s], suspeitos[2 * s + 1], 1 + (uint32_t) ((x >> (4 + k)) & 3));
+            associacoes++;
+        }
+    }
+    terminarMedicao(&md, saida, "inserirNaHashId", dist, associacoes);
+
+    // cada sessao coleta 64 pistas sorteadas e pontua todos os suspeitos de uma vez
+    const size_t porSessao = 64, sessoes = n / porSessao > 0 ? n / porSessao : 1;
+    Evidencias ev;
+    inicializarEvidencias(&ev, &ht, LIMIAR_CULPA);
+    uint32_t coletadas[64];
+    volatile uint32_t soma = 0;
+    iniciarMedicao(&md);
+    for (size_t r = 0; r < sessoes; ++r) {
+        for (size_t i = 0; i < porSessao; ++i) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            coletadas[i] = pistas[x % n];
+        }
+        pontuarSuspeitos(&ev, &ht, coletadas, porSessao);
+        soma += ev.pontos[r % ev.numSuspeitos];
+    }
+    terminarMedicao(&md, saida, "pontuarSuspeitos", dist, sessoes);
+    (void) soma;
+
+    liberarEvidencias(&ev);
+    liberarHash(&ht);
+    liberarInternos(&textos);
+    memLiberar(suspeitos);
+    memLiberar(pistas);
+}
+
+// =========================
+// BENCHMARKS DO INDICE DE NOMES E DA CARGA
+// =========================
+
+// gera o nome do suspeito 'i' para o benchmark: titulo, prenome e sobrenome de silabas
+// pseudoaleatorias (muitos prefixos em comum, como numa lista real de nomes)
+static void nomeBench(size_t i, char *buf, size_t cap) {
+    static const char *titulos[] = { "Sr.", "Sra.", "Dr.", "Dra." };
+    static const char *silabas[] = { "ba", "ca", "da", "fe", "go", "li", "ma", "no", "pe", "ra",
+                                     "sil", "to", "va", "xi", "ze", "lu" };
+    uint64_t x = (i + 1) * 0x9E3779B97F4A7C15ull;
+    x ^= x >> 29;
+    char pre[16] = "", sob[24] = "";
+    for (int k = 0; k < 3; ++k, x >>= 4) strcat(pre, silabas[x & 15]);
+    for (int k = 0; k < 4; ++k, x >>= 4) strcat(sob, silabas[x & 15]);
+    pre[0] = (char) (pre[0] - 32);
+    sob[0] = (char) (sob[0] - 32);
+    snprintf(buf, cap, "%s %s %s %zu", titulos[x & 3], pre, sob, i);
+}
+
+// benchmarkNomes() – 'n' nomes de suspeitos: construcao do indice e consultas de acusacao
+// exata, por prefixo e com um erro de digitacao (JSON, uma linha por medicao, no formato da --suite)
+static void benchmarkNomes(FILE *saida, size_t n) {
+    InternPool textos;
+    inicializarInternos(&textos);
+    HashTable ht;
+    inicializarHash(&ht, &textos);
+    char nome[MAXNOME], pista[32];
+    for (size_t i = 0; i < n; ++i) {
+        nomeBench(i, nome, sizeof nome);
+        snprintf(pista, sizeof pista, "pista_%zu", i);
+        inserirNaHash(&ht, pista, nome);
+    }
+    MedicaoBench md = { .fdCache = -1 };
+    const char *dist = "nomes";
+    IndiceNomes ix;
+    iniciarMedicao(&md);
+    construirIndiceNomes(&ix, &ht);
+    terminarMedicao(&md, saida, "construirIndiceNomes", dist, n);
+
+    // consultas a partir de nomes sorteados, preparadas antes da medicao
+    const size_t consultas = n < 100000 ? n : 100000;
+    char *exatos = (char*) alocarIndiceNomes(consultas, MAXNOME);
+    char *prefixos = (char*) alocarIndiceNomes(consultas, MAXNOME);
+    char *erros = (char*) alocarIndiceNomes(consultas, MAXNOME);
+    uint64_t x = 0x2545F4914F6CDD1Dull;
+    for (size_t i = 0; i < consultas; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17; // xorshift64
+        nomeBench(x % n, nome, sizeof nome);
+        char *sobrenome = strchr(strchr(nome, ' ') + 1, ' ') + 1;
+        snprintf(exatos + i * MAXNOME, MAXNOME, "%s", sobrenome);          // "Silbafe 17"
+        snprintf(prefixos + i * MAXNOME, MAXNOME, "%.*s", 6, sobrenome);   // "Silbaf"
+        snprintf(erros + i * MAXNOME, MAXNOME, "%s", nome);
+        char *e = erros + i * MAXNOME + 5 + (x >> 32) % 6;                 // troca uma letra
+        *e = *e == 'q' ? 'w' : 'q';
+    }
+    uint32_t cand[SUGESTOES_NOME], numCand, d;
+    volatile uint32_t soma = 0;
+    iniciarMedicao(&md);
+    for (size_t i = 0; i < consultas; ++i)
+        soma += (uint32_t) resolverNomeAcusado(&ix, &ht, exatos + i * MAXNOME, cand, SUGESTOES_NOME, &numCand);
+    terminarMedicao(&md, saida, "resolverNomeAcusado(sobrenome)", dist, consultas);
+    iniciarMedicao(&md);
+    for (size_t i = 0; i < consultas; ++i) soma += completarNome(&ix, prefixos + i * MAXNOME, cand, SUGESTOES_NOME);
+    terminarMedicao(&md, saida, "completarNome", dist, consultas);
+    iniciarMedicao(&md);
+    for (size_t i = 0; i < consultas; ++i)
+        soma += buscarNomeAproximado(&ix, erros + i * MAXNOME, 2, cand, SUGESTOES_NOME, &d);
+    terminarMedicao(&md, saida, "buscarNomeAproximado", dist, consultas);
+    (void) soma;
+
+    memLiberar(exatos);
+    memLiberar(prefixos);
+    memLiberar(erros);
+    liberarIndiceNomes(&ix);
+    liberarHash(&ht);
+    liberarInternos(&textos);
+}
+
+// benchmarkCarga() – 'n' associacoes em ordem embaralhada (com pares repetidos): hash montada uma a
+// uma e em lote, consultas nela e na hash perfeita equivalente, e arvore de pistas montada uma a uma e de uma vez (1 e todos os nucleos); por
+// fim as pistas distintas com cada estrategia de alocacao dos nos (bytes_por_op = bytes por no)
+static void benchmarkCarga(FILE *saida, size_t n) {
+    InternPool textos;
+    inicializarInternos(&textos);
+    char nome[MAXNOME], chave[MAXNOME];
+    uint32_t suspeitos[BENCH_SUSPEITOS * 2];
+    for (uint32_t s = 0; s < BENCH_SUSPEITOS; ++s) {
+        snprintf(nome, sizeof nome, "Suspeito %u", s);
+        strToLower(nome, chave);
+        suspeitos[2 * s] = internar(&textos, nome, MAXNOME);
+        suspeitos[2 * s + 1] = internar(&textos, chave, MAXNOME);
+    }
+    // cerca de n/2 pistas distintas, cada uma com dois suspeitos em media
+    size_t numPistas = n / 2 > 0 ? n / 2 : 1;
+    uint32_t *pistas = (uint32_t*) memAlocar(MEM_NOMES, numPistas * sizeof(uint32_t));
+    Associacao *a = (Associacao*) memZerada(MEM_NOMES, n, sizeof(Associacao));
+    uint32_t *ids = (uint32_t*) memAlocar(MEM_NOMES, n * sizeof(uint32_t));
+    if (pistas == NULL || a == NULL || ids == NULL) { printf("Erro: memoria insuficiente (benchmark).\n"); exit(1); }
+    for (size_t i = 0; i < numPistas; ++i) {
+        snprintf(nome, sizeof nome, "pista_%zu", i);
+        pistas[i] = internar(&textos, nome, MAXPISTA);
+    }
+    uint64_t x = 0x2545F4914F6CDD1Dull;
+    for (size_t i = 0; i < n; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17; // xorshift64
+        uint32_t s = (uint32_t) ((x >> 32) % BENCH_SUSPEITOS);
+        a[i].pista = ids[i] = pistas[x % numPistas];
+        a[i].suspeito = suspeitos[2 * s];
+        a[i].chave = suspeitos[2 * s + 1];
+        a[i].peso = 1 + (uint32_t) ((x >> 20) & 3);
+    }
+
+    MedicaoBench md = { .fdCache = -1 };
+    const char *dist = "embaralhada";
+    HashTable ht;
+    inicializarHash(&ht, &textos);
+    iniciarMedicao(&md);
+    for (size_t i = 0; i < n; ++i) inserirNaHashId(&ht, a[i].pista, a[i].suspeito, a[i].chave, a[i].peso);
+    terminarMedicao(&md, saida, "inserirNaHashId", dist, n);
+    liberarHash(&ht);
+
+    inicializarHash(&ht, &textos);
+    iniciarMedicao(&md);
+    carregarHashEmLote(&ht, a, n);
+    terminarMedicao(&md, saida, "carregarHashEmLote", dist, n);
+
+    // consultas na hash comum e na mesma hash sem colisoes (pistas das associacoes, embaralhadas)
+    volatile uint32_t achados = 0;
+    iniciarMedicao(&md);
+    for (size_t i = 0; i < n; ++i) achados += encontrarEntrada(&ht, ids[i])->suspeitos.quantidade;
+    terminarMedicao(&md, saida, "encontrarEntrada", dist, n);
+    HashPerfeita hp;
+    iniciarMedicao(&md);
+    construirHashPerfeita(&ht, &hp);
+    terminarMedicao(&md, saida, "construirHashPerfeita", dist, ht.quantidade);
+    HashTable perfeita;
+    abrirHashPerfeita(&perfeita, &hp, &textos);
+    iniciarMedicao(&md);
+    for (size_t i = 0; i < n; ++i) achados += encontrarEntrada(&perfeita, ids[i])->suspeitos.quantidade;
+    terminarMedicao(&md, saida, "encontrarEntrada(perfeita)", dist, n);
+    liberarHash(&perfeita);
+    liberarHashPerfeita(&hp);
+    liberarHash(&ht);
+
+    ArvorePistas arv;
+    inicializarPistas(&arv, &textos);
+    iniciarMedicao(&md);
+    for (size_t i = 0; i < n; ++i) inserirPistaId(&arv, ids[i]);
+    terminarMedicao(&md, saida, "inserirPistaId", dist, n);
+    int nucleos = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (nucleos < 1) nucleos = 1;
+    char rotulo[64];
+    for (int t = 1; t <= nucleos; t = t < nucleos ? nucleos : nucleos + 1) {
+        snprintf(rotulo, sizeof rotulo, "construirPistas(threads=%d)", t);
+        iniciarMedicao(&md);
+        construirPistas(&arv, ids, n, t);
+        terminarMedicao(&md, saida, rotulo, dist, n);
+    }
+    liberarPistas(&arv);
+
+    for (size_t i = numPistas - 1; i > 0; --i) { // embaralha as pistas distintas
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        size_t j = x % (i + 1);
+        uint32_t t = pistas[i]; pistas[i] = pistas[j]; pistas[j] = t;
+    }
+    for (int modo = 0; modo < NUM_MODOS_ALOCADOR; ++modo) {
+        inicializarPistas(&arv, &textos);
+        inicializarAlocadorObjetos(&arv.nos, (ModoAlocador) modo, sizeof(PistaNode), MEM_PISTAS);
+        snprintf(rotulo, sizeof rotulo, "inserirPistaId(alocador=%s)", nomesModosAlocador[modo]);
+        iniciarMedicao(&md);
+        for (size_t i = 0; i < numPistas; ++i) inserirPistaId(&arv, pistas[i]);
+        terminarMedicao(&md, saida, rotulo, dist, numPistas);
+        size_t total = arv.total;
+        snprintf(rotulo, sizeof rotulo, "liberarPistas(alocador=%s)", nomesModosAlocador[modo]);
+        iniciarMedicao(&md);
+        liberarPistas(&arv);
+        terminarMedicao(&md, saida, rotulo, dist, total);
+    }
+
+    memLiberar(ids);
+    memLiberar(a);
+    memLiberar(pistas);
+    liberarInternos(&textos);
+}
+
+// =========================
+// BENCHMARK DO DIARIO DE SESSOES
+// =========================
+
+// benchmarkDiario() – 'n' sessoes andando ao acaso; a cada rodada todas sao registradas
+// e gravadas com uma escrita. Mede registro por sessao, gravacao por rodada, compactacao
+// e restauracao (JSON, uma linha por medicao, no formato da --suite)
+static void benchmarkDiario(FILE *saida, const Mansao *m, const HashTable *ht, size_t n) {
+    char caminho[] = "/tmp/dq-diario-XXXXXX";
+    int fdTmp = mkstemp(caminho);
+    if (fdTmp < 0) { printf("Erro: nao foi possivel criar o diario temporario.\n"); exit(1); }
+    close(fdTmp);
+    unlink(caminho);
+
+    const int rodadas = 16;
+    Sessao *sessoes = (Sessao*) memAlocar(MEM_DIARIO, n * sizeof(Sessao));
+    if (sessoes == NULL) { printf("Erro: memoria insuficiente (benchmark).\n"); exit(1); }
+    for (size_t i = 0; i < n; ++i) {
+        iniciarSessao(&sessoes[i], m, ht, limiarDoCaso(m, 0));
+        coletarPistaSala(&sessoes[i], m, ht);
+    }
+    DiarioSessoes d;
+    size_t restauradas;
+    if (!abrirDiario(&d, caminho, m, ht, sessoes, 0, &restauradas)) exit(1);
+
+    MedicaoBench md = { .fdCache = -1 }, mdGravar = { .fdCache = -1 };
+    double nsRegistro = 0, nsGravacao = 0;
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    for (int r = 0; r < rodadas; ++r) {
+        for (size_t i = 0; i < n; ++i) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17; // xorshift64
+            if (moverSessao(&sessoes[i], m, (x & 1) ? 'd' : 'e') == MOV_OK)
+                coletarPistaSala(&sessoes[i], m, ht);
+        }
+        double t0 = agoraNs();
+        for (size_t i = 0; i < n; ++i) registrarSessao(&d, (uint32_t) i, &sessoes[i]);
+        double t1 = agoraNs();
+        gravarDiario(&d);
+        nsRegistro += t1 - t0;
+        nsGravacao += agoraNs() - t1;
+    }
+    // as duas primeiras linhas reaproveitam o formato de terminarMedicao com os tempos acumulados
+    iniciarMedicao(&md);
+    md.inicio = agoraNs() - nsRegistro;
+    terminarMedicao(&md, saida, "registrarSessao", "sessoes", n * rodadas);
+    iniciarMedicao(&mdGravar);
+    mdGravar.inicio = agoraNs() - nsGravacao;
+    terminarMedicao(&mdGravar, saida, "gravarDiario", "sessoes", rodadas);
+
+    iniciarMedicao(&md);
+    compactarDiario(&d, sessoes, n);
+    terminarMedicao(&md, saida, "compactarDiario", "sessoes", n);
+    fecharDiario(&d);
+
+    for (size_t i = 0; i < n; ++i) reiniciarSessao(&sessoes[i], m);
+    iniciarMedicao(&md);
+    abrirDiario(&d, caminho, m, ht, sessoes, n, &restauradas);
+    terminarMedicao(&md, saida, "restaurarDiario", "sessoes", restauradas);
+    fecharDiario(&d);
+
+    unlink(caminho);
+    for (size_t i = 0; i < n; ++i) liberarSessao(&sessoes[i]);
+    memLiberar(sessoes);
+}
+
+// =========================
+// BENCHMARK DAS CONSULTAS DE CAMINHO E ALCANCE
+// =========================
+
+// benchmarkConsultas() – 'n' consultas de cada tipo entre salas sorteadas (semente fixa):
+// preparo dos resumos, alcance, contagem de pistas, dica e caminho bidirecional
+// (JSON, uma linha por medicao, no formato da --suite)
+static void benchmarkConsultas(FILE *saida, const Mansao *m, const HashTable *ht, size_t n) {
+    ConsultasMansao cq;
+    MedicaoBench md = { .fdCache = abrirContadorCache() };
+    const char *dist = "salas";
+    iniciarMedicao(&md);
+    prepararConsultas(&cq, m, ht);
+    terminarMedicao(&md, saida, cq.floresta ? "prepararConsultas(floresta)" :
+                    cq.pistasComp != NULL ? "prepararConsultas(grafo+resumo)" : "prepararConsultas(grafo)", dist, m->numSalas);
+
+    int32_t *salas = (int32_t*) alocarConsulta(2 * n, sizeof(int32_t));
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    for (size_t i = 0; i < 2 * n; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17; // xorshift64
+        salas[i] = (int32_t) (x % m->numSalas);
+    }
+    volatile uint64_t soma = 0; // impede que o compilador descarte as consultas
+    iniciarMedicao(&md);
+    for (size_t i = 0; i < n; ++i) soma += (uint64_t) alcanca(&cq, salas[2 * i], salas[2 * i + 1]);
+    terminarMedicao(&md, saida, "alcanca", dist, n);
+    iniciarMedicao(&md);
+    for (size_t i = 0; i < n; ++i)
+        soma += contarPistasAlcancaveis(&cq, salas[i], ht->numSuspeitos ? (uint32_t) (i % ht->numSuspeitos) : UINT32_MAX);
+    terminarMedicao(&md, saida, "contarPistasAlcancaveis", dist, n);
+
+    // dica a partir de uma sessao recem-iniciada em cada sala sorteada
+    Sessao se;
+    iniciarSessao(&se, m, ht, limiarDoCaso(m, 0));
+    char rota[64];
+    int32_t destino;
+    iniciarMedicao(&md);
+    for (size_t i = 0; i < n; ++i) {
+        se.salaAtual = salas[i];
+        soma += (uint64_t) rotaPistaMaisProxima(&cq, &se, UINT32_MAX, rota, sizeof rota, &destino);
+    }
+    terminarMedicao(&md, saida, "rotaPistaMaisProxima", dist, n);
+    liberarSessao(&se);
+
+    iniciarMedicao(&md);
+    for (size_t i = 0; i < n; ++i) soma += (uint64_t) caminhoMaisCurto(&cq, salas[2 * i], salas[2 * i + 1], rota, sizeof rota);
+    terminarMedicao(&md, saida, "caminhoMaisCurto", dist, n);
+    (void) soma;
+
+    if (md.fdCache >= 0) close(md.fdCache);
+    memLiberar(salas);
+    liberarConsultas(&cq);
+}
+
+// =========================
+// BENCHMARK DO MOTOR PARALELO DE SESSOES
+// =========================
+
+// benchmarkSessoes() – mede sessoes por segundo com 1, 2, 4, ... ate 'maxThreads' trabalhadores
+// os roteiros sao passeios aleatorios (semente fixa) ate uma folha, acusando um suspeito qualquer
+static void benchmarkSessoes(const Mansao *m, HashTable *ht, size_t n, int maxThreads) {
+    uint32_t profMax = 0;
+    for (int32_t s = m->raiz; salaValida(m, s) && profMax < 4096; s = saidaSala(m, s, 0)) profMax++;
+    uint32_t tamRoteiro = profMax + 8;
+    char *buf = (char*) memAlocar(MEM_MOTOR, n * (tamRoteiro + 1));
+    Roteiro *roteiros = (Roteiro*) memAlocar(MEM_MOTOR, n * sizeof(Roteiro));
+    ResultadoSessao *res = (ResultadoSessao*) memAlocar(MEM_MOTOR, n * sizeof(ResultadoSessao));
+    if (buf == NULL || roteiros == NULL || res == NULL) { printf("Erro: memoria insuficiente (benchmark).\n"); exit(1); }
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    for (size_t i = 0; i < n; ++i) {
+        char *mov = buf + i * (tamRoteiro + 1);
+        for (uint32_t k = 0; k < tamRoteiro; ++k) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17; // xorshift64
+            mov[k] = (x & 1) ? 'd' : 'e';
+        }
+        mov[tamRoteiro] = '\0';
+        roteiros[i].movimentos = mov;
+        roteiros[i].n = tamRoteiro;
+        roteiros[i].acusado = ht->numSuspeitos ? textoInterno(ht->textos, ht->nomeSuspeito[i % ht->numSuspeitos]) : "";
+    }
+    prepararInternos(ht->textos); // fora da medicao
+    double base = 0;
+    for (int t = 1; ; t = (t * 2 > maxThreads && t < maxThreads) ? maxThreads : t * 2) {
+        double inicio = agoraNs();
+        executarSessoesParalelo(m, ht, limiarDoCaso(m, 0), roteiros, n, t, res);
+        double seg = (agoraNs() - inicio) / 1e9;
+        double taxa = (double) n / seg;
+        if (t == 1) base = taxa;
+        printf("threads=%-3d sessoes=%zu movimentos/sessao=%u tempo_ms=%.1f sessoes/s=%.0f aceleracao=%.2f\n",
+               t, n, tamRoteiro, seg * 1e3, taxa, taxa / base);
+        if (t >= maxThreads) break;
+    }
+    memLiberar(buf);
+    memLiberar(roteiros);
+    memLiberar(res);
+}
+
+// =========================
+// FUNCAO PRINCIPAL (main)
+// =========================
+
+
+int main(int argc, char *argv[]) {
+    // opcoes:
+    //   --suite <n>            suite de micro-benchmarks com n elementos (padrao, com n = 100000)
+    //   --buscas               so as buscas na hash com 1K, 100K e 1M entradas (tambem rodam no padrao)
+    //   --sessoes <n>          mede sessoes/s com 1 ate --threads (padrao: nucleos) trabalhadores
+    //   --diario <n>           mede o diario de sessoes com n sessoes
+    //   --consultas <n>        mede n consultas de alcance, dica e caminho no mapa
+    //   --threads <n>          trabalhadores maximos de --sessoes
+    //   --gerado <especif.>    gera a mansao em memoria em vez de carregar um mapa (ver --gerar)
+    //   --semente, --alocador e --memoria valem como no jogo
+    //   [mapa]                 mapa texto ou binario de --sessoes, --diario e --consultas
+    // toda medicao e uma linha JSON na saida padrao (formato BENCH_FORMATO)
+    inicializarSementeHash();
+    size_t suite = 0, sessoes = 0, diario = 0, consultas = 0;
+    int numThreads = 0, buscas = 0;
+    const char *caminhoMapa = NULL, *gerado = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--suite") == 0 && i + 1 < argc) suite = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--buscas") == 0) buscas = 1;
+        else if (strcmp(argv[i], "--sessoes") == 0 && i + 1 < argc) sessoes = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--diario") == 0 && i + 1 < argc) diario = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--consultas") == 0 && i + 1 < argc) consultas = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) numThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--gerado") == 0 && i + 1 < argc) gerado = argv[++i];
+        else if (opcaoGlobal(argv[i]) && i + 1 < argc) { aplicarOpcaoGlobal(argv[i], argv[i + 1]); i++; }
+        else if (strncmp(argv[i], "--", 2) == 0) {
+            printf("Opcao desconhecida ou incompleta: %s\n", argv[i]);
+            return 1;
+        } else caminhoMapa = argv[i];
+    }
+
+    if (sessoes == 0 && diario == 0 && consultas == 0) {
+        size_t n = suite > 0 ? suite : 100000;
+        if (!buscas || suite > 0) {
+            executarBenchmarks(stdout, n);
+            benchmarkPontuacao(stdout, n);
+            benchmarkNomes(stdout, n);
+            benchmarkCarga(stdout, n);
+        }
+        if (buscas || suite == 0) {
+            benchmarkBuscas(stdout, 1000);
+            benchmarkBuscas(stdout, 100000);
+            benchmarkBuscas(stdout, 1000000);
+        }
+        return 0;
+    }
+
+    // os benchmarks de sessoes, diario e consultas rodam sobre um mapa
+    Mansao mansao;
+    HashTable ht;
+    if (gerado != NULL) {
+        ParamGeracao g;
+        if (!lerParamGeracao(gerado, &g)) return 1;
+        gerarMansao(&g, &mansao);
+    } else if (caminhoMapa != NULL) {
+        if (!carregarMansao(caminhoMapa, &mansao)) return 1;
+    } else {
+        montarMansaoPadrao(&mansao);
+    }
+    inicializarHash(&ht, &mansao.textos);
+    popularHash(&ht, &mansao);
+
+    if (sessoes > 0) {
+        int maxThreads = numThreads > 0 ? numThreads : (int) sysconf(_SC_NPROCESSORS_ONLN);
+        benchmarkSessoes(&mansao, &ht, sessoes, maxThreads > 0 ? maxThreads : 1);
+    }
+    if (diario > 0) benchmarkDiario(stdout, &mansao, &ht, diario);
+    if (consultas > 0) benchmarkConsultas(stdout, &mansao, &ht, consultas);
+    liberarHash(&ht);
+    liberarMansao(&mansao);
+    return 0;
+}
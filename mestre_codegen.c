@@ -0,0 +1,119 @@
+// Mansao compilada em C (--gerar-c) e abertura da mansao fixa (-DMANSAO_FIXA)
+
+#include "NivelMestre4.h"
+
+// =========================
+// MANSAO COMPILADA EM C
+// =========================
+
+
+// escreve 'n' itens de 'campos' inteiros de 32 bits como o vetor C 'tipo nome[]'
+// (1 campo: um numero por item; 2 ou mais: um inicializador entre chaves)
+static void escreverVetorC(FILE *f, const char *tipo, const char *nome, const uint32_t *v, size_t n, int campos) {
+    int porLinha = campos == 1 ? 8 : 4;
+    fprintf(f, "static const %s %s[%zu] = {", tipo, nome, n ? n : 1);
+    if (n == 0) fprintf(f, campos == 1 ? " 0" : " { 0 }");
+    for (size_t i = 0; i < n; ++i) {
+        fprintf(f, i % (size_t) porLinha == 0 ? "\n    " : " ");
+        const uint32_t *x = v + i * (size_t) campos;
+        if (campos == 1) fprintf(f, "%u,", x[0]);
+        else if (campos == 2) fprintf(f, "{%u, %u},", x[0], x[1]);
+        else fprintf(f, "{%u, {%u, %u}},", x[0], x[1], x[2]); // HashEntrada
+    }
+    fprintf(f, "\n};\n\n");
+}
+
+// escreverMansaoC() – grava a imagem binaria da mansao e a hash perfeita como tabelas C constantes
+// e o descritor 'mansaoFixa' que as reune
+static void escreverMansaoC(FILE *f, const char *origem, const Mansao *m, const HashPerfeita *hp) {
+    const unsigned char *img = m->imagem != NULL ? m->imagem : (const unsigned char*) m->mapeada;
+    fprintf(f, "// Mansao compilada de '%s' por NivelMestre4 --gerar-c; gere de novo quando o mapa mudar.\n", origem);
+    fprintf(f, "// Uso: make MANSAO_FIXA=<este arquivo>\n");
+    fprintf(f, "// Os inteiros estao na ordem de bytes da maquina que gerou o arquivo\n\n");
+    fprintf(f, "static const unsigned char mansaoFixaImagem[%zu] __attribute__((aligned(16))) = {", m->tamImagem);
+    for (size_t i = 0; i < m->tamImagem; ++i)
+        fprintf(f, "%s0x%02x,", i % 16 == 0 ? "\n    " : " ", img[i]);
+    fprintf(f, "\n};\n\n");
+
+    // os structs da hash sao vetores de uint32_t (sem preenchimento), escritos campo a campo
+    escreverVetorC(f, "HashEntrada", "mansaoFixaEntradas", (const uint32_t*) hp->entradas, hp->capacidade, 3);
+    escreverVetorC(f, "uint32_t", "mansaoFixaDeslocPistas", hp->deslocPistas, hp->numBaldesPistas, 1);
+    escreverVetorC(f, "IndiceSuspeito", "mansaoFixaIndiceSuspeitos", (const uint32_t*) hp->indiceSuspeitos,
+                   hp->capIndiceSuspeitos, 2);
+    escreverVetorC(f, "uint32_t", "mansaoFixaDeslocSuspeitos", hp->deslocSuspeitos, hp->numBaldesSuspeitos, 1);
+    escreverVetorC(f, "uint32_t", "mansaoFixaChaveSuspeito", hp->chaveSuspeito, hp->numSuspeitos, 1);
+    escreverVetorC(f, "uint32_t", "mansaoFixaNomeSuspeito", hp->nomeSuspeito, hp->numSuspeitos, 1);
+    escreverVetorC(f, "ListaPostagens", "mansaoFixaPistasSuspeito", (const uint32_t*) hp->pistasSuspeito,
+                   hp->numSuspeitos, 2);
+    escreverVetorC(f, "Postagem", "mansaoFixaPostagensPistas", (const uint32_t*) hp->postagensPistas,
+                   hp->numPostagensPistas, 2);
+    escreverVetorC(f, "Postagem", "mansaoFixaPostagensSuspeitos", (const uint32_t*) hp->postagensSuspeitos,
+                   hp->numPostagensSuspeitos, 2);
+    if (hp->mascaras != NULL) {
+        fprintf(f, "static const uint64_t mansaoFixaMascaras[%u] = {", hp->capacidade);
+        for (uint32_t i = 0; i < hp->capacidade; ++i)
+            fprintf(f, "%s0x%llxull,", i % 4 == 0 ? "\n    " : " ", (unsigned long long) hp->mascaras[i]);
+        fprintf(f, "\n};\n\n");
+    }
+
+    fprintf(f, "static const MansaoFixa mansaoFixa = {\n");
+    fprintf(f, "    mansaoFixaImagem, sizeof mansaoFixaImagem,\n");
+    fprintf(f, "    {\n");
+    fprintf(f, "        mansaoFixaEntradas, %u, %u,\n", hp->capacidade, hp->quantidade);
+    fprintf(f, "        mansaoFixaDeslocPistas, %u,\n", hp->numBaldesPistas);
+    fprintf(f, "        mansaoFixaIndiceSuspeitos, %u,\n", hp->capIndiceSuspeitos);
+    fprintf(f, "        mansaoFixaDeslocSuspeitos, %u,\n", hp->numBaldesSuspeitos);
+    fprintf(f, "        mansaoFixaChaveSuspeito,\n");
+    fprintf(f, "        mansaoFixaNomeSuspeito,\n");
+    fprintf(f, "        mansaoFixaPistasSuspeito, %u,\n", hp->numSuspeitos);
+    fprintf(f, "        mansaoFixaPostagensPistas, %u,\n", hp->numPostagensPistas);
+    fprintf(f, "        mansaoFixaPostagensSuspeitos, %u,\n", hp->numPostagensSuspeitos);
+    fprintf(f, "        %s,\n", hp->mascaras != NULL ? "mansaoFixaMascaras" : "NULL");
+    fprintf(f, "        %u,\n", hp->numAssociacoes);
+    fprintf(f, "        0x%xu\n", hp->semente);
+    fprintf(f, "    }\n};\n");
+}
+
+// gerarMansaoC() – compila um mapa (texto ou binario) em tabelas C constantes ('-' = saida
+// padrao): a imagem da mansao e a hash pista -> suspeitos ja montada, sem colisoes. Um binario
+// compilado com make MANSAO_FIXA=arquivo usa essas tabelas no lugar da mansao padrao
+int gerarMansaoC(const char *entrada, const char *saida) {
+    Mansao m;
+    if (!carregarMansao(entrada, &m)) return 0;
+    HashTable ht;
+    inicializarHash(&ht, &m.textos);
+    popularHash(&ht, &m);
+    HashPerfeita hp;
+    construirHashPerfeita(&ht, &hp);
+
+    int padrao = strcmp(saida, "-") == 0;
+    char tmp[4096];
+    snprintf(tmp, sizeof tmp, "%s.tmp", saida);
+    FILE *f = padrao ? stdout : fopen(tmp, "w");
+    int ok = f != NULL;
+    if (ok) {
+        escreverMansaoC(f, entrada, &m, &hp);
+        if (ferror(f) || fflush(f) != 0) ok = 0;
+        if (!padrao && fclose(f) != 0) ok = 0;
+        if (ok && !padrao && rename(tmp, saida) != 0) ok = 0;
+    }
+    if (!ok) {
+        fprintf(stderr, "Erro: falha ao gravar '%s'.\n", saida);
+        if (!padrao) remove(tmp);
+    }
+    liberarHashPerfeita(&hp);
+    liberarHash(&ht);
+    liberarMansao(&m);
+    return ok;
+}
+
+// abrirMansaoFixa() – abre a mansao e a hash sobre as tabelas constantes de uma mansao compilada:
+// nada e alocado nem copiado
+void abrirMansaoFixa(const MansaoFixa *fixa, Mansao *m, HashTable *ht) {
+    memset(m, 0, sizeof *m);
+    if (!abrirImagem(m, fixa->imagem, fixa->tamImagem)) {
+        printf("Erro: mansao compilada invalida (gere de novo com --gerar-c).\n");
+        exit(1);
+    }
+    abrirHashPerfeita(ht, &fixa->hash, &m->textos);
+}
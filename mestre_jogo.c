@@ -0,0 +1,750 @@
+// Jogo do Detetive Quest (nivel mestre): exploracao interativa, replay, motor paralelo de sessoes,
+// solucionador de caminhos e julgamento
+
+#include "NivelMestre4.h"
+
+// =========================
+// EXPLORACAO DA MANSAO
+// =========================
+
+
+// textos de abertura e encerramento do jogo (terminal e servidor)
+const char TEXTO_ABERTURA[] =
+    "=== DETECTIVE QUEST: JULGAMENTO FINAL (COLETA, ASSOCIACAO E ACUSACAO) ===\n"
+    "Instrucoes: em cada sala escolha 'e' para esquerda, 'd' para direita (ou o numero da porta),\n"
+    "'v' para voltar a sala anterior ou 's' para sair.\n";
+const char TEXTO_DESPEDIDA[] = "\nFim do jogo. Obrigado por jogar, detetive!\n";
+
+// escreverTelaSala() – monta em 'b' a tela da sala atual: pista (e suspeitos que ela implica),
+// dica de alcance e menu de saidas, terminando no prompt. So escreve no buffer
+void escreverTelaSala(BufferSaida *b, const Mansao *m, const Sessao *se, const HashTable *ht,
+                      ConsultasMansao *cq) {
+    const Sala *s = &m->salas[se->salaAtual];
+    bufFormatar(b, "\nVocê esta na sala: %s\n", nomeSala(m, se->salaAtual));
+    if (s->pista != TEXTO_VAZIO) {
+        bufFormatar(b, "Voce encontrou uma pista: \"%s\"\n", pistaSala(m, se->salaAtual));
+        // opcional: mostrar suspeito(s) ligado(s) a esta pista
+        const HashEntrada *e = encontrarEntrada(ht, s->pista);
+        if (e != NULL && e->suspeitos.quantidade == 1 && suspeitosDaPista(ht, e)[0].peso == 1) {
+            bufFormatar(b, "  (essa pista esta ligada ao suspeito: %s)\n",
+                        textoInterno(ht->textos, ht->nomeSuspeito[suspeitosDaPista(ht, e)[0].id]));
+        } else if (e != NULL) {
+            bufTexto(b, "  (essa pista implica: ");
+            bufSuspeitos(b, ht, e);
+            bufTexto(b, ")\n");
+        } else {
+            bufTexto(b, "  (nenhum suspeito associado a esta pista no momento)\n");
+        }
+    } else {
+        bufTexto(b, "Nao ha pista nesta sala.\n");
+    }
+    // dica a cada movimento so com resumo de alcance (floresta: busca binaria; grafo: contagem de
+    // bits da componente). Sem ele seria uma busca em largura por tela, e o servidor desenha as
+    // telas de todas as conexoes na mesma thread
+    if (resumoAlcance(cq))
+        bufFormatar(b, "(salas com pista ao seu alcance daqui: %u)\n", contarPistasAlcancaveis(cq, salaMaisAntiga(se), UINT32_MAX));
+
+    // opcoes
+    // ate duas saidas: esquerda/direita; mais que isso: portas numeradas
+    bufTexto(b, "\nEscolha seu proximo caminho:\n");
+    uint32_t numSaidas = numSaidasSala(m, se->salaAtual);
+    for (uint32_t k = 0; k < numSaidas; ++k) {
+        int32_t destino = saidaSala(m, se->salaAtual, k);
+        if (!salaValida(m, destino)) continue;
+        if (numSaidas <= 2) bufFormatar(b, "  (%c) %s -> %s\n", k == 0 ? 'e' : 'd', k == 0 ? "Esquerda" : "Direita ",
+                                        nomeSala(m, destino));
+        else bufFormatar(b, "  (%u) Porta %u -> %s\n", k + 1, k + 1, nomeSala(m, destino));
+    }
+    if (se->profTrilha > 0)
+        bufFormatar(b, "  (v) Voltar   -> %s\n", nomeSala(m, salaAnterior(se)));
+    bufTexto(b, "  (p) Listar pistas coletadas (opcional: p <prefixo>)\n"
+                "  (h) Dica: caminho ate a pista nova mais proxima (opcional: h <suspeito>)\n"
+                "  (s) Sair e ir ao julgamento\n"
+                "Opcao: ");
+}
+
+// processarComando() – trata uma linha digitada na sala e escreve a resposta em 'b'
+// a linha e a opcao (primeiro caractere nao branco) seguida do resto, usado como prefixo por 'p',
+// nome do suspeito por 'h' e numero da porta pelos digitos
+ResultadoComando processarComando(BufferSaida *b, const Mansao *m, Sessao *se, const HashTable *ht,
+                                  ConsultasMansao *cq, const char *linha) {
+    while (isspace((unsigned char) *linha)) linha++;
+    if (*linha == '\0') return COMANDO_VAZIO;
+    char escolha = *linha++;
+    // resto da linha (no maximo MAXPISTA - 1 caracteres)
+    char resto[MAXPISTA];
+    snprintf(resto, sizeof resto, "%s", linha);
+
+    if (escolha == 'p' || escolha == 'P') {
+        char *prefixo = resto + strspn(resto, " \t");
+        prefixo[strcspn(prefixo, "\r\n")] = '\0';
+        bufFormatar(b, "\nPistas coletadas%s%s:\n", prefixo[0] ? " com prefixo " : "", prefixo);
+        size_t n = relatorioPistas(&se->pistas, ht, b, RELATORIO_TEXTO, NULL, NULL,
+                                   prefixo[0] ? prefixo : NULL);
+        bufFormatar(b, "(%zu de %zu)\n", n, se->pistas.total);
+        return COMANDO_FEITO;
+    }
+
+    if (escolha == 'h' || escolha == 'H') {
+        char *nome = resto + strspn(resto, " \t");
+        nome[strcspn(nome, "\r\n")] = '\0';
+        uint32_t idx = UINT32_MAX;
+        if (nome[0] != '\0' && (idx = suspeitoPorNome(ht, nome)) == UINT32_MAX) {
+            bufFormatar(b, "Suspeito desconhecido: %s\n", nome);
+            return COMANDO_FEITO;
+        }
+        char rota[64];
+        int32_t destino;
+        int32_t movs = rotaPistaMaisProxima(cq, se, idx, rota, sizeof rota, &destino);
+        if (movs < 0) {
+            bufFormatar(b, "Nenhuma pista nova%s%s ao seu alcance.\n", idx != UINT32_MAX ? " contra " : "", nome);
+        } else {
+            bufFormatar(b, "Pista nova mais proxima: %s, a %d movimento(s)", nomeSala(m, destino), movs);
+            if ((size_t) movs < sizeof rota && strchr(rota, '?') == NULL) bufFormatar(b, " (roteiro: %s)", rota);
+            bufTexto(b, "\n");
+        }
+        if (idx != UINT32_MAX)
+            bufFormatar(b, "Salas com pista contra %s ao seu alcance: %u\n", nome, contarPistasAlcancaveis(cq, salaMaisAntiga(se), idx));
+        return COMANDO_FEITO;
+    }
+
+    // movimento + coleta da pista da nova sala
+    INSTR_INICIO(t0);
+    ResultadoMovimento r;
+    if (escolha >= '1' && escolha <= '9') {
+        // porta pelo numero (pode ter mais de um digito)
+        unsigned long k = (unsigned long) (escolha - '0');
+        for (const char *q = resto; *q >= '0' && *q <= '9' && k < UINT32_MAX; ++q) k = k * 10 + (unsigned long) (*q - '0');
+        r = moverParaSaida(se, m, (uint32_t) (k - 1));
+    } else {
+        r = moverSessao(se, m, escolha);
+    }
+    if (r == MOV_OK) coletarPistaSala(se, m, ht);
+    INSTR_FIM(MED_MOVIMENTO, t0);
+    if (r == MOV_SAIR) {
+        bufTexto(b, "\nExploracao encerrada. Seguindo para o julgamento...\n");
+        return COMANDO_SAIR;
+    } else if (r == MOV_INVALIDO) {
+        bufTexto(b, "Opcao invalida ou caminho inexistente. Tente novamente.\n");
+    }
+    return COMANDO_FEITO;
+}
+
+// grava o checkpoint da sessao no diario (so o que mudou) e compacta quando ha registros demais
+static void salvarProgresso(DiarioSessoes *diario, Sessao *se) {
+    registrarSessao(diario, 0, se);
+    if (!gravarDiario(diario)) fprintf(stderr, "Aviso: falha ao gravar o progresso em '%s'.\n", diario->caminho);
+    if (diario->registros >= DIARIO_COMPACTAR) compactarDiario(diario, se, 1);
+}
+
+// explorarSalas() – navega pela mansao e ativa o sistema de pistas
+// entrada: mansao (salas indexadas), se (sessao com sala atual, pistas e evidencias),
+// ht (tabela hash com relacao pista->suspeito), diario (checkpoint na sala inicial e a cada comando
+// feito; NULL = nenhum),
+// cq (consultas de alcance para as dicas), entrada (leitor das opcoes do jogador)
+// cada turno monta a tela inteira num buffer e a escreve com uma unica chamada ao sistema
+void explorarSalas(const Mansao *m, Sessao *se, HashTable *ht, DiarioSessoes *diario, ConsultasMansao *cq,
+                   LeitorEntrada *entrada) {
+    char memoria[BUFFER_SAIDA];
+    BufferSaida b;
+    inicializarBufferSaida(&b, stdout, memoria, sizeof memoria);
+    if (salaValida(m, se->salaAtual)) coletarPistaSala(se, m, ht); // sala inicial
+    ResultadoComando r = COMANDO_FEITO;
+    while (salaValida(m, se->salaAtual)) {
+        if (r == COMANDO_FEITO) {
+            if (diario != NULL) salvarProgresso(diario, se);
+            escreverTelaSala(&b, m, se, ht, cq);
+            descarregarBuffer(&b);
+            fflush(stdout);
+        }
+        char *linha;
+        size_t tam;
+        if (lerLinhaEntrada(entrada, &linha, &tam) != LINHA_OK) break; // fim da entrada
+        r = processarComando(&b, m, se, ht, cq, linha);
+        if (r == COMANDO_SAIR) break;
+    }
+    descarregarBuffer(&b);
+}
+
+// =========================
+// MODO REPLAY (SEM INTERFACE)
+// =========================
+
+
+// executarRoteiro() – reproduz uma sessao sem imprimir menus
+// 'movimentos' e uma sequencia de 'e'/'d'/'s' (outros caracteres contam como opcao invalida)
+// retorna os pontos de evidencia das pistas coletadas contra o acusado
+uint32_t executarRoteiro(Sessao *se, const Mansao *m, const HashTable *ht,
+                         const char *movimentos, size_t n, const char *acusado) {
+    INSTR_INICIO(t0);
+    reiniciarSessao(se, m);
+    coletarPistaSala(se, m, ht);
+    for (size_t i = 0; i < n; ++i) {
+        ResultadoMovimento r = moverSessao(se, m, movimentos[i]);
+        if (r == MOV_SAIR) break;
+        if (r == MOV_OK) coletarPistaSala(se, m, ht);
+    }
+    uint32_t cont = acusado[0] != '\0' ? evidenciasContra(&se->ev, ht, acusado) : 0;
+    INSTR_FIM(MED_SESSAO_REPLAY, t0);
+    return cont;
+}
+
+// reproduzirRoteiros() – le um roteiro por linha no formato "<movimentos> <nome do acusado>"
+// e escreve um registro por sessao, separado por tabulacoes:
+//   sessao  sala_final  movimentos  pistas  pontos  veredito(1 = culpado)  acusado
+// linhas vazias ou iniciadas por '#' sao ignoradas; retorna o numero de sessoes
+size_t reproduzirRoteiros(FILE *entrada, FILE *saida, const Mansao *m, HashTable *ht, uint32_t limiar) {
+    Sessao se;
+    iniciarSessao(&se, m, ht, limiar);
+    char *linha = NULL;
+    size_t cap = 0, sessoes = 0;
+    ssize_t lidos;
+    while ((lidos = getline(&linha, &cap, entrada)) != -1) {
+        while (lidos > 0 && (linha[lidos-1] == '\n' || linha[lidos-1] == '\r')) linha[--lidos] = '\0';
+        if (lidos == 0 || linha[0] == '#') continue;
+        size_t n = strcspn(linha, " \t");
+        const char *acusado = linha + n;
+        while (*acusado == ' ' || *acusado == '\t') acusado++;
+
+        uint32_t cont = executarRoteiro(&se, m, ht, linha, n, acusado);
+        fprintf(saida, "%zu\t%d\t%u\t%zu\t%u\t%d\t%s\n", ++sessoes, (int) se.salaAtual,
+                se.movimentos, se.pistas.total, cont, cont >= se.ev.limiar, acusado);
+    }
+    free(linha); // alocada pelo getline
+    liberarSessao(&se);
+    return sessoes;
+}
+
+// =========================
+// MOTOR PARALELO DE SESSOES
+// =========================
+
+
+// carregarRoteiros() – le todos os roteiros de 'entrada' para memoria
+// o texto fica em *buffer (quebrado em linhas no proprio lugar); retorna o numero de roteiros
+size_t carregarRoteiros(FILE *entrada, char **buffer, Roteiro **roteiros) {
+    size_t tam = 0, cap = 1 << 16, lidos;
+    char *buf = (char*) memAlocar(MEM_MOTOR, cap + 1);
+    if (buf == NULL) { printf("Erro: memoria insuficiente (roteiros).\n"); exit(1); }
+    while ((lidos = fread(buf + tam, 1, cap - tam, entrada)) > 0) {
+        tam += lidos;
+        if (tam == cap) {
+            cap *= 2;
+            buf = (char*) memRealocar(MEM_MOTOR, buf, cap + 1);
+            if (buf == NULL) { printf("Erro: memoria insuficiente (roteiros).\n"); exit(1); }
+        }
+    }
+    buf[tam] = '\0';
+
+    size_t n = 0, capR = 1024;
+    Roteiro *r = (Roteiro*) memAlocar(MEM_MOTOR, capR * sizeof(Roteiro));
+    if (r == NULL) { printf("Erro: memoria insuficiente (roteiros).\n"); exit(1); }
+    char *linha = buf;
+    while (linha < buf + tam) {
+        char *fim = strchr(linha, '\n');
+        if (fim == NULL) fim = buf + tam;
+        *fim = '\0';
+        if (fim > linha && fim[-1] == '\r') fim[-1] = '\0';
+        if (linha[0] != '\0' && linha[0] != '#') {
+            if (n == capR) {
+                capR *= 2;
+                r = (Roteiro*) memRealocar(MEM_MOTOR, r, capR * sizeof(Roteiro));
+                if (r == NULL) { printf("Erro: memoria insuficiente (roteiros).\n"); exit(1); }
+            }
+            size_t k = strcspn(linha, " \t");
+            const char *acusado = linha + k;
+            while (*acusado == ' ' || *acusado == '\t') acusado++;
+            r[n].movimentos = linha;
+            r[n].n = (uint32_t) k;
+            r[n].acusado = acusado;
+            n++;
+        }
+        linha = fim + 1;
+    }
+    *buffer = buf;
+    *roteiros = r;
+    return n;
+}
+
+// o dono retira um lote do inicio da propria faixa; retorna 0 se ela estiver vazia
+int pegarLote(FaixaTrabalho *f, uint32_t lote, uint32_t *ini, uint32_t *fim) {
+    uint64_t atual = atomic_load_explicit(&f->faixa, memory_order_acquire);
+    for (;;) {
+        uint32_t a = (uint32_t) (atual >> 32), b = (uint32_t) atual;
+        if (a >= b) return 0;
+        uint32_t c = (b - a > lote) ? a + lote : b;
+        if (atomic_compare_exchange_weak_explicit(&f->faixa, &atual, empacotarFaixa(c, b),
+                                                  memory_order_acq_rel, memory_order_acquire)) {
+            *ini = a;
+            *fim = c;
+            return 1;
+        }
+    }
+}
+
+// um ladrao retira a metade final da faixa da vitima; retorna 0 se nao houver o que roubar
+int roubarMetade(FaixaTrabalho *vitima, uint32_t *ini, uint32_t *fim) {
+    uint64_t atual = atomic_load_explicit(&vitima->faixa, memory_order_acquire);
+    for (;;) {
+        uint32_t a = (uint32_t) (atual >> 32), b = (uint32_t) atual;
+        if (a >= b) return 0;
+        uint32_t meio = a + (b - a) / 2;
+        if (atomic_compare_exchange_weak_explicit(&vitima->faixa, &atual, empacotarFaixa(a, meio),
+                                                  memory_order_acq_rel, memory_order_acquire)) {
+            *ini = meio;
+            *fim = b;
+            return 1;
+        }
+    }
+}
+
+// executa os roteiros [ini, fim) com a sessao do trabalhador
+static void executarFaixa(TrabalhadorSessoes *t, uint32_t ini, uint32_t fim) {
+    MotorSessoes *mt = t->motor;
+    for (uint32_t i = ini; i < fim; ++i) {
+        const Roteiro *r = &mt->roteiros[i];
+        ResultadoSessao *res = &mt->resultados[i];
+        res->evidencias = executarRoteiro(&t->sessao, mt->mansao, mt->ht, r->movimentos, r->n, r->acusado);
+        res->salaFinal = t->sessao.salaAtual;
+        res->movimentos = t->sessao.movimentos;
+        res->pistas = (uint32_t) t->sessao.pistas.total;
+    }
+}
+
+// laco de cada trabalhador: consome a propria faixa em lotes e, quando ela acaba,
+// rouba metade da faixa de outro trabalhador (a partir do vizinho seguinte)
+static void* trabalhadorSessoes(void *arg) {
+    TrabalhadorSessoes *t = (TrabalhadorSessoes*) arg;
+    MotorSessoes *mt = t->motor;
+    // a sessao (e a arena das pistas) pertence a esta thread
+    iniciarSessao(&t->sessao, mt->mansao, mt->ht, mt->limiar);
+    uint32_t ini, fim;
+    for (;;) {
+        while (pegarLote(&t->faixa, MOTOR_LOTE, &ini, &fim))
+            executarFaixa(t, ini, fim);
+        int roubou = 0;
+        for (int k = 1; k < mt->numTrabalhadores && !roubou; ++k) {
+            TrabalhadorSessoes *v = &mt->trabalhadores[(t->indice + k) % mt->numTrabalhadores];
+            if (roubarMetade(&v->faixa, &ini, &fim)) {
+                atomic_store_explicit(&t->faixa.faixa, empacotarFaixa(ini, fim), memory_order_release);
+                roubou = 1;
+            }
+        }
+        if (!roubou) break;
+    }
+    liberarSessao(&t->sessao);
+    return NULL;
+}
+
+// executarSessoesParalelo() – distribui 'n' roteiros entre 'numThreads' trabalhadores
+// a mansao e a hash sao compartilhadas apenas para leitura; 'resultados' recebe um item por roteiro
+void executarSessoesParalelo(const Mansao *m, HashTable *ht, uint32_t limiar, const Roteiro *roteiros, size_t n,
+                             int numThreads, ResultadoSessao *resultados) {
+    if (numThreads < 1) numThreads = 1;
+    if (n > UINT32_MAX) { printf("Erro: roteiros demais para o motor paralelo.\n"); exit(1); }
+    // a partir daqui ninguem escreve na tabela de textos: o indice precisa existir antes
+    prepararInternos(ht->textos);
+
+    MotorSessoes mt;
+    mt.mansao = m;
+    mt.ht = ht;
+    mt.limiar = limiar;
+    mt.roteiros = roteiros;
+    mt.resultados = resultados;
+    mt.numTrabalhadores = numThreads;
+    mt.trabalhadores = (TrabalhadorSessoes*) memZerada(MEM_MOTOR, (size_t) numThreads, sizeof(TrabalhadorSessoes));
+    pthread_t *threads = (pthread_t*) memAlocar(MEM_MOTOR, (size_t) numThreads * sizeof(pthread_t));
+    if (mt.trabalhadores == NULL || threads == NULL) { printf("Erro: memoria insuficiente (motor).\n"); exit(1); }
+
+    // faixas iniciais de tamanho igual; o roubo corrige desequilibrios
+    for (int i = 0; i < numThreads; ++i) {
+        TrabalhadorSessoes *t = &mt.trabalhadores[i];
+        t->motor = &mt;
+        t->indice = i;
+        atomic_init(&t->faixa.faixa, empacotarFaixa((uint32_t) (n * (size_t) i / (size_t) numThreads),
+                                              (uint32_t) (n * (size_t) (i + 1) / (size_t) numThreads)));
+    }
+    for (int i = 1; i < numThreads; ++i) {
+        if (pthread_create(&threads[i], NULL, trabalhadorSessoes, &mt.trabalhadores[i]) != 0) {
+            printf("Erro: nao foi possivel criar thread de sessoes.\n");
+            exit(1);
+        }
+    }
+    trabalhadorSessoes(&mt.trabalhadores[0]); // a thread chamadora tambem trabalha
+    for (int i = 1; i < numThreads; ++i) pthread_join(threads[i], NULL);
+    memLiberar(threads);
+    memLiberar(mt.trabalhadores);
+}
+
+// escreve os resultados no mesmo formato de reproduzirRoteiros
+void escreverResultados(FILE *saida, const Roteiro *roteiros, const ResultadoSessao *res, size_t n, uint32_t limiar) {
+    for (size_t i = 0; i < n; ++i)
+        fprintf(saida, "%zu\t%d\t%u\t%u\t%u\t%d\t%s\n", i + 1, (int) res[i].salaFinal, res[i].movimentos,
+                res[i].pistas, res[i].evidencias, res[i].evidencias >= limiar, roteiros[i].acusado);
+}
+
+// =========================
+// SOLUCIONADOR DE CAMINHOS
+// =========================
+
+
+// 'w' e filha de 'v' na arvore de caminhos minimos pela saida 'k'
+static inline int filhoNaArvore(const SolucaoCaminhos *sol, int32_t v, uint32_t k, int32_t w) {
+    return sol->pai[w] == v && sol->saidaPai[w] == k;
+}
+
+// resumirSubarvores() – busca em largura a partir da sala inicial (sem recursao): cada sala
+// alcancada recebe pai, saida do pai e profundidade da arvore de caminhos minimos; depois,
+// na ordem inversa da busca, o tamanho da subarvore e o numero de folhas
+// marca sol->arvore = 0 se alguma saida levar a uma sala ja descoberta (ciclo ou sala compartilhada)
+static void resumirSubarvores(const Mansao *m, SolucaoCaminhos *sol) {
+    int32_t *fila = (int32_t*) memAlocar(MEM_SOLUCAO, ((size_t) m->numSalas + 1) * sizeof(int32_t));
+    if (fila == NULL) { printf("Erro: memoria insuficiente (solucionador).\n"); exit(1); }
+    for (uint32_t i = 0; i < m->numSalas; ++i) sol->pai[i] = -1;
+    size_t ini = 0, fim = 0;
+    sol->profundidade[m->raiz] = 0;
+    sol->tamanho[m->raiz] = 1; // descoberta
+    fila[fim++] = m->raiz;
+    sol->arvore = 1;
+    while (ini < fim) {
+        int32_t v = fila[ini++];
+        uint32_t n = numSaidasSala(m, v);
+        for (uint32_t k = 0; k < n; ++k) {
+            int32_t w = saidaSala(m, v, k);
+            if (!salaValida(m, w)) continue;
+            if (sol->tamanho[w] != 0) { sol->arvore = 0; continue; }
+            sol->tamanho[w] = 1;
+            sol->pai[w] = v;
+            sol->saidaPai[w] = k;
+            sol->profundidade[w] = sol->profundidade[v] + 1;
+            fila[fim++] = w;
+        }
+    }
+    // filhos saem da fila depois do pai: na ordem inversa cada subarvore ja esta completa
+    for (size_t i = fim; i-- > 0; ) {
+        int32_t v = fila[i];
+        if (sol->folhas[v] == 0) sol->folhas[v] = 1; // nenhuma filha somou: e folha
+        int32_t p = sol->pai[v];
+        if (p < 0) continue;
+        sol->tamanho[p] += sol->tamanho[v];
+        sol->folhas[p] += sol->folhas[v];
+    }
+    memLiberar(fila);
+}
+
+// resolverCaminhos() – para cada suspeito, conta os caminhos que o condenam e acha o mais curto
+// um caminho termina em qualquer sala (o jogador pode sair a qualquer momento); os caminhos
+// raiz-folha sao contados a parte. Quando os pontos de um suspeito alcancam 'limiar' numa sala,
+// todos os caminhos que passam por ela tambem o condenam: soma-se o resumo da subarvore de uma vez,
+// sem descer por ela para esse suspeito. Custo O(salas + saidas + postagens + suspeitos).
+// Em mapas com ciclos ou salas compartilhadas os caminhos sao os da arvore de caminhos minimos
+// (cada sala alcancada pelo menor numero de movimentos); sol->arvore indica esse caso.
+// Os caminhos contados nao usam 'v'; voltando, o jogador alcanca qualquer conjunto de pistas das
+// salas alcancaveis, e pontosAlcancaveis soma todas elas para cada suspeito
+void resolverCaminhos(const Mansao *m, const HashTable *ht, uint32_t limiar, SolucaoCaminhos *sol) {
+    uint32_t n = m->numSalas, numSus = ht->numSuspeitos;
+    memset(sol, 0, sizeof *sol);
+    sol->numSuspeitos = numSus;
+    sol->limiar = limiar;
+    sol->pai = (int32_t*) memAlocar(MEM_SOLUCAO, n * sizeof(int32_t));
+    sol->saidaPai = (uint32_t*) memAlocar(MEM_SOLUCAO, n * sizeof(uint32_t));
+    sol->profundidade = (uint32_t*) memAlocar(MEM_SOLUCAO, n * sizeof(uint32_t));
+    sol->tamanho = (uint64_t*) memZerada(MEM_SOLUCAO, n, sizeof(uint64_t));
+    sol->folhas = (uint64_t*) memZerada(MEM_SOLUCAO, n, sizeof(uint64_t));
+    sol->suspeitos = (ResumoSuspeito*) memZerada(MEM_SOLUCAO, numSus ? numSus : 1, sizeof(ResumoSuspeito));
+    if (!sol->pai || !sol->saidaPai || !sol->profundidade || !sol->tamanho || !sol->folhas || !sol->suspeitos) {
+        printf("Erro: memoria insuficiente (solucionador).\n");
+        exit(1);
+    }
+    for (uint32_t s = 0; s < numSus; ++s) sol->suspeitos[s].melhorSala = -1;
+    resumirSubarvores(m, sol);
+
+    // ocorrencias de cada pista no caminho atual e pontos das pistas distintas por suspeito
+    uint32_t *ocorrencias = (uint32_t*) memZerada(MEM_SOLUCAO, totalInternos(ht->textos), sizeof(uint32_t));
+    uint32_t *pontos = (uint32_t*) memZerada(MEM_SOLUCAO, numSus ? numSus : 1, sizeof(uint32_t));
+    int32_t *pilha = (int32_t*) memAlocar(MEM_SOLUCAO, ((size_t) n * 2 + 2) * sizeof(int32_t));
+    if (!ocorrencias || !pontos || !pilha) { printf("Erro: memoria insuficiente (solucionador).\n"); exit(1); }
+    size_t topo = 0;
+    pilha[topo++] = m->raiz;
+    while (topo > 0) {
+        int32_t v = pilha[--topo];
+        int saindo = v < 0;
+        if (saindo) v = -v - 1;
+        uint32_t pista = m->salas[v].pista;
+        const HashEntrada *e = encontrarEntrada(ht, pista);
+        const Postagem *ps = e != NULL ? suspeitosDaPista(ht, e) : NULL;
+        uint32_t np = e != NULL ? e->suspeitos.quantidade : 0;
+        if (saindo) {
+            if (pista != TEXTO_VAZIO && --ocorrencias[pista] == 0)
+                for (uint32_t k = 0; k < np; ++k) pontos[ps[k].id] -= ps[k].peso;
+            continue;
+        }
+        if (pista != TEXTO_VAZIO && ocorrencias[pista]++ == 0) {
+            for (uint32_t k = 0; k < np; ++k) {
+                uint32_t antes = pontos[ps[k].id];
+                pontos[ps[k].id] = antes + ps[k].peso;
+                if (antes >= limiar || antes + ps[k].peso < limiar) continue;
+                // o suspeito passou do limiar nesta sala
+                ResumoSuspeito *r = &sol->suspeitos[ps[k].id];
+                r->caminhos += sol->tamanho[v];
+                r->caminhosFolha += sol->folhas[v];
+                if (r->melhorSala < 0 || sol->profundidade[v] < sol->profundidade[r->melhorSala])
+                    r->melhorSala = v;
+            }
+        }
+        pilha[topo++] = -v - 1;
+        // filhas na arvore, empilhadas ao contrario para visitar a primeira saida antes
+        for (uint32_t k = numSaidasSala(m, v); k-- > 0; ) {
+            int32_t w = saidaSala(m, v, k);
+            if (salaValida(m, w) && filhoNaArvore(sol, v, k, w)) pilha[topo++] = w;
+        }
+    }
+    // a busca devolveu 'ocorrencias' a zero: reaproveitada para contar cada pista alcancavel uma vez
+    for (uint32_t v = 0; v < n; ++v) {
+        uint32_t pista = m->salas[v].pista;
+        if (sol->pai[v] < 0 && v != (uint32_t) m->raiz) continue;
+        if (pista == TEXTO_VAZIO || ocorrencias[pista]++ != 0) continue;
+        const HashEntrada *e = encontrarEntrada(ht, pista);
+        if (e == NULL) continue;
+        const Postagem *ps = suspeitosDaPista(ht, e);
+        for (uint32_t k = 0; k < e->suspeitos.quantidade; ++k)
+            sol->suspeitos[ps[k].id].pontosAlcancaveis += ps[k].peso;
+    }
+    memLiberar(ocorrencias);
+    memLiberar(pontos);
+    memLiberar(pilha);
+}
+
+// escreve em 'buf' os movimentos da raiz ate a sala 'destino', no formato dos roteiros
+void caminhoAte(const Mansao *m, const SolucaoCaminhos *sol, int32_t destino, char *buf, size_t cap) {
+    (void) m;
+    uint32_t prof = sol->profundidade[destino];
+    if (prof + 1 > cap) { snprintf(buf, cap, "(%u movimentos)", prof); return; }
+    buf[prof] = '\0';
+    for (int32_t v = destino; sol->pai[v] >= 0; v = sol->pai[v])
+        buf[--prof] = letraSaida(sol->saidaPai[v]);
+}
+
+// pontos contra 's' da pista da sala 'v', se ela ainda nao foi recolhida no roteiro
+static uint32_t recolherNoRoteiro(const Mansao *m, const HashTable *ht, uint32_t s, int32_t v,
+                                  unsigned char *recolhida) {
+    uint32_t pista = m->salas[v].pista;
+    if (pista == TEXTO_VAZIO || recolhida[pista]) return 0;
+    recolhida[pista] = 1;
+    const HashEntrada *e = encontrarEntrada(ht, pista);
+    return e != NULL ? pesoContra(ht, e, s) : 0;
+}
+
+// roteiroComVolta() – escreve em 'buf' um roteiro que condena o suspeito 's' usando 'v'
+// anda so pela arvore de caminhos minimos, onde a trilha de volta e o caminho desde a raiz: para
+// ir da sala atual a outra, volta ate o ancestral comum e desce. Guloso, nao necessariamente o
+// mais curto: a cada passo vai a sala mais proxima com uma pista nova contra o suspeito.
+// Retorna os movimentos (a sala final em *fim), ou 0 se as pistas alcancaveis nao bastam
+static uint32_t roteiroComVolta(const Mansao *m, const HashTable *ht, const SolucaoCaminhos *sol,
+                                uint32_t s, char *buf, size_t cap, int32_t *fim) {
+    unsigned char *recolhida = (unsigned char*) memZerada(MEM_SOLUCAO, totalInternos(ht->textos), 1);
+    if (recolhida == NULL) { printf("Erro: memoria insuficiente (solucionador).\n"); exit(1); }
+    // salas alcancaveis com pistas contra o suspeito (a raiz ja entra no inicio do roteiro)
+    int32_t *alvos = (int32_t*) memAlocar(MEM_SOLUCAO, ((size_t) m->numSalas + 1) * sizeof(int32_t));
+    if (alvos == NULL) { printf("Erro: memoria insuficiente (solucionador).\n"); exit(1); }
+    uint32_t numAlvos = 0;
+    for (uint32_t t = 0; t < m->numSalas; ++t) {
+        const HashEntrada *e = encontrarEntrada(ht, m->salas[t].pista);
+        if (sol->pai[t] >= 0 && e != NULL && implicaSuspeito(ht, e, s)) alvos[numAlvos++] = (int32_t) t;
+    }
+    int32_t atual = m->raiz;
+    uint32_t pontos = recolherNoRoteiro(m, ht, s, atual, recolhida), movimentos = 0;
+    int cabe = 1;
+    while (pontos < sol->limiar) {
+        int32_t alvo = -1, comumAlvo = -1;
+        uint32_t melhor = UINT32_MAX;
+        for (uint32_t k = 0; k < numAlvos; ++k) {
+            int32_t t = alvos[k];
+            if (recolhida[m->salas[t].pista]) continue;
+            int32_t a = atual, b = t;
+            while (sol->profundidade[a] > sol->profundidade[b]) a = sol->pai[a];
+            while (sol->profundidade[b] > sol->profundidade[a]) b = sol->pai[b];
+            while (a != b) { a = sol->pai[a]; b = sol->pai[b]; }
+            uint32_t d = sol->profundidade[atual] + sol->profundidade[t] - 2 * sol->profundidade[a];
+            if (d < melhor) { melhor = d; alvo = t; comumAlvo = a; }
+        }
+        if (alvo < 0) break;
+        uint32_t subir = sol->profundidade[atual] - sol->profundidade[comumAlvo];
+        uint32_t descer = sol->profundidade[alvo] - sol->profundidade[comumAlvo];
+        cabe = cabe && movimentos + subir + descer + 1 <= cap;
+        if (cabe) memset(buf + movimentos, 'v', subir);
+        movimentos += subir + descer;
+        // as letras da descida saem do alvo para cima; as salas do caminho tambem entregam pistas
+        for (int32_t v = alvo, i = (int32_t) movimentos; v != comumAlvo; v = sol->pai[v]) {
+            if (cabe) buf[--i] = letraSaida(sol->saidaPai[v]);
+            pontos += recolherNoRoteiro(m, ht, s, v, recolhida);
+        }
+        atual = alvo;
+    }
+    memLiberar(recolhida);
+    memLiberar(alvos);
+    if (pontos < sol->limiar) return 0;
+    if (!cabe) snprintf(buf, cap, "(%u movimentos)", movimentos);
+    else buf[movimentos] = '\0';
+    *fim = atual;
+    return movimentos;
+}
+
+// exibe, por suspeito, os caminhos que o condenam e o caminho mais curto; sem caminho que
+// condene, um roteiro que volta com 'v' quando as pistas alcancaveis bastam
+void exibirSolucao(const Mansao *m, const HashTable *ht, const SolucaoCaminhos *sol) {
+    char caminho[256];
+    printf("===== CAMINHOS QUE CONDENAM (limiar: %u pontos) =====\n", sol->limiar);
+    if (!sol->arvore)
+        printf("(mapa com ciclos ou salas compartilhadas: caminhos contados na arvore de caminhos minimos)\n");
+    printf("caminhos totais: %llu (saida em qualquer sala), %llu (ate uma folha)\n",
+           (unsigned long long) sol->tamanho[m->raiz], (unsigned long long) sol->folhas[m->raiz]);
+    for (uint32_t s = 0; s < sol->numSuspeitos; ++s) {
+        const ResumoSuspeito *r = &sol->suspeitos[s];
+        const char *nome = textoInterno(ht->textos, ht->nomeSuspeito[s]);
+        if (r->melhorSala < 0) {
+            int32_t fim;
+            uint32_t movs = roteiroComVolta(m, ht, sol, s, caminho, sizeof caminho, &fim);
+            if (movs == 0)
+                printf("%s: nenhum caminho condena, nem voltando com 'v' (%u pontos alcancaveis)\n",
+                       nome, r->pontosAlcancaveis);
+            else
+                printf("%s: nenhum caminho sem voltar condena; voltando com 'v': %s (%u movimentos, termina em %s)\n",
+                       nome, caminho, movs, nomeSala(m, fim));
+            continue;
+        }
+        caminhoAte(m, sol, r->melhorSala, caminho, sizeof caminho);
+        printf("%s: %llu caminho(s), %llu ate folha; mais curto: %s (%u movimentos, termina em %s)\n",
+               nome, (unsigned long long) r->caminhos, (unsigned long long) r->caminhosFolha,
+               caminho[0] ? caminho : "(sala inicial)", sol->profundidade[r->melhorSala],
+               nomeSala(m, r->melhorSala));
+    }
+}
+
+void liberarSolucao(SolucaoCaminhos *sol) {
+    memLiberar(sol->pai);
+    memLiberar(sol->saidaPai);
+    memLiberar(sol->profundidade);
+    memLiberar(sol->tamanho);
+    memLiberar(sol->folhas);
+    memLiberar(sol->suspeitos);
+    memset(sol, 0, sizeof *sol);
+}
+
+// =========================
+// AVALIACAO FINAL
+// =========================
+
+
+// iniciarJulgamento() – escreve em 'b' as pistas coletadas e o pedido do nome do acusado
+// retorna 0 (e o aviso) se nao ha pista nenhuma, quando o julgamento termina sem acusacao
+int iniciarJulgamento(BufferSaida *b, const Sessao *se) {
+    if (se->pistas.raiz == NULL) {
+        bufTexto(b, "\nNenhuma pista foi coletada. Nao ha como acusar alguem com base em evidencias.\n");
+        return 0;
+    }
+    bufTexto(b, "\n===== PISTAS COLETADAS =====\n");
+    relatorioPistas(&se->pistas, NULL, b, RELATORIO_TEXTO, NULL, NULL, NULL);
+    bufTexto(b, "\n(dica: termine o nome com '?' para ver sugestoes)\n"
+                "\nDigite o nome do suspeito que deseja acusar: ");
+    return 1;
+}
+
+// processarAcusacao() – trata o nome digitado no julgamento e escreve a resposta em 'b'
+// requisito: as pistas coletadas devem somar ao menos o limiar da sessao contra o acusado
+// os pontos de todos os suspeitos sao recalculados numa passada pelas pistas da sessao;
+// o nome e reconhecido pelo indice 'nomes' (sem acentos/pontuacao, por prefixo ou com pequenos
+// erros); terminar com '?' lista sugestoes, e um nome ambiguo, desconhecido ou sem nenhuma
+// letra ou numero pede outra tentativa
+ResultadoAcusacao processarAcusacao(BufferSaida *b, Sessao *se, const HashTable *ht, IndiceNomes *nomes,
+                                    const char *linha) {
+    char acusado[MAXNOME], chave[MAXNOME];
+    uint32_t candidatos[SUGESTOES_NOME], numCandidatos;
+    snprintf(acusado, sizeof acusado, "%s", linha);
+    acusado[strcspn(acusado, "\r\n")] = '\0';
+
+    if (strlen(acusado) == 0) {
+        bufTexto(b, "Nenhum nome informado. Acusacao abortada.\n");
+        return ACUSACAO_ABORTADA;
+    }
+
+    size_t n = strlen(acusado);
+    int sugestoes = acusado[n - 1] == '?';
+    if (sugestoes) acusado[n - 1] = '\0';
+    // "?", "??", "...": sem letras nem numeros nao ha o que comparar com os nomes (bytes fora do
+    // ASCII, que normalizarNome descarta, ainda foram um nome digitado: caem em desconhecido)
+    int foraAscii = 0;
+    for (const unsigned char *p = (const unsigned char*) acusado; *p != '\0'; ++p) foraAscii |= *p >= 0x80;
+    if (normalizarNome(acusado, chave, sizeof chave) == 0 && !foraAscii) {
+        bufTexto(b, "Digite um nome com letras ou numeros.\n"
+                    "\nDigite o nome do suspeito que deseja acusar: ");
+        return ACUSACAO_REPETIR;
+    }
+
+    ResultadoNome r;
+    if (sugestoes) {
+        numCandidatos = completarNome(nomes, acusado, candidatos, SUGESTOES_NOME);
+        r = NOME_AMBIGUO;
+        if (numCandidatos == 0) bufFormatar(b, "Nenhum suspeito comeca com \"%s\".\n", acusado);
+    } else {
+        r = resolverNomeAcusado(nomes, ht, acusado, candidatos, SUGESTOES_NOME, &numCandidatos);
+    }
+    if (r == NOME_AMBIGUO) {
+        if (numCandidatos > 0) bufTexto(b, "Voce quis dizer:\n");
+        for (uint32_t k = 0; k < numCandidatos; ++k)
+            bufFormatar(b, "  - %s\n", textoInterno(ht->textos, ht->nomeSuspeito[candidatos[k]]));
+        bufTexto(b, "\nDigite o nome do suspeito que deseja acusar: ");
+        return ACUSACAO_REPETIR;
+    }
+    if (r == NOME_DESCONHECIDO) {
+        bufFormatar(b, "Suspeito desconhecido: \"%s\" nao lembra nenhum nome do caso.\n"
+                       "(dica: termine o nome com '?' para ver sugestoes)\n"
+                       "\nDigite o nome do suspeito que deseja acusar: ", acusado);
+        return ACUSACAO_REPETIR;
+    }
+    uint32_t idx = candidatos[0];
+    const char *nome = textoInterno(ht->textos, ht->nomeSuspeito[idx]);
+    if (r != NOME_EXATO) bufFormatar(b, "(entendido como: %s)\n", nome);
+    snprintf(acusado, sizeof acusado, "%s", nome);
+
+    INSTR_INICIO(t0);
+    Evidencias *ev = &se->ev;
+    pontuarSuspeitos(ev, ht, se->coletadas, se->pistas.total);
+    uint32_t cont = ev->pontos[idx];
+    bufFormatar(b, "\nPontos de evidencia contra %s: %u (limiar: %u)\n", acusado, cont, ev->limiar);
+
+    if (cont >= ev->limiar) {
+        bufFormatar(b, "\nResultado: Ha evidencias suficientes! %s eh considerado(a) culpado(a).\n", acusado);
+    } else {
+        bufFormatar(b, "\nResultado: Nao ha evidencias suficientes para sustentar a acusacao contra %s.\n", acusado);
+    }
+
+    escreverRanking(b, ev, ht);
+    INSTR_FIM(MED_JULGAMENTO, t0);
+    return ACUSACAO_CONCLUIDA;
+}
+
+// verificarSuspeitoFinal() – conduz a fase de julgamento final no terminal, lendo os nomes
+// de 'entrada' e escrevendo cada resposta com uma unica chamada ao sistema
+// retorna 1 se o julgamento chegou ao veredito
+int verificarSuspeitoFinal(Sessao *se, HashTable *ht, IndiceNomes *nomes, LeitorEntrada *entrada) {
+    char memoria[BUFFER_SAIDA];
+    BufferSaida b;
+    inicializarBufferSaida(&b, stdout, memoria, sizeof memoria);
+    int aberto = iniciarJulgamento(&b, se);
+    descarregarBuffer(&b);
+    fflush(stdout);
+    if (!aberto) return 1;
+    for (;;) {
+        char *linha;
+        size_t tam;
+        if (lerLinhaEntrada(entrada, &linha, &tam) != LINHA_OK) {
+            printf("Entrada invalida.\n");
+            return 0;
+        }
+        ResultadoAcusacao r = processarAcusacao(&b, se, ht, nomes, linha);
+        descarregarBuffer(&b);
+        fflush(stdout);
+        if (r != ACUSACAO_REPETIR) return r == ACUSACAO_CONCLUIDA;
+    }
+}
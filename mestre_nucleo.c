@@ -0,0 +1,4133 @@
+// Nucleo do Detetive Quest (nivel mestre): memoria, textos internados, mansao, gerador, pistas,
+// tabela hash, saida e entrada buferizadas, evidencias, nomes, sessoes, diario e consultas
+
+#include "NivelMestre4.h"
+
+// =========================
+// FUNCOES AUXILIARES
+// =========================
+
+#define BYTES_01 0x0101010101010101ull
+#define BYTES_80 0x8080808080808080ull
+
+// converte as letras ASCII maiusculas de 8 bytes de uma vez para minusculas (SWAR)
+// bytes >= 0x80 (UTF-8) ficam como estao, como fazia tolower no locale "C"
+static inline uint64_t minusculas8(uint64_t w) {
+    uint64_t h = w & ~BYTES_80;                       // 7 bits de cada byte
+    uint64_t geA = h + (0x80 - 'A') * BYTES_01;       // bit alto: byte >= 'A'
+    uint64_t gtZ = h + (0x80 - 'Z' - 1) * BYTES_01;   // bit alto: byte > 'Z'
+    uint64_t maiusc = (geA ^ gtZ) & ~w & BYTES_80;
+    return w | (maiusc >> 2);                         // 0x80 >> 2 == 0x20
+}
+
+// Converte string para minusculas (resultado em buffer, que deve ter espaco suficiente)
+// processa 8 bytes por iteracao; limitado a MAXPISTA-1 caracteres
+void strToLower(const char *src, char *buffer) {
+    size_t n = strnlen(src, MAXPISTA-1), i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        memcpy(&w, src + i, 8);
+        w = minusculas8(w);
+        memcpy(buffer + i, &w, 8);
+    }
+    for (; i < n; ++i) {
+        unsigned char c = (unsigned char) src[i];
+        buffer[i] = (char) (c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+    }
+    buffer[n] = '\0';
+}
+
+// semente dos hashes de texto e de id, sorteada a cada execucao (ou fixada com --semente)
+// para que mapas montados de proposito nao consigam forcar colisoes
+uint64_t sementeHash = 0x243F6A8885A308D3ull;
+
+void inicializarSementeHash(void) {
+    uint64_t s;
+    if (getrandom(&s, sizeof s, 0) != (ssize_t) sizeof s)
+        s = (uint64_t) time(NULL) ^ ((uint64_t) getpid() << 32) ^ (uint64_t) (uintptr_t) &s;
+    sementeHash = s;
+}
+
+static const uint64_t WY_P0 = 0xa0761d6478bd642full, WY_P1 = 0xe7037ed1a0b428dbull,
+                      WY_P2 = 0x8ebc6af09c88c6e3ull, WY_P3 = 0x589965cc75374cc3ull;
+
+// multiplicacao 64x64 -> 128 bits dobrada em 64 bits
+static inline uint64_t wyMistura(uint64_t a, uint64_t b) {
+    __uint128_t r = (__uint128_t) a * b;
+    return (uint64_t) r ^ (uint64_t) (r >> 64);
+}
+
+static inline uint64_t ler64(const unsigned char *p) { uint64_t v; memcpy(&v, p, 8); return v; }
+static inline uint64_t ler32(const unsigned char *p) { uint32_t v; memcpy(&v, p, 4); return v; }
+
+// hashTexto() – hash de 'n' bytes no estilo wyhash: le 8 a 48 bytes por iteracao
+// e mistura com multiplicacoes de 128 bits; 'semente' muda toda a familia de hashes
+uint64_t hashTexto(const void *dados, size_t n, uint64_t semente) {
+    const unsigned char *p = (const unsigned char*) dados;
+    uint64_t a, b;
+    semente ^= wyMistura(semente ^ WY_P0, WY_P1);
+    if (n <= 16) {
+        if (n >= 4) {
+            size_t d = (n >> 3) << 2;
+            a = (ler32(p) << 32) | ler32(p + d);
+            b = (ler32(p + n - 4) << 32) | ler32(p + n - 4 - d);
+        } else if (n > 0) {
+            a = ((uint64_t) p[0] << 16) | ((uint64_t) p[n >> 1] << 8) | p[n - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = n;
+        if (i > 48) {
+            uint64_t s1 = semente, s2 = semente;
+            do {
+                semente = wyMistura(ler64(p) ^ WY_P1, ler64(p + 8) ^ semente);
+                s1 = wyMistura(ler64(p + 16) ^ WY_P2, ler64(p + 24) ^ s1);
+                s2 = wyMistura(ler64(p + 32) ^ WY_P3, ler64(p + 40) ^ s2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            semente ^= s1 ^ s2;
+        }
+        while (i > 16) {
+            semente = wyMistura(ler64(p) ^ WY_P1, ler64(p + 8) ^ semente);
+            p += 16;
+            i -= 16;
+        }
+        a = ler64(p + i - 16);
+        b = ler64(p + i - 8);
+    }
+    __uint128_t r = (__uint128_t) (a ^ WY_P1) * (b ^ semente);
+    return wyMistura((uint64_t) r ^ WY_P0 ^ n, (uint64_t) (r >> 64) ^ WY_P1);
+}
+
+// Calcula o hash de uma string (hashTexto com a semente da execucao)
+// o indice do bucket sai com a mascara da tabela (capacidade potencia de 2)
+unsigned int hashFunc(const char *str) {
+    return (unsigned int) hashTexto(str, strlen(str), sementeHash);
+}
+
+// Espalha os bits de um id interno (finalizador do murmur3, com semente) para indexar tabelas
+static inline uint32_t espalharId(uint32_t x, uint32_t semente) {
+    x ^= semente;
+    x ^= x >> 16;
+    x *= 0x85ebca6bu;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35u;
+    x ^= x >> 16;
+    return x;
+}
+
+static inline uint32_t hashId(uint32_t x) {
+    return espalharId(x, (uint32_t) sementeHash);
+}
+
+// tempo monotonico em nanossegundos
+double agoraNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+// opcaoGlobal() – 1 se 'opcao' e --semente, --memoria ou --alocador: valem em qualquer posicao
+// da linha de comando, para todos os modos do jogo e para os benchmarks
+int opcaoGlobal(const char *opcao) {
+    return strcmp(opcao, "--semente") == 0 || strcmp(opcao, "--memoria") == 0 || strcmp(opcao, "--alocador") == 0;
+}
+
+// aplicarOpcaoGlobal() – aplica uma opcao global com o seu valor; valor invalido encerra com erro
+void aplicarOpcaoGlobal(const char *opcao, const char *valor) {
+    if (strcmp(opcao, "--semente") == 0) {
+        sementeHash = strtoull(valor, NULL, 0);
+    } else if (strcmp(opcao, "--memoria") == 0) {
+        if (strcmp(valor, "texto") != 0 && strcmp(valor, "json") != 0) {
+            printf("Erro: formato de memoria invalido: %s (use 'texto' ou 'json')\n", valor);
+            exit(1);
+        }
+#ifdef CONTABILIZAR_MEMORIA
+        iniciarRelatorioMemoria(strcmp(valor, "json") == 0);
+#else
+        fprintf(stderr, "Aviso: compilado sem -DINSTRUMENTAR; --memoria ignorado.\n");
+#endif
+    } else if (strcmp(opcao, "--alocador") == 0) {
+        int modo = 0;
+        while (modo < NUM_MODOS_ALOCADOR && strcmp(valor, nomesModosAlocador[modo]) != 0) modo++;
+        if (modo == NUM_MODOS_ALOCADOR) {
+            printf("Erro: alocador invalido: %s (use 'arena', 'pool' ou 'sistema')\n", valor);
+            exit(1);
+        }
+        modoAlocadorPistas = (ModoAlocador) modo;
+    }
+}
+
+// =========================
+// INSTRUMENTACAO (-DINSTRUMENTAR)
+// =========================
+
+// Sem -DINSTRUMENTAR as macros de NivelMestre4.h nao geram codigo algum
+#ifdef INSTRUMENTAR
+
+static const char *nomesMedidas[NUM_MEDIDAS] = {
+    "carregar_mapa", "popular_hash", "movimento", "inserir_pista", "julgamento", "sessao_replay",
+    "sondagem_hash", "profundidade_avl"
+};
+
+static _Thread_local BlocoInstr *instrLocal;
+static BlocoInstr *instrBlocos;
+static pthread_mutex_t instrTrava = PTHREAD_MUTEX_INITIALIZER;
+static int instrFormatoJson;
+
+static inline unsigned instrBalde(uint64_t v) {
+    if (v < (1u << INSTR_SUB_BITS)) return (unsigned) v;
+    unsigned e = 63u - (unsigned) __builtin_clzll(v);
+    unsigned sub = (unsigned) (v >> (e - INSTR_SUB_BITS)) & ((1u << INSTR_SUB_BITS) - 1);
+    return ((e - INSTR_SUB_BITS + 1) << INSTR_SUB_BITS) + sub;
+}
+
+// maior valor que cai no balde 'b' (como o HDR, os percentis sao arredondados para cima)
+static uint64_t instrTetoBalde(unsigned b) {
+    if (b < (1u << INSTR_SUB_BITS)) return b;
+    unsigned e = (b >> INSTR_SUB_BITS) + INSTR_SUB_BITS - 1;
+    uint64_t base = (uint64_t) ((1u << INSTR_SUB_BITS) + (b & ((1u << INSTR_SUB_BITS) - 1))) << (e - INSTR_SUB_BITS);
+    return base + ((1ull << (e - INSTR_SUB_BITS)) - 1);
+}
+
+// bloco da thread atual (criado e registrado na primeira medicao da thread)
+static BlocoInstr* instrBloco(void) {
+    if (instrLocal == NULL) {
+        // fora da contabilidade de memoria: o bloco vive ate o fim do processo
+        BlocoInstr *b = (BlocoInstr*) calloc(1, sizeof(BlocoInstr));
+        if (b == NULL) { printf("Erro: memoria insuficiente (instrumentacao).\n"); exit(1); }
+        pthread_mutex_lock(&instrTrava);
+        b->proximo = instrBlocos;
+        instrBlocos = b;
+        pthread_mutex_unlock(&instrTrava);
+        instrLocal = b;
+    }
+    return instrLocal;
+}
+
+void instrRegistrar(MedidaInstr m, uint64_t v) {
+    HistogramaInstr *h = &instrBloco()->medidas[m];
+    h->contagem++;
+    h->soma += v;
+    if (v > h->maximo) h->maximo = v;
+    h->baldes[instrBalde(v)]++;
+}
+
+static uint64_t instrPercentil(const HistogramaInstr *h, double q) {
+    uint64_t alvo = (uint64_t) (q * (double) h->contagem + 0.5), acumulado = 0;
+    if (alvo == 0) alvo = 1;
+    for (unsigned b = 0; b < INSTR_BALDES; ++b) {
+        acumulado += h->baldes[b];
+        if (acumulado >= alvo) return instrTetoBalde(b) < h->maximo ? instrTetoBalde(b) : h->maximo;
+    }
+    return h->maximo;
+}
+
+// despejarInstrumentos() – soma os blocos de todas as threads e escreve uma linha por medida
+// (os blocos das threads ainda ativas sao lidos sem trava: o despejo por sinal e aproximado)
+void despejarInstrumentos(FILE *saida, int json) {
+    static HistogramaInstr total[NUM_MEDIDAS];
+    int threads = 0;
+    memset(total, 0, sizeof total);
+    pthread_mutex_lock(&instrTrava);
+    for (const BlocoInstr *b = instrBlocos; b != NULL; b = b->proximo, threads++)
+        for (int m = 0; m < NUM_MEDIDAS; ++m) {
+            const HistogramaInstr *h = &b->medidas[m];
+            total[m].contagem += h->contagem;
+            total[m].soma += h->soma;
+            if (h->maximo > total[m].maximo) total[m].maximo = h->maximo;
+            for (unsigned k = 0; k < INSTR_BALDES; ++k) total[m].baldes[k] += h->baldes[k];
+        }
+    pthread_mutex_unlock(&instrTrava);
+
+    if (!json) fprintf(saida, "===== INSTRUMENTACAO (%d thread(s)) =====\n", threads);
+    for (int m = 0; m < NUM_MEDIDAS; ++m) {
+        const HistogramaInstr *h = &total[m];
+        if (h->contagem == 0) continue;
+        const char *unidade = m < MED_SONDAGEM_HASH ? "ns" : "passos";
+        double media = (double) h->soma / (double) h->contagem;
+        unsigned long long p50 = instrPercentil(h, 0.50), p90 = instrPercentil(h, 0.90),
+                           p99 = instrPercentil(h, 0.99), p999 = instrPercentil(h, 0.999);
+        if (json)
+            fprintf(saida, "{\"medida\":\"%s\",\"unidade\":\"%s\",\"contagem\":%llu,\"soma\":%llu,"
+                           "\"media\":%.2f,\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"p999\":%llu,\"max\":%llu}\n",
+                    nomesMedidas[m], unidade, (unsigned long long) h->contagem, (unsigned long long) h->soma,
+                    media, p50, p90, p99, p999, (unsigned long long) h->maximo);
+        else
+            fprintf(saida, "%-17s n=%-10llu media=%-10.1f p50=%-8llu p90=%-8llu p99=%-8llu p999=%-8llu max=%llu %s\n",
+                    nomesMedidas[m], (unsigned long long) h->contagem, media, p50, p90, p99, p999,
+                    (unsigned long long) h->maximo, unidade);
+    }
+    fflush(saida);
+}
+
+static void despejarNaSaida(void) {
+    despejarInstrumentos(stderr, instrFormatoJson);
+}
+
+// thread que atende SIGUSR1 com sigwait (o despejo nao roda dentro de um tratador de sinal)
+static void* instrAtenderSinal(void *arg) {
+    sigset_t *conjunto = (sigset_t*) arg;
+    int sinal;
+    while (sigwait(conjunto, &sinal) == 0) despejarInstrumentos(stderr, instrFormatoJson);
+    return NULL;
+}
+
+// iniciarInstrumentos() – chamada no inicio de main, antes de criar threads (que herdam a mascara):
+// SIGUSR1 passa a despejar os contadores; 'naSaida' tambem despeja ao terminar o processo
+void iniciarInstrumentos(int json, int naSaida) {
+    static sigset_t conjunto;
+    instrFormatoJson = json;
+    sigemptyset(&conjunto);
+    sigaddset(&conjunto, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &conjunto, NULL);
+    pthread_t t;
+    if (pthread_create(&t, NULL, instrAtenderSinal, &conjunto) == 0) pthread_detach(t);
+    if (naSaida) atexit(despejarNaSaida);
+}
+
+#endif
+
+// =========================
+// CONTABILIDADE DE MEMORIA
+// =========================
+
+#ifdef CONTABILIZAR_MEMORIA
+
+ContadorMemoria contadoresMemoria[NUM_CATEGORIAS_MEMORIA];
+_Atomic size_t memoriaViva, memoriaPico;
+_Thread_local size_t totalAlocacoes;
+
+static const char *nomesCategoriasMemoria[NUM_CATEGORIAS_MEMORIA] = {
+    "geral", "mapa", "textos", "pistas", "hash", "evidencias", "nomes", "sessoes",
+    "diario", "consultas", "buffers", "motor", "simulacao", "solucao", "servidor", "bench"
+};
+
+static int memFormatoJson;
+
+// despejarMemoria() – uma linha por categoria que alocou algo (blocos e bytes vivos, pico e
+// numero de alocacoes) e uma linha de total; blocos ainda vivos no fim do processo sao vazamentos
+void despejarMemoria(FILE *saida, int json) {
+    size_t vazamentos = 0;
+    if (!json) fprintf(saida, "===== MEMORIA =====\n");
+    for (int c = 0; c < NUM_CATEGORIAS_MEMORIA; ++c) {
+        const ContadorMemoria *k = &contadoresMemoria[c];
+        size_t objetos = atomic_load(&k->objetos), bytes = atomic_load(&k->bytes),
+               pico = atomic_load(&k->pico), alocacoes = atomic_load(&k->alocacoes);
+        if (alocacoes == 0) continue;
+        vazamentos += objetos;
+        if (json)
+            fprintf(saida, "{\"categoria\":\"%s\",\"objetos\":%zu,\"bytes\":%zu,\"pico\":%zu,\"alocacoes\":%zu}\n",
+                    nomesCategoriasMemoria[c], objetos, bytes, pico, alocacoes);
+        else
+            fprintf(saida, "%-11s objetos=%-8zu bytes=%-10zu pico=%-10zu alocacoes=%zu\n",
+                    nomesCategoriasMemoria[c], objetos, bytes, pico, alocacoes);
+    }
+    size_t viva = atomic_load(&memoriaViva), pico = atomic_load(&memoriaPico);
+    if (json)
+        fprintf(saida, "{\"categoria\":\"total\",\"bytes\":%zu,\"pico\":%zu,\"vazamentos\":%zu}\n",
+                viva, pico, vazamentos);
+    else
+        fprintf(saida, "%-11s bytes=%-10zu pico=%-10zu vazamentos=%zu bloco(s)\n", "total", viva, pico, vazamentos);
+    fflush(saida);
+}
+
+static void despejarMemoriaNaSaida(void) {
+    despejarMemoria(stderr, memFormatoJson);
+}
+
+// iniciarRelatorioMemoria() – despeja a contabilidade em stderr quando o processo terminar
+void iniciarRelatorioMemoria(int json) {
+    memFormatoJson = json;
+    atexit(despejarMemoriaNaSaida);
+}
+
+#endif
+
+// =========================
+// ARENA DE MEMORIA
+// =========================
+
+// aloca um bloco novo para a arena com pelo menos 'minimo' bytes livres
+static void arenaNovoBloco(Arena *a, size_t minimo) {
+    size_t cap = minimo > ARENA_BLOCO ? minimo : ARENA_BLOCO;
+    BlocoArena *b = (BlocoArena*) memAlocar(a->categoria, sizeof(BlocoArena) + cap);
+    if (b == NULL) { printf("Erro: memoria insuficiente (arena).\n"); exit(1); }
+    b->anterior = a->atual;
+    b->capacidade = cap;
+    b->usados = 0;
+    a->atual = b;
+}
+
+// inicializa uma arena vazia (o primeiro bloco so e criado na primeira alocacao);
+// os blocos sao contabilizados em 'categoria'
+void inicializarArena(Arena *a, CategoriaMemoria categoria) {
+    a->atual = NULL;
+    a->categoria = categoria;
+}
+
+// arenaAlocarAlinhado() – reserva 'tam' bytes com inicio alinhado a 'alinhamento'
+// (potencia de 2, no maximo 16) (bump allocation)
+void* arenaAlocarAlinhado(Arena *a, size_t tam, size_t alinhamento) {
+    size_t ini = 0;
+    if (a->atual != NULL) ini = (a->atual->usados + alinhamento - 1) & ~(alinhamento - 1);
+    if (a->atual == NULL || ini > a->atual->capacidade || a->atual->capacidade - ini < tam) {
+        arenaNovoBloco(a, tam);
+        ini = 0;
+    }
+    a->atual->usados = ini + tam;
+    return a->atual->dados + ini;
+}
+
+// arenaAlocar() – reserva 'tam' bytes alinhados a 16
+void* arenaAlocar(Arena *a, size_t tam) {
+    return arenaAlocarAlinhado(a, tam, 16);
+}
+
+// descarta todo o conteudo da arena mas mantem o bloco mais recente para reuso
+void reiniciarArena(Arena *a) {
+    if (a->atual == NULL) return;
+    BlocoArena *b = a->atual->anterior;
+    while (b != NULL) {
+        BlocoArena *ant = b->anterior;
+        memLiberar(b);
+        b = ant;
+    }
+    a->atual->anterior = NULL;
+    a->atual->usados = 0;
+}
+
+// libera todos os blocos da arena de uma vez
+void liberarArena(Arena *a) {
+    BlocoArena *b = a->atual;
+    while (b != NULL) {
+        BlocoArena *ant = b->anterior;
+        memLiberar(b);
+        b = ant;
+    }
+    a->atual = NULL;
+}
+
+// =========================
+// ALOCADOR DE OBJETOS
+// =========================
+
+const char *nomesModosAlocador[NUM_MODOS_ALOCADOR] = { "arena", "pool", "sistema" };
+
+// inicializa um alocador vazio de objetos de 'tamObjeto' bytes, contabilizado em 'categoria'
+void inicializarAlocadorObjetos(AlocadorObjetos *a, ModoAlocador modo, size_t tamObjeto,
+                                CategoriaMemoria categoria) {
+    a->modo = modo;
+    a->tamObjeto = (tamObjeto + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    a->categoria = categoria;
+    inicializarArena(&a->arena, categoria);
+    a->blocos = NULL;
+    a->usadosNoBloco = POOL_OBJETOS;
+    a->livres = NULL;
+}
+
+// alocarObjeto() – devolve espaco para um objeto (alinhado a ponteiro, conteudo indefinido)
+void* alocarObjeto(AlocadorObjetos *a) {
+    if (a->modo == ALOCADOR_ARENA) return arenaAlocarAlinhado(&a->arena, a->tamObjeto, sizeof(void*));
+    if (a->modo == ALOCADOR_SISTEMA) {
+        void *p = memAlocar(a->categoria, a->tamObjeto);
+        if (p == NULL) { printf("Erro: memoria insuficiente (objeto).\n"); exit(1); }
+        return p;
+    }
+    if (a->livres != NULL) {
+        void *p = a->livres;
+        a->livres = *(void**) p;
+        return p;
+    }
+    if (a->usadosNoBloco == POOL_OBJETOS) {
+        BlocoPool *b = (BlocoPool*) memAlocar(a->categoria, sizeof(BlocoPool) + POOL_OBJETOS * a->tamObjeto);
+        if (b == NULL) { printf("Erro: memoria insuficiente (pool).\n"); exit(1); }
+        b->anterior = a->blocos;
+        a->blocos = b;
+        a->usadosNoBloco = 0;
+    }
+    return a->blocos->dados + a->usadosNoBloco++ * a->tamObjeto;
+}
+
+// devolverObjeto() – no pool o objeto volta para a lista de livres, no modo sistema vai para o
+// free; na arena o espaco so e recuperado quando o alocador inteiro e esvaziado
+void devolverObjeto(AlocadorObjetos *a, void *p) {
+    if (a->modo == ALOCADOR_POOL) {
+        *(void**) p = a->livres;
+        a->livres = p;
+    } else if (a->modo == ALOCADOR_SISTEMA) {
+        memLiberar(p);
+    }
+}
+
+// libera os blocos do pool anteriores a 'ultimo'
+static void liberarBlocosPool(AlocadorObjetos *a, BlocoPool *ultimo) {
+    BlocoPool *b = a->blocos;
+    while (b != ultimo) {
+        BlocoPool *ant = b->anterior;
+        memLiberar(b);
+        b = ant;
+    }
+}
+
+// esvaziarAlocador() – descarta todos os objetos de uma vez, mantendo um bloco para reuso;
+// no modo sistema nao ha blocos: cada objeto precisa ter sido devolvido antes
+void esvaziarAlocador(AlocadorObjetos *a) {
+    if (a->modo == ALOCADOR_ARENA) {
+        reiniciarArena(&a->arena);
+    } else if (a->modo == ALOCADOR_POOL && a->blocos != NULL) {
+        BlocoPool *recente = a->blocos;
+        a->blocos = recente->anterior;
+        liberarBlocosPool(a, NULL);
+        recente->anterior = NULL;
+        a->blocos = recente;
+        a->usadosNoBloco = 0;
+        a->livres = NULL;
+    }
+}
+
+// libera toda a memoria do alocador (no modo sistema, so a dos objetos ja devolvidos)
+void liberarAlocadorObjetos(AlocadorObjetos *a) {
+    liberarArena(&a->arena);
+    liberarBlocosPool(a, NULL);
+    a->blocos = NULL;
+    a->usadosNoBloco = POOL_OBJETOS;
+    a->livres = NULL;
+}
+
+// =========================
+// TEXTOS INTERNADOS
+// =========================
+
+
+// inicializa uma tabela vazia; o id TEXTO_VAZIO ja corresponde a ""
+void inicializarInternos(InternPool *p) {
+    memset(p, 0, sizeof *p);
+    inicializarArena(&p->arena, MEM_TEXTOS);
+    p->capProprios = 64;
+    p->proprios = (const char**) memAlocar(MEM_TEXTOS, p->capProprios * sizeof(const char*));
+    if (p->proprios == NULL) { printf("Erro: memoria insuficiente (textos).\n"); exit(1); }
+    p->proprios[p->numProprios++] = "";
+}
+
+// usa as secoes de textos de uma imagem como base (ids [0, num)), sem copiar nada
+void abrirInternosBase(InternPool *p, const uint32_t *desloc, const char *textos, uint32_t num, uint32_t tam) {
+    memset(p, 0, sizeof *p);
+    inicializarArena(&p->arena, MEM_TEXTOS);
+    p->baseDesloc = desloc;
+    p->baseTextos = textos;
+    p->numBase = num;
+    p->tamBase = tam;
+}
+
+uint32_t totalInternos(const InternPool *p) {
+    return p->numBase + p->numProprios;
+}
+
+// textoInterno() – texto correspondente ao id ("" se o id for invalido)
+const char* textoInterno(const InternPool *p, uint32_t id) {
+    if (id < p->numBase) {
+        uint32_t off = p->baseDesloc[id];
+        return off < p->tamBase ? p->baseTextos + off : "";
+    }
+    id -= p->numBase;
+    return id < p->numProprios ? p->proprios[id] : "";
+}
+
+// insere um id no indice sem verificar duplicatas
+static void indexarInterno(InternPool *p, uint32_t id, uint32_t h) {
+    size_t mascara = p->capIndice - 1;
+    size_t i = h & mascara;
+    while (p->indice[i].idMais1 != 0) i = (i + 1) & mascara;
+    p->indice[i].hash = h;
+    p->indice[i].idMais1 = id + 1;
+}
+
+// (re)constroi o indice com espaco para 'minimo' textos mantendo carga <= 1/2
+static void reconstruirIndice(InternPool *p, size_t minimo) {
+    size_t cap = 64;
+    while (cap < minimo * 2) cap *= 2;
+    memLiberar(p->indice);
+    p->indice = (IndiceTexto*) memZerada(MEM_TEXTOS, cap, sizeof(IndiceTexto));
+    if (p->indice == NULL) { printf("Erro: memoria insuficiente (indice de textos).\n"); exit(1); }
+    p->capIndice = cap;
+    uint32_t total = totalInternos(p);
+    for (uint32_t id = 0; id < total; ++id)
+        indexarInterno(p, id, hashFunc(textoInterno(p, id)));
+}
+
+// procura um texto ja truncado; devolve o id ou UINT32_MAX
+static uint32_t buscarIndice(InternPool *p, const char *s, uint32_t h) {
+    if (p->indice == NULL) reconstruirIndice(p, totalInternos(p) + 1);
+    size_t mascara = p->capIndice - 1;
+    size_t i = h & mascara;
+    while (p->indice[i].idMais1 != 0) {
+        if (p->indice[i].hash == h && strcmp(textoInterno(p, p->indice[i].idMais1 - 1), s) == 0)
+            return p->indice[i].idMais1 - 1;
+        i = (i + 1) & mascara;
+    }
+    return UINT32_MAX;
+}
+
+// copia no maximo 'max'-1 caracteres de 'src' para 'buf'; '*n' recebe o tamanho final
+static const char* truncarTexto(const char *src, char *buf, size_t max, size_t *n) {
+    *n = strnlen(src, max);
+    if (*n < max) return src;
+    *n = max-1;
+    memcpy(buf, src, max-1);
+    buf[max-1] = '\0';
+    return buf;
+}
+
+// buscarInterno() – id de um texto ja internado, ou UINT32_MAX se nao existir
+uint32_t buscarInterno(InternPool *p, const char *s, size_t max) {
+    char buf[MAXPISTA];
+    size_t n;
+    if (s == NULL || s[0] == '\0') return TEXTO_VAZIO;
+    s = truncarTexto(s, buf, max, &n);
+    return buscarIndice(p, s, (uint32_t) hashTexto(s, n, sementeHash));
+}
+
+// internar() – devolve o id do texto (limitado a 'max'-1 caracteres), guardando-o se for novo
+uint32_t internar(InternPool *p, const char *s, size_t max) {
+    char buf[MAXPISTA];
+    size_t n;
+    if (s == NULL || s[0] == '\0') return TEXTO_VAZIO;
+    s = truncarTexto(s, buf, max, &n);
+    uint32_t h = (uint32_t) hashTexto(s, n, sementeHash);
+    uint32_t id = buscarIndice(p, s, h);
+    if (id != UINT32_MAX) return id;
+
+    if (p->numProprios == p->capProprios) {
+        p->capProprios = p->capProprios ? p->capProprios * 2 : 64;
+        p->proprios = (const char**) memRealocar(MEM_TEXTOS, p->proprios, p->capProprios * sizeof(const char*));
+        if (p->proprios == NULL) { printf("Erro: memoria insuficiente (textos).\n"); exit(1); }
+    }
+    char *copia = (char*) arenaAlocarAlinhado(&p->arena, n + 1, 1);
+    memcpy(copia, s, n + 1);
+    id = p->numBase + p->numProprios;
+    p->proprios[p->numProprios++] = copia;
+    if ((size_t) totalInternos(p) * 2 > p->capIndice) reconstruirIndice(p, totalInternos(p));
+    else indexarInterno(p, id, h);
+    return id;
+}
+
+// internarChave() – id do texto em minusculas (chave para comparacoes case-insensitive)
+uint32_t internarChave(InternPool *p, const char *s) {
+    char lower[MAXPISTA];
+    strToLower(s, lower);
+    return internar(p, lower, MAXNOME);
+}
+
+// prepararInternos() – constroi o indice de busca por texto, se ainda nao existir
+// depois disso buscarInterno apenas le a tabela e pode ser chamada por varias threads
+void prepararInternos(InternPool *p) {
+    if (p->indice == NULL) reconstruirIndice(p, totalInternos(p) + 1);
+}
+
+// libera os textos proprios e o indice (a base pertence a imagem da mansao)
+void liberarInternos(InternPool *p) {
+    memLiberar(p->proprios);
+    memLiberar(p->indice);
+    liberarArena(&p->arena);
+    memset(p, 0, sizeof *p);
+}
+
+// =========================
+// FUNCOES PARA SALAS E MANSAO
+// =========================
+
+
+// sala 'i' existe na mansao?
+int salaValida(const Mansao *m, int32_t i) {
+    return i >= 0 && (uint32_t) i < m->numSalas;
+}
+
+const char* nomeSala(const Mansao *m, int32_t i) {
+    return textoInterno(&m->textos, m->salas[i].nome);
+}
+
+const char* pistaSala(const Mansao *m, int32_t i) {
+    return textoInterno(&m->textos, m->salas[i].pista);
+}
+
+// inicializa o construtor com 'numSalas' salas vazias e sem ligacoes
+void inicializarConstrutor(ConstrutorMansao *c, uint32_t numSalas) {
+    memset(c, 0, sizeof *c);
+    c->capSalas = numSalas > 8 ? numSalas : 8;
+    c->salas = (Sala*) memAlocar(MEM_MAPA, c->capSalas * sizeof(Sala));
+    c->capAssociacoes = 64;
+    c->associacoes = (Associacao*) memAlocar(MEM_MAPA, c->capAssociacoes * sizeof(Associacao));
+    c->capLigacoes = c->capSalas * 2;
+    c->ligacoes = (Ligacao*) memAlocar(MEM_MAPA, c->capLigacoes * sizeof(Ligacao));
+    if (c->salas == NULL || c->associacoes == NULL || c->ligacoes == NULL) {
+        printf("Erro: memoria insuficiente para montar a mansao.\n");
+        exit(1);
+    }
+    inicializarInternos(&c->textos);
+    for (uint32_t i = 0; i < numSalas; ++i)
+        c->salas[i].nome = c->salas[i].pista = TEXTO_VAZIO;
+    c->numSalas = numSalas;
+}
+
+// descarta um construtor sem gerar a mansao
+void descartarConstrutor(ConstrutorMansao *c) {
+    memLiberar(c->salas);
+    memLiberar(c->associacoes);
+    memLiberar(c->ligacoes);
+    liberarInternos(&c->textos);
+    memset(c, 0, sizeof *c);
+}
+
+// preenche nome e pista de uma sala ja reservada
+void definirSala(ConstrutorMansao *c, int32_t i, const char *nome, const char *pista) {
+    c->salas[i].nome = internar(&c->textos, nome, MAXNOME);
+    c->salas[i].pista = internar(&c->textos, pista, MAXPISTA);
+}
+
+// criarSala() – acrescenta um comodo (nome, pista) ao array de salas e devolve seu indice
+int32_t criarSala(ConstrutorMansao *c, const char *nome, const char *pista) {
+    if (c->numSalas == c->capSalas) {
+        c->capSalas *= 2;
+        c->salas = (Sala*) memRealocar(MEM_MAPA, c->salas, c->capSalas * sizeof(Sala));
+        if (c->salas == NULL) { printf("Erro: memoria insuficiente para criar sala.\n"); exit(1); }
+    }
+    int32_t i = (int32_t) c->numSalas++;
+    definirSala(c, i, nome, pista);
+    return i;
+}
+
+// acrescenta uma saida a sala 'origem' (depois das ja declaradas); -1 ocupa a posicao sem caminho
+void adicionarSaida(ConstrutorMansao *c, int32_t origem, int32_t destino) {
+    if (c->numLigacoes == c->capLigacoes) {
+        c->capLigacoes *= 2;
+        c->ligacoes = (Ligacao*) memRealocar(MEM_MAPA, c->ligacoes, c->capLigacoes * sizeof(Ligacao));
+        if (c->ligacoes == NULL) { printf("Erro: memoria insuficiente (saidas).\n"); exit(1); }
+    }
+    c->ligacoes[c->numLigacoes].origem = origem;
+    c->ligacoes[c->numLigacoes].destino = destino;
+    c->numLigacoes++;
+}
+
+// liga a sala 'origem' aos caminhos da esquerda e da direita (saidas 1 e 2; -1 = sem caminho)
+void ligarSalas(ConstrutorMansao *c, int32_t origem, int32_t esquerda, int32_t direita) {
+    adicionarSaida(c, origem, esquerda);
+    adicionarSaida(c, origem, direita);
+}
+
+// registra a associacao pista -> suspeito (com 'peso' pontos) que sera carregada na hash
+void associarPistaPeso(ConstrutorMansao *c, const char *pista, const char *suspeito, uint32_t peso) {
+    if (c->numAssociacoes == c->capAssociacoes) {
+        c->capAssociacoes *= 2;
+        c->associacoes = (Associacao*) memRealocar(MEM_MAPA, c->associacoes, c->capAssociacoes * sizeof(Associacao));
+        if (c->associacoes == NULL) { printf("Erro: memoria insuficiente (associacoes).\n"); exit(1); }
+    }
+    Associacao *a = &c->associacoes[c->numAssociacoes++];
+    a->pista = internar(&c->textos, pista, MAXPISTA);
+    a->suspeito = internar(&c->textos, suspeito, MAXNOME);
+    a->chave = internarChave(&c->textos, textoInterno(&c->textos, a->suspeito));
+    a->peso = peso;
+}
+
+// associacao com o peso de uma pista comum (1 ponto)
+void associarPista(ConstrutorMansao *c, const char *pista, const char *suspeito) {
+    associarPistaPeso(c, pista, suspeito, 1);
+}
+
+// aponta os campos da mansao para as secoes de uma imagem binaria
+// valida o cabecalho e os ids das associacoes (a carga em lote da hash indexa vetores com eles);
+// salas, saidas e textos das salas sao checados no acesso
+int abrirImagem(Mansao *m, const unsigned char *base, size_t tam) {
+    if (tam < sizeof(CabecalhoMansao)) return 0;
+    const CabecalhoMansao *cab = (const CabecalhoMansao*) base;
+    if (memcmp(cab->magica, MANSAO_MAGICA, 4) != 0 || cab->versao != MANSAO_VERSAO) return 0;
+    uint64_t esperado = sizeof(CabecalhoMansao)
+                      + (uint64_t) cab->numSalas * sizeof(Sala)
+                      + ((uint64_t) cab->numSalas + 1) * sizeof(uint32_t)
+                      + (uint64_t) cab->numSaidas * sizeof(int32_t)
+                      + (uint64_t) cab->numAssociacoes * sizeof(Associacao)
+                      + (uint64_t) cab->numTextos * sizeof(uint32_t)
+                      + cab->tamTextos;
+    if (esperado != tam || cab->numTextos == 0 || cab->tamTextos == 0 || cab->raiz >= cab->numSalas)
+        return 0;
+    m->numSalas = cab->numSalas;
+    m->raiz = (int32_t) cab->raiz;
+    m->numAssociacoes = cab->numAssociacoes;
+    m->limiar = cab->limiar;
+    m->salas = (const Sala*) (base + sizeof(CabecalhoMansao));
+    m->inicioSaidas = (const uint32_t*) (m->salas + cab->numSalas);
+    m->saidas = (const int32_t*) (m->inicioSaidas + cab->numSalas + 1);
+    m->numSaidas = cab->numSaidas;
+    if (m->inicioSaidas[0] != 0 || m->inicioSaidas[cab->numSalas] != cab->numSaidas) return 0;
+    m->associacoes = (const Associacao*) (m->saidas + cab->numSaidas);
+    const uint32_t *desloc = (const uint32_t*) (m->associacoes + cab->numAssociacoes);
+    const char *textos = (const char*) (desloc + cab->numTextos);
+    if (textos[cab->tamTextos - 1] != '\0' || desloc[TEXTO_VAZIO] >= cab->tamTextos
+        || textos[desloc[TEXTO_VAZIO]] != '\0')
+        return 0;
+    for (uint32_t i = 0; i < cab->numAssociacoes; ++i) {
+        const Associacao *x = &m->associacoes[i];
+        if (x->pista >= cab->numTextos || x->suspeito >= cab->numTextos || x->chave >= cab->numTextos)
+            return 0;
+    }
+    abrirInternosBase(&m->textos, desloc, textos, cab->numTextos, cab->tamTextos);
+    return 1;
+}
+
+// finalizarMansao() – serializa o construtor numa imagem contigua e abre a mansao sobre ela
+// o construtor e liberado
+void finalizarMansao(ConstrutorMansao *c, int32_t raiz, Mansao *m) {
+    uint32_t numTextos = totalInternos(&c->textos);
+    size_t tamTextos = 0;
+    for (uint32_t id = 0; id < numTextos; ++id)
+        tamTextos += strlen(textoInterno(&c->textos, id)) + 1;
+    size_t tam = sizeof(CabecalhoMansao) + c->numSalas * sizeof(Sala)
+               + ((size_t) c->numSalas + 1) * sizeof(uint32_t) + c->numLigacoes * sizeof(int32_t)
+               + c->numAssociacoes * sizeof(Associacao)
+               + numTextos * sizeof(uint32_t) + tamTextos;
+    unsigned char *img = (unsigned char*) memAlocar(MEM_MAPA, tam);
+    if (img == NULL) { printf("Erro: memoria insuficiente (mansao).\n"); exit(1); }
+    CabecalhoMansao cab;
+    memset(&cab, 0, sizeof cab);
+    memcpy(cab.magica, MANSAO_MAGICA, 4);
+    cab.versao = MANSAO_VERSAO;
+    cab.numSalas = c->numSalas;
+    cab.raiz = (uint32_t) raiz;
+    cab.numAssociacoes = c->numAssociacoes;
+    cab.numTextos = numTextos;
+    cab.tamTextos = (uint32_t) tamTextos;
+    cab.numSaidas = c->numLigacoes;
+    cab.limiar = c->limiar;
+    unsigned char *p = img;
+    memcpy(p, &cab, sizeof cab);                                   p += sizeof cab;
+    memcpy(p, c->salas, c->numSalas * sizeof(Sala));               p += c->numSalas * sizeof(Sala);
+
+    // CSR: contagem por sala, soma de prefixos e distribuicao estavel (mantem a ordem declarada)
+    uint32_t *inicio = (uint32_t*) p;
+    int32_t *saidas = (int32_t*) (inicio + c->numSalas + 1);
+    memset(inicio, 0, ((size_t) c->numSalas + 1) * sizeof(uint32_t));
+    for (uint32_t k = 0; k < c->numLigacoes; ++k) inicio[c->ligacoes[k].origem + 1]++;
+    for (uint32_t i = 0; i < c->numSalas; ++i) inicio[i + 1] += inicio[i];
+    for (uint32_t k = 0; k < c->numLigacoes; ++k) {
+        const Ligacao *l = &c->ligacoes[k];
+        saidas[inicio[l->origem]++] = l->destino;
+    }
+    for (uint32_t i = c->numSalas; i > 0; --i) inicio[i] = inicio[i - 1]; // volta ao inicio de cada sala
+    inicio[0] = 0;
+    p = (unsigned char*) (saidas + c->numLigacoes);
+    memcpy(p, c->associacoes, c->numAssociacoes * sizeof(Associacao)); p += c->numAssociacoes * sizeof(Associacao);
+    uint32_t *desloc = (uint32_t*) p;
+    char *textos = (char*) (desloc + numTextos);
+    uint32_t off = 0;
+    for (uint32_t id = 0; id < numTextos; ++id) {
+        const char *t = textoInterno(&c->textos, id);
+        size_t n = strlen(t) + 1;
+        desloc[id] = off;
+        memcpy(textos + off, t, n);
+        off += (uint32_t) n;
+    }
+    descartarConstrutor(c);
+
+    memset(m, 0, sizeof *m);
+    m->imagem = img;
+    m->tamImagem = tam;
+    if (!abrirImagem(m, img, tam)) {
+        printf("Erro: mansao invalida (sala inicial inexistente).\n");
+        exit(1);
+    }
+}
+
+// importa uma mansao no formato texto:
+//   mansao <numSalas> <raiz>
+//   sala <indice> <pista|-> <nome da sala>
+//   ligar <indice> <esquerda|-> <direita|->
+//   saidas <indice> <destino|-> [<destino|-> ...]   (acrescenta saidas; qualquer numero delas)
+//   corredor <a> <b>                                 (passagem nos dois sentidos: a -> b e b -> a)
+//   suspeito <pista> <nome do suspeito>              (a pista soma 1 ponto contra o suspeito)
+//   implica <pista> <peso> <nome do suspeito>         (soma 'peso' pontos; a mesma pista pode
+//                                                      implicar varios suspeitos)
+//   limiar <pontos>                                  (pontos para condenar neste mapa)
+// linhas vazias ou iniciadas por '#' sao ignoradas; retorna 1 em caso de sucesso
+static int importarTexto(FILE *f, Mansao *m) {
+    char linha[512], cmd[16], a[MAXPISTA], b[MAXPISTA];
+    ConstrutorMansao c;
+    int iniciado = 0, nLinha = 0;
+    long raiz = 0;
+    while (fgets(linha, sizeof linha, f) != NULL) {
+        nLinha++;
+        linha[strcspn(linha, "\r\n")] = '\0';
+        int pos = 0;
+        if (sscanf(linha, " %15s%n", cmd, &pos) != 1 || cmd[0] == '#') continue;
+        char *resto = linha + pos;
+        int ok = 0;
+        if (strcmp(cmd, "mansao") == 0 && !iniciado) {
+            unsigned long n;
+            if (sscanf(resto, "%lu %ld", &n, &raiz) == 2 && n > 0 && n < UINT32_MAX) {
+                inicializarConstrutor(&c, (uint32_t) n);
+                iniciado = ok = 1;
+            }
+        } else if (!iniciado) {
+            ok = 0;
+        } else if (strcmp(cmd, "sala") == 0) {
+            long i; int p2 = 0;
+            if (sscanf(resto, "%ld %127s %n", &i, a, &p2) == 2 && i >= 0 && i < (long) c.numSalas) {
+                definirSala(&c, (int32_t) i, resto + p2, strcmp(a, "-") == 0 ? "" : a);
+                ok = 1;
+            }
+        } else if (strcmp(cmd, "ligar") == 0) {
+            long i, e = -1, d = -1;
+            if (sscanf(resto, "%ld %127s %127s", &i, a, b) == 3 && i >= 0 && i < (long) c.numSalas) {
+                if (strcmp(a, "-") != 0) e = strtol(a, NULL, 10);
+                if (strcmp(b, "-") != 0) d = strtol(b, NULL, 10);
+                ok = (e >= -1 && e < (long) c.numSalas && d >= -1 && d < (long) c.numSalas);
+                if (ok) ligarSalas(&c, (int32_t) i, (int32_t) e, (int32_t) d);
+            }
+        } else if (strcmp(cmd, "saidas") == 0) {
+            long i;
+            int p2 = 0;
+            if (sscanf(resto, "%ld %n", &i, &p2) == 1 && i >= 0 && i < (long) c.numSalas) {
+                char *q = resto + p2, *fim;
+                ok = 1;
+                while (ok && *q != '\0') {
+                    long d = -1;
+                    if (*q == '-') fim = q + 1;
+                    else d = strtol(q, &fim, 10);
+                    ok = fim != q && (*fim == '\0' || *fim == ' ' || *fim == '\t')
+                         && d >= -1 && d < (long) c.numSalas;
+                    if (ok) adicionarSaida(&c, (int32_t) i, (int32_t) d);
+                    q = fim + strspn(fim, " \t");
+                }
+            }
+        } else if (strcmp(cmd, "corredor") == 0) {
+            long x, y;
+            if (sscanf(resto, "%ld %ld", &x, &y) == 2 && x >= 0 && x < (long) c.numSalas
+                && y >= 0 && y < (long) c.numSalas) {
+                adicionarSaida(&c, (int32_t) x, (int32_t) y);
+                adicionarSaida(&c, (int32_t) y, (int32_t) x);
+                ok = 1;
+            }
+        } else if (strcmp(cmd, "suspeito") == 0) {
+            int p2 = 0;
+            if (sscanf(resto, "%127s %n", a, &p2) == 1 && resto[p2] != '\0') {
+                associarPista(&c, a, resto + p2);
+                ok = 1;
+            }
+        } else if (strcmp(cmd, "implica") == 0) {
+            unsigned long peso;
+            int p2 = 0;
+            if (sscanf(resto, "%127s %lu %n", a, &peso, &p2) == 2 && p2 > 0 && resto[p2] != '\0'
+                && peso > 0 && peso <= UINT16_MAX) {
+                associarPistaPeso(&c, a, resto + p2, (uint32_t) peso);
+                ok = 1;
+            }
+        } else if (strcmp(cmd, "limiar") == 0) {
+            unsigned long l;
+            if (sscanf(resto, "%lu", &l) == 1 && l > 0 && l < UINT32_MAX) {
+                c.limiar = (uint32_t) l;
+                ok = 1;
+            }
+        }
+        if (!ok) {
+            printf("Erro: linha %d invalida no mapa: %s\n", nLinha, linha);
+            if (iniciado) descartarConstrutor(&c);
+            return 0;
+        }
+    }
+    if (!iniciado || raiz < 0 || raiz >= (long) c.numSalas) {
+        printf("Erro: mapa sem cabecalho 'mansao' valido.\n");
+        if (iniciado) descartarConstrutor(&c);
+        return 0;
+    }
+    finalizarMansao(&c, (int32_t) raiz, m);
+    return 1;
+}
+
+// carregarMansao() – abre um mapa binario (via mmap, sem parsing) ou importa um mapa texto
+// retorna 1 em caso de sucesso
+int carregarMansao(const char *caminho, Mansao *m) {
+    memset(m, 0, sizeof *m);
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) { printf("Erro: nao foi possivel abrir o mapa '%s'.\n", caminho); return 0; }
+    struct stat st;
+    char magica[4] = {0};
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t) sizeof(CabecalhoMansao)
+        && pread(fd, magica, 4, 0) == 4 && memcmp(magica, MANSAO_MAGICA, 4) == 0) {
+        void *mapa = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapa == MAP_FAILED) { printf("Erro: falha ao mapear '%s'.\n", caminho); return 0; }
+        if (!abrirImagem(m, (const unsigned char*) mapa, (size_t) st.st_size)) {
+            printf("Erro: mapa binario '%s' corrompido ou de outra versao.\n", caminho);
+            munmap(mapa, (size_t) st.st_size);
+            return 0;
+        }
+        m->mapeada = mapa;
+        m->tamImagem = (size_t) st.st_size;
+        return 1;
+    }
+    FILE *f = fdopen(fd, "r");
+    if (f == NULL) { close(fd); return 0; }
+    int ok = importarTexto(f, m);
+    fclose(f);
+    return ok;
+}
+
+// libera a imagem da mansao (malloc ou mmap)
+void liberarMansao(Mansao *m) {
+    liberarInternos(&m->textos);
+    if (m->mapeada != NULL) munmap(m->mapeada, m->tamImagem);
+    memLiberar(m->imagem);
+    memset(m, 0, sizeof *m);
+}
+
+// compilarMansao() – converte um mapa texto para o formato binario
+// a imagem e gravada num arquivo temporario e renomeada ao final
+int compilarMansao(const char *entrada, const char *saida) {
+    Mansao m;
+    if (!carregarMansao(entrada, &m)) return 0;
+    const void *img = m.imagem != NULL ? (const void*) m.imagem : m.mapeada;
+    char tmp[4096];
+    snprintf(tmp, sizeof tmp, "%s.tmp", saida);
+    FILE *f = fopen(tmp, "wb");
+    int ok = f != NULL && fwrite(img, 1, m.tamImagem, f) == m.tamImagem;
+    if (f != NULL && fclose(f) != 0) ok = 0;
+    if (ok && rename(tmp, saida) != 0) ok = 0;
+    if (!ok) { printf("Erro: falha ao gravar '%s'.\n", saida); remove(tmp); }
+    liberarMansao(&m);
+    return ok;
+}
+
+
+// =========================
+// GERADOR DE MANSOES
+// =========================
+
+
+const char *NOMES_DISTRIBUICAO[NUM_DISTRIBUICOES] = { "aleatorio", "ordenado", "colidindo", "longo" };
+static const char *NOMES_FORMA[NUM_FORMAS] = { "balanceada", "degenerada", "grafo" };
+
+static const char *COMODOS_GERADOS[] = {
+    "Hall", "Sala de Estar", "Cozinha", "Biblioteca", "Jardim", "Porao", "Quarto", "Escritorio",
+    "Adega", "Sotao", "Capela", "Galeria", "Estufa", "Salao de Baile", "Corredor", "Despensa"
+};
+static const char *ALAS_GERADAS[] = {
+    "Norte", "Sul", "Leste", "Oeste", "Central", "Superior", "Inferior", "dos Fundos"
+};
+static const char *TITULOS_GERADOS[] = { "Sr.", "Sra.", "Dr.", "Dra." };
+static const char *SOBRENOMES_GERADOS[] = {
+    "Silva", "Almeida", "Costa", "Oliveira", "Souza", "Pereira", "Lima", "Carvalho",
+    "Ribeiro", "Martins", "Rocha", "Barros", "Freitas", "Moura", "Teixeira", "Cardoso"
+};
+
+// escreve 'v' com exatamente 'digitos' algarismos na 'base' (10 ou 16) em 'k'
+static inline void escreverFixo(char *k, uint64_t v, int digitos, unsigned base) {
+    for (int d = digitos - 1; d >= 0; --d, v /= base) k[d] = "0123456789abcdef"[v % base];
+}
+
+// chaveDistribuicao() – i-esima chave da distribuicao em 'k' (MAXPISTA bytes)
+//   aleatorio: identificadores pseudoaleatorios derivados de 'semente'
+//   ordenado:  pista_0000000000, pista_0000000001, ... (pior caso de uma BST sem balanceamento)
+//   colidindo: concatenacoes de 'bits' pares "Ez"/"FY", que tem o mesmo djb2 (o hash antigo punha
+//              todas no mesmo bucket; com o hash com semente devem se espalhar como as demais)
+//   longo:     chaves com MAXPISTA-1 caracteres que so diferem no final
+// indices distintos (ate 2^bits em 'colidindo') dao chaves distintas e de mesmo tamanho
+void chaveDistribuicao(DistribuicaoChaves d, uint64_t i, unsigned bits, uint64_t semente, char *k) {
+    switch (d) {
+    case CHAVES_ALEATORIAS:
+        memcpy(k, "pista_", 6);
+        escreverFixo(k + 6, sorteioGerador(semente, i, 0), 16, 16);
+        k[22] = '\0';
+        break;
+    case CHAVES_ORDENADAS:
+        memcpy(k, "pista_", 6);
+        escreverFixo(k + 6, i % 10000000000ull, 10, 10);
+        k[16] = '\0';
+        break;
+    case CHAVES_COLIDINDO:
+        for (unsigned b = 0; b < bits; ++b) memcpy(k + 2 * b, ((i >> b) & 1) ? "FY" : "Ez", 2);
+        k[2 * bits] = '\0';
+        break;
+    default:
+        memset(k, 'x', MAXPISTA - 11);
+        escreverFixo(k + MAXPISTA - 11, i % 10000000000ull, 10, 10);
+        k[MAXPISTA - 1] = '\0';
+    }
+}
+
+// le um inteiro sem sinal de 'txt' em [min, max]; retorna 1 em caso de sucesso
+int lerLimitado(const char *txt, unsigned long long min, unsigned long long max, uint64_t *v) {
+    char *fim;
+    if (*txt < '0' || *txt > '9') return 0;
+    unsigned long long x = strtoull(txt, &fim, 10);
+    if (*fim != '\0' || x < min || x > max) return 0;
+    *v = x;
+    return 1;
+}
+
+// lerParamGeracao() – interpreta "<forma>:<salas>[:chave=valor...]", p.ex.
+//   grafo:1000000:semente=7:grau=8:pistas=5000:nomes=colidindo:suspeitos=64
+// chaves: semente, grau (2..64), densidade (% de salas com pista), pistas, nomes (aleatorio,
+// ordenado, colidindo, longo), suspeitos, implicados (suspeitos por pista) e limiar
+// retorna 1 em caso de sucesso; em caso de erro explica o motivo e retorna 0
+int lerParamGeracao(const char *spec, ParamGeracao *g) {
+    char buf[512];
+    snprintf(buf, sizeof buf, "%s", spec);
+    memset(g, 0, sizeof *g);
+    g->semente = 1;
+    g->grau = 4;
+    g->densidade = 50;
+    g->numSuspeitos = 16;
+    g->implicados = 2;
+    g->nomes = CHAVES_ALEATORIAS;
+    int forma = -1, comPistas = 0;
+    char *campo = strtok(buf, ":");
+    for (int k = 0; campo != NULL && k < NUM_FORMAS; ++k)
+        if (strcmp(campo, NOMES_FORMA[k]) == 0) forma = k;
+    if (forma < 0) {
+        printf("Erro: forma de mansao invalida em '%s' (use balanceada, degenerada ou grafo).\n", spec);
+        return 0;
+    }
+    g->forma = (FormaMansao) forma;
+    uint64_t v;
+    campo = strtok(NULL, ":");
+    if (campo == NULL || !lerLimitado(campo, 1, INT32_MAX, &v)) {
+        printf("Erro: numero de salas invalido em '%s' (1 a %d).\n", spec, INT32_MAX);
+        return 0;
+    }
+    g->numSalas = (uint32_t) v;
+    const struct { const char *chave; uint64_t min, max; uint32_t *destino; } numericos[] = {
+        { "grau", 2, 64, &g->grau },
+        { "densidade", 0, 100, &g->densidade },
+        { "pistas", 0, INT32_MAX, &g->numPistas },
+        { "suspeitos", 1, 1u << 24, &g->numSuspeitos },
+        { "implicados", 1, 64, &g->implicados },
+        { "limiar", 1, UINT32_MAX - 1, &g->limiar },
+    };
+    while ((campo = strtok(NULL, ":")) != NULL) {
+        char *igual = strchr(campo, '=');
+        int ok = 0;
+        if (igual != NULL) {
+            *igual = '\0';
+            const char *valor = igual + 1;
+            if (strcmp(campo, "semente") == 0) ok = lerLimitado(valor, 0, UINT64_MAX, &g->semente);
+            for (int k = 0; strcmp(campo, "nomes") == 0 && k < NUM_DISTRIBUICOES; ++k)
+                if (strcmp(valor, NOMES_DISTRIBUICAO[k]) == 0) { g->nomes = (DistribuicaoChaves) k; ok = 1; }
+            for (size_t k = 0; k < sizeof numericos / sizeof numericos[0]; ++k)
+                if (strcmp(campo, numericos[k].chave) == 0 && lerLimitado(valor, numericos[k].min, numericos[k].max, &v)) {
+                    *numericos[k].destino = (uint32_t) v;
+                    ok = 1;
+                }
+            if (strcmp(campo, "pistas") == 0) comPistas = 1;
+        }
+        if (!ok) {
+            printf("Erro: parametro invalido '%s' na especificacao do gerador.\n", campo);
+            return 0;
+        }
+    }
+    // padrao: uma pista distinta para cada duas salas, ate 2^24
+    if (!comPistas) g->numPistas = g->numSalas / 2 > (1u << 24) ? (1u << 24) : (g->numSalas + 1) / 2;
+    if (g->implicados > g->numSuspeitos) g->implicados = g->numSuspeitos;
+    return 1;
+}
+
+// numero de saidas da sala 'i' (so depende da forma e do indice)
+static inline uint32_t numSaidasGerada(const ParamGeracao *g, uint32_t i) {
+    uint64_t n = g->numSalas;
+    switch (g->forma) {
+    case FORMA_BALANCEADA: return 2 * (uint64_t) i + 1 < n ? 2 : 0;
+    case FORMA_DEGENERADA: return (uint64_t) i + 1 < n ? 2 : 0;
+    default: {
+        uint64_t a = g->grau - 1, primeiro = a * i + 1;
+        uint64_t filhos = primeiro >= n ? 0 : (n - primeiro < a ? n - primeiro : a);
+        return (uint32_t) filhos + 1;
+    }
+    }
+}
+
+// saidasGeradas() – escreve em 'out' as saidas da sala 'i' e retorna quantas sao
+// balanceada: filhos 2i+1 e 2i+2; degenerada: a sala seguinte a esquerda ou a direita (-1 do
+// outro lado); grafo: os filhos da arvore de aridade grau-1 (garantem que tudo e alcancavel a
+// partir da sala 0) e um atalho para qualquer sala (ciclos, salas com varias entradas)
+static uint32_t saidasGeradas(const ParamGeracao *g, uint32_t i, int32_t *out) {
+    uint32_t k = numSaidasGerada(g, i);
+    if (k == 0) return 0;
+    if (g->forma == FORMA_BALANCEADA) {
+        out[0] = (int32_t) (2 * i + 1);
+        out[1] = 2 * (uint64_t) i + 2 < g->numSalas ? (int32_t) (2 * i + 2) : -1;
+    } else if (g->forma == FORMA_DEGENERADA) {
+        uint32_t lado = (uint32_t) (sorteioGerador(g->semente, i, 1) & 1);
+        out[lado] = (int32_t) (i + 1);
+        out[1 - lado] = -1;
+    } else {
+        uint64_t primeiro = (uint64_t) (g->grau - 1) * i + 1;
+        for (uint32_t f = 0; f + 1 < k; ++f) out[f] = (int32_t) (primeiro + f);
+        uint64_t r = sorteioGerador(g->semente, i, 2);
+        uint32_t pos = (uint32_t) r % k;
+        out[k - 1] = (int32_t) sorteioAte(r, g->numSalas);
+        int32_t t = out[pos];
+        out[pos] = out[k - 1];
+        out[k - 1] = t;
+    }
+    return k;
+}
+
+// sala 'i': nome sorteado entre os comodos e, com probabilidade 'densidade'%, uma pista
+// (na distribuicao 'ordenado' as pistas crescem com o indice da sala, que e a ordem em largura)
+static inline Sala salaGerada(const ParamGeracao *g, const PreparoGeracao *pg, uint32_t i) {
+    Sala s;
+    uint64_t r = sorteioGerador(g->semente, i, 3);
+    s.nome = pg->comodos[sorteioAte(r, pg->numComodos)];
+    s.pista = TEXTO_VAZIO;
+    if (g->numPistas > 0 && (uint32_t) r % 100 < g->densidade) {
+        uint64_t j = g->nomes == CHAVES_ORDENADAS ? (uint64_t) i * g->numPistas / g->numSalas
+                                                   : sorteioAte(sorteioGerador(g->semente, i, 5), g->numPistas);
+        s.pista = pg->basePistas + (uint32_t) j;
+    }
+    return s;
+}
+
+static void* alocarGerador(size_t n, size_t tam) {
+    void *p = memAlocar(MEM_MAPA, (n ? n : 1) * tam);
+    if (p == NULL) { printf("Erro: memoria insuficiente (gerador de mansoes).\n"); exit(1); }
+    return p;
+}
+
+static void liberarPreparo(PreparoGeracao *pg) {
+    liberarInternos(&pg->textos);
+    memLiberar(pg->comodos);
+    memLiberar(pg->suspeitos);
+    memLiberar(pg->chaves);
+    memset(pg, 0, sizeof *pg);
+}
+
+// numero de suspeitos que a pista 'j' implica (1 a 'implicados')
+static inline uint32_t numImplicados(const ParamGeracao *g, uint32_t j) {
+    return 1 + (uint32_t) (sorteioGerador(g->semente, j, 6) % g->implicados);
+}
+
+// t-esima associacao da pista 'j': suspeitos consecutivos a partir de um sorteado (distintos),
+// peso 1 a 3
+static inline Associacao associacaoGerada(const ParamGeracao *g, const PreparoGeracao *pg, uint32_t j, uint32_t t) {
+    uint64_t r = sorteioGerador(g->semente, j, 6);
+    uint32_t s = (uint32_t) (((r >> 32) % g->numSuspeitos + t) % g->numSuspeitos);
+    Associacao a;
+    a.pista = pg->basePistas + j;
+    a.suspeito = pg->suspeitos[s];
+    a.chave = pg->chaves[s];
+    a.peso = 1 + (uint32_t) (sorteioGerador(g->semente, j, 7 + t) % 3);
+    return a;
+}
+
+// prepararGeracao() – interna os nomes de comodos e suspeitos e calcula o cabecalho e o tamanho
+// da imagem; pistas e associacoes so sao contadas. Custo O(salas + pistas) sem memoria por
+// sala ou por pista. Retorna 0 se a imagem nao couber no formato
+static int prepararGeracao(const ParamGeracao *g, PreparoGeracao *pg) {
+    memset(pg, 0, sizeof *pg);
+    inicializarInternos(&pg->textos);
+    char nome[MAXPISTA];
+    size_t numTipos = sizeof COMODOS_GERADOS / sizeof COMODOS_GERADOS[0];
+    size_t numAlas = sizeof ALAS_GERADAS / sizeof ALAS_GERADAS[0];
+    pg->numComodos = (uint32_t) (numTipos * numAlas);
+    pg->comodos = (uint32_t*) alocarGerador(pg->numComodos, sizeof(uint32_t));
+    for (uint32_t c = 0; c < pg->numComodos; ++c) {
+        snprintf(nome, sizeof nome, "%s (ala %s)", COMODOS_GERADOS[c % numTipos], ALAS_GERADAS[c / numTipos]);
+        pg->comodos[c] = internar(&pg->textos, nome, MAXNOME);
+    }
+
+    // suspeitos: titulo e sobrenome, com um numero quando os nomes simples acabam
+    pg->suspeitos = (uint32_t*) alocarGerador(g->numSuspeitos, sizeof(uint32_t));
+    pg->chaves = (uint32_t*) alocarGerador(g->numSuspeitos, sizeof(uint32_t));
+    const uint32_t simples = 4 * 16;
+    for (uint32_t s = 0; s < g->numSuspeitos; ++s) {
+        int n = snprintf(nome, sizeof nome, "%s %s", TITULOS_GERADOS[s % 4], SOBRENOMES_GERADOS[(s / 4) % 16]);
+        if (s >= simples) snprintf(nome + n, sizeof nome - (size_t) n, " %u", s / simples);
+        pg->suspeitos[s] = internar(&pg->textos, nome, MAXNOME);
+        pg->chaves[s] = internarChave(&pg->textos, nome);
+    }
+
+    // pistas: nunca coincidem com nomes de comodos ou suspeitos (que tem espacos)
+    pg->bits = 1;
+    while (pg->bits < 32 && ((uint64_t) 1 << pg->bits) < g->numPistas) pg->bits++;
+    chaveDistribuicao(g->nomes, 0, pg->bits, g->semente, nome);
+    pg->tamPista = (uint32_t) strlen(nome);
+    pg->basePistas = totalInternos(&pg->textos);
+
+    uint64_t numAssoc = 0, numSaidas = 0, tamTextos = 0;
+    for (uint32_t j = 0; j < g->numPistas; ++j) numAssoc += numImplicados(g, j);
+    for (uint32_t i = 0; i < g->numSalas; ++i) numSaidas += numSaidasGerada(g, i);
+    for (uint32_t id = 0; id < pg->basePistas; ++id) tamTextos += strlen(textoInterno(&pg->textos, id)) + 1;
+    tamTextos += (uint64_t) g->numPistas * (pg->tamPista + 1);
+    uint64_t numTextos = (uint64_t) pg->basePistas + g->numPistas;
+    if (numAssoc >= UINT32_MAX || numSaidas >= UINT32_MAX || tamTextos >= UINT32_MAX || numTextos >= UINT32_MAX)
+        return 0;
+
+    CabecalhoMansao *cab = &pg->cab;
+    memcpy(cab->magica, MANSAO_MAGICA, 4);
+    cab->versao = MANSAO_VERSAO;
+    cab->numSalas = g->numSalas;
+    cab->raiz = 0;
+    cab->numAssociacoes = (uint32_t) numAssoc;
+    cab->numTextos = (uint32_t) numTextos;
+    cab->tamTextos = (uint32_t) tamTextos;
+    cab->numSaidas = (uint32_t) numSaidas;
+    cab->limiar = g->limiar;
+    pg->tamanho = sizeof(CabecalhoMansao) + (size_t) g->numSalas * sizeof(Sala)
+                + ((size_t) g->numSalas + 1) * sizeof(uint32_t) + (size_t) numSaidas * sizeof(int32_t)
+                + (size_t) numAssoc * sizeof(Associacao) + (size_t) numTextos * sizeof(uint32_t) + tamTextos;
+    return 1;
+}
+
+// copia 'n' bytes para o destino (memoria ou arquivo)
+static void emitirImagem(DestinoImagem *d, const void *p, size_t n) {
+    if (d->memoria != NULL) memcpy(d->memoria + d->pos, p, n);
+    else if (!d->erro && fwrite(p, 1, n, d->arquivo) != n) d->erro = 1;
+    d->pos += n;
+}
+
+// escreverGeracao() – escreve a imagem na ordem do formato binario; as salas sao refeitas
+// em tres passadas (registros, inicio das saidas, saidas) e emitidas em lotes de uma pagina
+static void escreverGeracao(const ParamGeracao *g, const PreparoGeracao *pg, DestinoImagem *d) {
+    enum { LOTE = 4096 };
+    const uint32_t n = g->numSalas;
+    emitirImagem(d, &pg->cab, sizeof pg->cab);
+
+    Sala salas[LOTE / sizeof(Sala)];
+    for (uint32_t i = 0; i < n; ) {
+        uint32_t k = 0;
+        for (; k < LOTE / sizeof(Sala) && i < n; ++k, ++i) salas[k] = salaGerada(g, pg, i);
+        emitirImagem(d, salas, k * sizeof(Sala));
+    }
+
+    uint32_t inicio[LOTE / sizeof(uint32_t)], acumulado = 0;
+    for (uint64_t i = 0; i <= n; ) {
+        uint32_t k = 0;
+        for (; k < LOTE / sizeof(uint32_t) && i <= n; ++k, ++i) {
+            inicio[k] = acumulado;
+            if (i < n) acumulado += numSaidasGerada(g, (uint32_t) i);
+        }
+        emitirImagem(d, inicio, k * sizeof(uint32_t));
+    }
+
+    int32_t saidas[LOTE / sizeof(int32_t) + 64];
+    uint32_t k = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        k += saidasGeradas(g, i, saidas + k);
+        if (k >= LOTE / sizeof(int32_t)) { emitirImagem(d, saidas, k * sizeof(int32_t)); k = 0; }
+    }
+    emitirImagem(d, saidas, k * sizeof(int32_t));
+
+    Associacao assoc[LOTE / sizeof(Associacao) + 64];
+    k = 0;
+    for (uint32_t j = 0; j < g->numPistas; ++j) {
+        for (uint32_t t = 0, q = numImplicados(g, j); t < q; ++t) assoc[k++] = associacaoGerada(g, pg, j, t);
+        if (k >= LOTE / sizeof(Associacao)) { emitirImagem(d, assoc, k * sizeof(Associacao)); k = 0; }
+    }
+    emitirImagem(d, assoc, k * sizeof(Associacao));
+
+    // deslocamentos e textos: os da tabela e depois as pistas, todas com tamPista + 1 bytes
+    uint32_t off = 0;
+    for (uint32_t id = 0; id < pg->basePistas; ++id) {
+        emitirImagem(d, &off, sizeof off);
+        off += (uint32_t) strlen(textoInterno(&pg->textos, id)) + 1;
+    }
+    for (uint32_t j = 0; j < g->numPistas; ) {
+        for (k = 0; k < LOTE / sizeof(uint32_t) && j < g->numPistas; ++k, ++j, off += pg->tamPista + 1)
+            inicio[k] = off;
+        emitirImagem(d, inicio, k * sizeof(uint32_t));
+    }
+    for (uint32_t id = 0; id < pg->basePistas; ++id) {
+        const char *t = textoInterno(&pg->textos, id);
+        emitirImagem(d, t, strlen(t) + 1);
+    }
+    char textos[LOTE + MAXPISTA];
+    size_t usado = 0;
+    for (uint32_t j = 0; j < g->numPistas; ++j) {
+        chaveDistribuicao(g->nomes, j, pg->bits, g->semente, textos + usado);
+        usado += pg->tamPista + 1;
+        if (usado >= LOTE) { emitirImagem(d, textos, usado); usado = 0; }
+    }
+    emitirImagem(d, textos, usado);
+}
+
+// gerarMansao() – monta a mansao descrita por 'g' diretamente numa imagem em memoria
+// (uma alocacao para a imagem inteira, nenhuma por sala)
+void gerarMansao(const ParamGeracao *g, Mansao *m) {
+    PreparoGeracao pg;
+    if (!prepararGeracao(g, &pg)) {
+        printf("Erro: mansao gerada grande demais para o formato binario.\n");
+        exit(1);
+    }
+    unsigned char *img = (unsigned char*) alocarGerador(pg.tamanho, 1);
+    DestinoImagem d = { img, NULL, 0, 0 };
+    escreverGeracao(g, &pg, &d);
+    size_t tam = pg.tamanho;
+    liberarPreparo(&pg);
+    memset(m, 0, sizeof *m);
+    m->imagem = img;
+    m->tamImagem = tam;
+    if (!abrirImagem(m, img, tam)) {
+        printf("Erro: imagem gerada invalida.\n");
+        exit(1);
+    }
+}
+
+// gerarMansaoArquivo() – grava a mansao descrita por 'g' no formato binario sem monta-la em
+// memoria ('-' = saida padrao); o arquivo e escrito num temporario e renomeado ao final
+int gerarMansaoArquivo(const ParamGeracao *g, const char *saida) {
+    PreparoGeracao pg;
+    if (!prepararGeracao(g, &pg)) {
+        printf("Erro: mansao gerada grande demais para o formato binario.\n");
+        liberarPreparo(&pg);
+        return 0;
+    }
+    int padrao = strcmp(saida, "-") == 0;
+    char tmp[4096];
+    snprintf(tmp, sizeof tmp, "%s.tmp", saida);
+    FILE *f = padrao ? stdout : fopen(tmp, "wb");
+    int ok = f != NULL;
+    if (ok) {
+        static char buffer[1 << 20];
+        setvbuf(f, buffer, _IOFBF, sizeof buffer);
+        DestinoImagem d = { NULL, f, 0, 0 };
+        escreverGeracao(g, &pg, &d);
+        ok = !d.erro && d.pos == pg.tamanho;
+        if (fflush(f) != 0) ok = 0;
+        if (!padrao && fclose(f) != 0) ok = 0;
+        if (ok && !padrao && rename(tmp, saida) != 0) ok = 0;
+    }
+    if (!ok) {
+        fprintf(stderr, "Erro: falha ao gravar '%s'.\n", saida);
+        if (!padrao) remove(tmp);
+    }
+    liberarPreparo(&pg);
+    return ok;
+}
+
+// =========================
+// ORDENACAO PARALELA
+// =========================
+
+
+static void* ordenarTrecho(void *arg) {
+    TarefaOrdenacao *t = (TarefaOrdenacao*) arg;
+    qsort_r(t->origem + t->ini * t->tam, t->fim - t->ini, t->tam, t->cmp, t->ctx);
+    return NULL;
+}
+
+// intercala os trechos ordenados [ini, meio) e [meio, fim) de 'origem' nas mesmas posicoes de 'destino'
+static void* intercalarTrechos(void *arg) {
+    TarefaOrdenacao *t = (TarefaOrdenacao*) arg;
+    const size_t tam = t->tam;
+    const unsigned char *a = t->origem + t->ini * tam, *fimA = t->origem + t->meio * tam;
+    const unsigned char *b = fimA, *fimB = t->origem + t->fim * tam;
+    unsigned char *d = t->destino + t->ini * tam;
+    while (a < fimA && b < fimB) {
+        if (t->cmp(b, a, t->ctx) < 0) { memcpy(d, b, tam); b += tam; }
+        else { memcpy(d, a, tam); a += tam; }
+        d += tam;
+    }
+    memcpy(d, a, (size_t) (fimA - a));
+    memcpy(d + (fimA - a), b, (size_t) (fimB - b));
+    return NULL;
+}
+
+// executa as tarefas, uma por thread (a chamadora fica com a primeira)
+static void executarTarefas(void* (*funcao)(void*), TarefaOrdenacao *tarefas, int n) {
+    pthread_t threads[ORDENACAO_MAX_THREADS];
+    int criadas[ORDENACAO_MAX_THREADS] = {0};
+    for (int i = 1; i < n; ++i)
+        criadas[i] = pthread_create(&threads[i], NULL, funcao, &tarefas[i]) == 0;
+    funcao(&tarefas[0]);
+    for (int i = 1; i < n; ++i) {
+        if (criadas[i]) pthread_join(threads[i], NULL);
+        else funcao(&tarefas[i]); // sem thread: executa aqui mesmo
+    }
+}
+
+// ordenarParalelo() – ordena 'n' itens de 'tam' bytes com 'cmp' (que recebe 'ctx'), como qsort_r.
+// Com mais de uma thread, cada uma ordena um trecho e os trechos sao intercalados dois a dois,
+// cada intercalacao da rodada na sua thread; usa um vetor auxiliar do tamanho da entrada.
+// Vetores pequenos sao ordenados na propria thread
+void ordenarParalelo(void *base, size_t n, size_t tam, ComparadorContexto cmp, void *ctx, int numThreads) {
+    if (numThreads > ORDENACAO_MAX_THREADS) numThreads = ORDENACAO_MAX_THREADS;
+    if (numThreads < 1 || n < ORDENACAO_MIN_PARALELO) numThreads = 1;
+    if (numThreads == 1) {
+        qsort_r(base, n, tam, cmp, ctx);
+        return;
+    }
+    unsigned char *aux = (unsigned char*) memAlocar(MEM_GERAL, n * tam);
+    if (aux == NULL) { printf("Erro: memoria insuficiente (ordenacao).\n"); exit(1); }
+    TarefaOrdenacao tarefas[ORDENACAO_MAX_THREADS];
+    size_t limites[ORDENACAO_MAX_THREADS + 1];
+    int trechos = numThreads;
+    for (int i = 0; i <= trechos; ++i) limites[i] = n * (size_t) i / (size_t) trechos;
+    for (int i = 0; i < trechos; ++i)
+        tarefas[i] = (TarefaOrdenacao) { (unsigned char*) base, NULL, limites[i], 0, limites[i + 1], tam, cmp, ctx };
+    executarTarefas(ordenarTrecho, tarefas, trechos);
+
+    unsigned char *origem = (unsigned char*) base, *destino = aux;
+    while (trechos > 1) {
+        int pares = (trechos + 1) / 2;
+        for (int i = 0; i < pares; ++i) {
+            size_t ini = limites[2 * i], fim = limites[2 * i + 2 <= trechos ? 2 * i + 2 : trechos];
+            size_t meio = 2 * i + 1 <= trechos ? limites[2 * i + 1] : fim;
+            tarefas[i] = (TarefaOrdenacao) { origem, destino, ini, meio, fim, tam, cmp, ctx };
+        }
+        executarTarefas(intercalarTrechos, tarefas, pares);
+        for (int i = 0; i <= pares; ++i) limites[i] = limites[2 * i <= trechos ? 2 * i : trechos];
+        trechos = pares;
+        unsigned char *t = origem; origem = destino; destino = t;
+    }
+    if (origem != (unsigned char*) base) memcpy(base, origem, n * tam);
+    memLiberar(aux);
+}
+
+// =========================
+// FUNCOES PARA ARVORE AVL DE PISTAS
+// =========================
+
+
+static int alturaNo(const PistaNode *n) {
+    return n != NULL ? n->altura : 0;
+}
+
+static void atualizarAltura(PistaNode *n) {
+    int he = alturaNo(n->esquerda), hd = alturaNo(n->direita);
+    n->altura = 1 + (he > hd ? he : hd);
+}
+
+static PistaNode* rotacionarDireita(PistaNode *y) {
+    PistaNode *x = y->esquerda;
+    y->esquerda = x->direita;
+    x->direita = y;
+    atualizarAltura(y);
+    atualizarAltura(x);
+    return x;
+}
+
+static PistaNode* rotacionarEsquerda(PistaNode *x) {
+    PistaNode *y = x->direita;
+    x->direita = y->esquerda;
+    y->esquerda = x;
+    atualizarAltura(x);
+    atualizarAltura(y);
+    return y;
+}
+
+// restaura o balanceamento AVL de um no e devolve a nova raiz da subarvore
+static PistaNode* balancear(PistaNode *n) {
+    atualizarAltura(n);
+    int fator = alturaNo(n->esquerda) - alturaNo(n->direita);
+    if (fator > 1) {
+        if (alturaNo(n->esquerda->esquerda) < alturaNo(n->esquerda->direita))
+            n->esquerda = rotacionarEsquerda(n->esquerda);
+        return rotacionarDireita(n);
+    }
+    if (fator < -1) {
+        if (alturaNo(n->direita->direita) < alturaNo(n->direita->esquerda))
+            n->direita = rotacionarDireita(n->direita);
+        return rotacionarEsquerda(n);
+    }
+    return n;
+}
+
+// estrategia de alocacao dos nos das colecoes criadas a partir de agora (--alocador)
+ModoAlocador modoAlocadorPistas = ALOCADOR_ARENA;
+
+// inicializa a colecao de pistas vazia; os ids sao resolvidos em 'textos'
+void inicializarPistas(ArvorePistas *arv, InternPool *textos) {
+    arv->raiz = NULL;
+    arv->total = 0;
+    arv->textos = textos;
+    inicializarAlocadorObjetos(&arv->nos, modoAlocadorPistas, sizeof(PistaNode), MEM_PISTAS);
+}
+
+// inserirPistaId() – insere o id da pista coletada na AVL (ignora duplicatas e pistas vazias)
+// a ordem e alfabetica pelo texto; a deteccao de duplicata e uma comparacao de ids
+// retorna 1 se a pista foi inserida e 0 caso contrario
+int inserirPistaId(ArvorePistas *arv, uint32_t pista) {
+    if (pista == TEXTO_VAZIO) return 0; // ignora
+    const char *texto = textoInterno(arv->textos, pista);
+    PistaNode **caminho[ALTURA_MAX_AVL];
+    int prof = 0;
+    PistaNode **p = &arv->raiz;
+    while (*p != NULL) {
+        if ((*p)->pista == pista) { // se igual, nao insere duplicata
+            INSTR_VALOR(MED_PROFUNDIDADE_AVL, prof);
+            return 0;
+        }
+        int cmp = strcmp(texto, textoInterno(arv->textos, (*p)->pista));
+        caminho[prof++] = p;
+        p = (cmp < 0) ? &(*p)->esquerda : &(*p)->direita;
+    }
+    INSTR_VALOR(MED_PROFUNDIDADE_AVL, prof);
+
+    PistaNode *novo = (PistaNode*) alocarObjeto(&arv->nos);
+    novo->pista = pista;
+    novo->esquerda = novo->direita = NULL;
+    novo->altura = 1;
+    *p = novo;
+    arv->total++;
+
+    // sobe pelo caminho rebalanceando; para quando a altura deixa de mudar
+    while (prof > 0) {
+        PistaNode **q = caminho[--prof];
+        int alturaAntes = (*q)->altura;
+        *q = balancear(*q);
+        if ((*q)->altura == alturaAntes) break;
+    }
+    return 1;
+}
+
+// inserirPista() – versao por texto: interna a pista e insere seu id
+int inserirPista(ArvorePistas *arv, const char *pista) {
+    if (pista == NULL || pista[0] == '\0') return 0; // ignora
+    return inserirPistaId(arv, internar(arv->textos, pista, MAXPISTA));
+}
+
+// abrirCursor() – posiciona o cursor na primeira pista >= 'de' (NULL = a menor de todas);
+// o cursor para depois da ultima pista <= 'ate' (NULL = ate o fim)
+void abrirCursor(CursorPistas *c, const ArvorePistas *arv, const char *de, const char *ate) {
+    c->arv = arv;
+    c->topo = 0;
+    c->ate = ate;
+    c->prefixo = NULL;
+    c->tamPrefixo = 0;
+    c->lidas = 0;
+    // a pilha guarda os ancestrais em que o caminho desceu para a esquerda:
+    // o topo e o menor no >= 'de' e os demais sao os proximos sucessores
+    PistaNode *cur = arv->raiz;
+    while (cur != NULL) {
+        if (de == NULL || strcmp(textoInterno(arv->textos, cur->pista), de) >= 0) {
+            c->pilha[c->topo++] = cur;
+            cur = cur->esquerda;
+        } else {
+            cur = cur->direita;
+        }
+    }
+}
+
+// proximaPista() – devolve o id da proxima pista em ordem alfabetica
+// ou TEXTO_VAZIO quando a faixa (ou o prefixo) termina
+uint32_t proximaPista(CursorPistas *c) {
+    if (c->topo == 0) return TEXTO_VAZIO;
+    PistaNode *n = c->pilha[--c->topo];
+    const char *texto = textoInterno(c->arv->textos, n->pista);
+    if ((c->ate != NULL && strcmp(texto, c->ate) > 0) ||
+        (c->prefixo != NULL && strncmp(texto, c->prefixo, c->tamPrefixo) != 0)) {
+        c->topo = 0; // tudo que resta e maior: fim da faixa
+        return TEXTO_VAZIO;
+    }
+    for (PistaNode *cur = n->direita; cur != NULL; cur = cur->esquerda)
+        c->pilha[c->topo++] = cur;
+    c->lidas++;
+    return n->pista;
+}
+
+// devolve os nos um a um (so o modo sistema precisa): rotaciona a direita ate a raiz nao ter
+// filho esquerdo, devolve a raiz e segue pelo filho direito, sem pilha
+static void devolverNos(ArvorePistas *arv) {
+    PistaNode *n = arv->raiz;
+    while (n != NULL) {
+        if (n->esquerda != NULL) {
+            PistaNode *e = n->esquerda;
+            n->esquerda = e->direita;
+            e->direita = n;
+            n = e;
+        } else {
+            PistaNode *d = n->direita;
+            devolverObjeto(&arv->nos, n);
+            n = d;
+        }
+    }
+}
+
+// esvazia a colecao reaproveitando a memoria do alocador
+void limparPistas(ArvorePistas *arv) {
+    if (arv->nos.modo == ALOCADOR_SISTEMA) devolverNos(arv);
+    esvaziarAlocador(&arv->nos);
+    arv->raiz = NULL;
+    arv->total = 0;
+}
+
+// liberar memoria da arvore de pistas (na arena e no pool, uma operacao por bloco)
+void liberarPistas(ArvorePistas *arv) {
+    if (arv->nos.modo == ALOCADOR_SISTEMA) devolverNos(arv);
+    liberarAlocadorObjetos(&arv->nos);
+    arv->raiz = NULL;
+    arv->total = 0;
+}
+
+// monta a AVL perfeitamente balanceada dos 'n' ids de 'ids' (ja em ordem alfabetica, sem
+// repetir) sem comparacoes: a subarvore de um trecho com s ids tem altura igual ao numero
+// de bits de s. Os nos saem do alocador da colecao em pre-ordem
+static void montarArvoreBalanceada(ArvorePistas *arv, const uint32_t *ids, size_t n) {
+    struct { size_t ini, fim; PistaNode **destino; } pilha[2 * ALTURA_MAX_AVL];
+    int topo = 0;
+    pilha[topo].ini = 0; pilha[topo].fim = n; pilha[topo++].destino = &arv->raiz;
+    while (topo > 0) {
+        --topo;
+        size_t ini = pilha[topo].ini, fim = pilha[topo].fim;
+        PistaNode **destino = pilha[topo].destino;
+        if (ini == fim) { *destino = NULL; continue; }
+        size_t meio = ini + (fim - ini) / 2;
+        PistaNode *no = (PistaNode*) alocarObjeto(&arv->nos);
+        no->pista = ids[meio];
+        no->altura = 64 - __builtin_clzll((unsigned long long) (fim - ini));
+        *destino = no;
+        pilha[topo].ini = meio + 1; pilha[topo].fim = fim; pilha[topo++].destino = &no->direita;
+        pilha[topo].ini = ini; pilha[topo].fim = meio; pilha[topo++].destino = &no->esquerda;
+    }
+    arv->total = n;
+}
+
+// construirPistasOrdenadas() – substitui o conteudo da colecao pelos 'n' ids distintos de 'ids',
+// ja em ordem alfabetica: O(n)
+void construirPistasOrdenadas(ArvorePistas *arv, const uint32_t *ids, size_t n) {
+    limparPistas(arv);
+    if (n == 0) return;
+    montarArvoreBalanceada(arv, ids, n);
+}
+
+static int compararTextoId(const void *a, const void *b, void *ctx) {
+    const InternPool *textos = (const InternPool*) ctx;
+    uint32_t x = *(const uint32_t*) a, y = *(const uint32_t*) b;
+    return x == y ? 0 : strcmp(textoInterno(textos, x), textoInterno(textos, y));
+}
+
+// construirPistas() – substitui o conteudo da colecao pelas pistas de 'ids' (em qualquer ordem,
+// repetidas ou vazias sao ignoradas): ordena uma copia por texto, com 'numThreads' threads se
+// valer a pena (a copia so e ordenada se ja nao estiver em ordem), e monta a arvore balanceada
+// em O(n). No modo arena a copia tambem vem da arena (fica como sobra ate a colecao ser
+// esvaziada), entao uma colecao reaproveitada nao chama malloc. Retorna quantas pistas a
+// colecao passou a ter
+size_t construirPistas(ArvorePistas *arv, const uint32_t *ids, size_t n, int numThreads) {
+    limparPistas(arv);
+    if (n == 0) return 0;
+    int naArena = arv->nos.modo == ALOCADOR_ARENA;
+    uint32_t *v = naArena ? (uint32_t*) arenaAlocar(&arv->nos.arena, n * sizeof(uint32_t))
+                          : (uint32_t*) memAlocar(MEM_PISTAS, n * sizeof(uint32_t));
+    if (v == NULL) { printf("Erro: memoria insuficiente (pistas).\n"); exit(1); }
+    size_t m = 0;
+    int ordenado = 1;
+    for (size_t i = 0; i < n; ++i) {
+        if (ids[i] == TEXTO_VAZIO) continue;
+        if (m > 0 && ordenado && compararTextoId(&v[m - 1], &ids[i], arv->textos) >= 0) ordenado = 0;
+        v[m++] = ids[i];
+    }
+    if (!ordenado) {
+        ordenarParalelo(v, m, sizeof(uint32_t), compararTextoId, arv->textos, numThreads);
+        size_t k = 0;
+        for (size_t i = 0; i < m; ++i)
+            if (k == 0 || v[i] != v[k - 1]) v[k++] = v[i];
+        m = k;
+    }
+    if (m > 0) montarArvoreBalanceada(arv, v, m);
+    if (!naArena) memLiberar(v);
+    return m;
+}
+
+// =========================
+// FUNCOES PARA TABELA HASH
+// =========================
+
+
+// inicializa a hash com a capacidade inicial (todas as posicoes vazias)
+// pistas e suspeitos sao guardados como ids de 'textos'
+void inicializarHash(HashTable *ht, InternPool *textos) {
+    ht->capacidade = HASH_CAP_INICIAL;
+    ht->quantidade = 0;
+    ht->textos = textos;
+    ht->entradas = (HashEntrada*) memZerada(MEM_HASH, ht->capacidade, sizeof(HashEntrada));
+    ht->chaveSuspeito = ht->nomeSuspeito = NULL;
+    ht->pistasSuspeito = NULL;
+    ht->numSuspeitos = ht->capSuspeitos = 0;
+    memset(&ht->postagensPistas, 0, sizeof ht->postagensPistas);
+    memset(&ht->postagensSuspeitos, 0, sizeof ht->postagensSuspeitos);
+    ht->numAssociacoes = 0;
+    ht->semente = (uint32_t) sementeHash;
+    ht->deslocPistas = ht->deslocSuspeitos = NULL;
+    ht->mascaraBaldesPistas = ht->mascaraBaldesSuspeitos = 0;
+    ht->mascaras = NULL;
+    ht->capIndiceSuspeitos = HASH_CAP_INICIAL;
+    ht->indiceSuspeitos = (IndiceSuspeito*) memZerada(MEM_HASH, ht->capIndiceSuspeitos, sizeof(IndiceSuspeito));
+    if (ht->entradas == NULL || ht->indiceSuspeitos == NULL) { printf("Erro: memoria insuficiente (hash).\n"); exit(1); }
+}
+
+// posicao de 'id' numa tabela perfeita (ver HashPerfeita)
+static inline uint32_t posicaoPerfeita(const uint32_t *desloc, uint32_t mascaraBaldes, uint32_t mascara,
+                                       uint32_t semente, uint32_t id) {
+    uint32_t h = espalharId(id, semente);
+    return espalharId(h, desloc[h & mascaraBaldes]) & mascara;
+}
+
+// indiceSuspeito() – indice denso do suspeito com a chave (nome em minusculas) informada
+// retorna UINT32_MAX se nenhum suspeito tiver essa chave
+uint32_t indiceSuspeito(const HashTable *ht, uint32_t chave) {
+    size_t mascara = ht->capIndiceSuspeitos - 1;
+    if (ht->deslocSuspeitos != NULL) {
+        const IndiceSuspeito *s = &ht->indiceSuspeitos[posicaoPerfeita(ht->deslocSuspeitos, ht->mascaraBaldesSuspeitos,
+                                                                       (uint32_t) mascara, ht->semente, chave)];
+        return s->idxMais1 != 0 && s->chave == chave ? s->idxMais1 - 1 : UINT32_MAX;
+    }
+    size_t i = espalharId(chave, ht->semente) & mascara;
+    while (ht->indiceSuspeitos[i].idxMais1 != 0) {
+        if (ht->indiceSuspeitos[i].chave == chave) return ht->indiceSuspeitos[i].idxMais1 - 1;
+        i = (i + 1) & mascara;
+    }
+    return UINT32_MAX;
+}
+
+static void indexarSuspeito(HashTable *ht, uint32_t chave, uint32_t idx) {
+    size_t mascara = ht->capIndiceSuspeitos - 1;
+    size_t i = espalharId(chave, ht->semente) & mascara;
+    while (ht->indiceSuspeitos[i].idxMais1 != 0) i = (i + 1) & mascara;
+    ht->indiceSuspeitos[i].chave = chave;
+    ht->indiceSuspeitos[i].idxMais1 = idx + 1;
+}
+
+// devolve o indice denso do suspeito, cadastrando-o se for novo
+static uint32_t registrarSuspeito(HashTable *ht, uint32_t nome, uint32_t chave) {
+    uint32_t idx = indiceSuspeito(ht, chave);
+    if (idx != UINT32_MAX) return idx;
+    if (ht->numSuspeitos == ht->capSuspeitos) {
+        ht->capSuspeitos = ht->capSuspeitos ? ht->capSuspeitos * 2 : 16;
+        ht->chaveSuspeito = (uint32_t*) memRealocar(MEM_HASH, ht->chaveSuspeito, ht->capSuspeitos * sizeof(uint32_t));
+        ht->nomeSuspeito = (uint32_t*) memRealocar(MEM_HASH, ht->nomeSuspeito, ht->capSuspeitos * sizeof(uint32_t));
+        ht->pistasSuspeito = (ListaPostagens*) memRealocar(MEM_HASH, ht->pistasSuspeito, ht->capSuspeitos * sizeof(ListaPostagens));
+        if (ht->chaveSuspeito == NULL || ht->nomeSuspeito == NULL || ht->pistasSuspeito == NULL) {
+            printf("Erro: memoria insuficiente (suspeitos).\n");
+            exit(1);
+        }
+    }
+    idx = ht->numSuspeitos++;
+    ht->chaveSuspeito[idx] = chave;
+    ht->nomeSuspeito[idx] = nome;
+    ht->pistasSuspeito[idx].inicio = ht->pistasSuspeito[idx].quantidade = 0;
+    // mantem o indice com carga <= 1/2
+    if ((size_t) ht->numSuspeitos * 2 > ht->capIndiceSuspeitos) {
+        memLiberar(ht->indiceSuspeitos);
+        ht->capIndiceSuspeitos *= 2;
+        ht->indiceSuspeitos = (IndiceSuspeito*) memZerada(MEM_HASH, ht->capIndiceSuspeitos, sizeof(IndiceSuspeito));
+        if (ht->indiceSuspeitos == NULL) { printf("Erro: memoria insuficiente (suspeitos).\n"); exit(1); }
+        for (uint32_t k = 0; k < ht->numSuspeitos; ++k) indexarSuspeito(ht, ht->chaveSuspeito[k], k);
+    } else {
+        indexarSuspeito(ht, chave, idx);
+    }
+    return idx;
+}
+
+// procura a posicao da pista (ou a primeira posicao vazia da sequencia de sondagem);
+// na hash perfeita, a unica posicao em que a pista pode estar
+static size_t sondarHash(const HashTable *ht, uint32_t pista) {
+    size_t mascara = ht->capacidade - 1;
+    if (ht->deslocPistas != NULL)
+        return posicaoPerfeita(ht->deslocPistas, ht->mascaraBaldesPistas, (uint32_t) mascara, ht->semente, pista);
+    size_t i = espalharId(pista, ht->semente) & mascara;
+#ifdef INSTRUMENTAR
+    size_t inicio = i;
+#endif
+    while (ht->entradas[i].pista != TEXTO_VAZIO && ht->entradas[i].pista != pista)
+        i = (i + 1) & mascara;
+    INSTR_VALOR(MED_SONDAGEM_HASH, (i - inicio) & mascara);
+    return i;
+}
+
+// dobra a capacidade e reinsere as entradas
+static void redimensionarHash(HashTable *ht) {
+    size_t capAntiga = ht->capacidade;
+    HashEntrada *antigas = ht->entradas;
+    ht->capacidade = capAntiga * 2;
+    ht->entradas = (HashEntrada*) memZerada(MEM_HASH, ht->capacidade, sizeof(HashEntrada));
+    if (ht->entradas == NULL) { printf("Erro: memoria insuficiente (hash).\n"); exit(1); }
+    for (size_t k = 0; k < capAntiga; ++k) {
+        if (antigas[k].pista == TEXTO_VAZIO) continue;
+        ht->entradas[sondarHash(ht, antigas[k].pista)] = antigas[k];
+    }
+    memLiberar(antigas);
+}
+
+// capacidade reservada para uma lista com 'q' postagens: a potencia de 2 >= q
+// (lista cheia quando q e potencia de 2; ao crescer, ela muda para o fim com o dobro)
+static inline uint32_t capacidadeLista(uint32_t q) {
+    return q <= 1 ? q : 1u << (32 - __builtin_clz(q - 1));
+}
+
+// garante espaco para mais 'extra' postagens no fim do vetor
+static void reservarPostagens(PoolPostagens *p, uint32_t extra) {
+    if ((uint64_t) p->usados + extra <= p->cap) return;
+    uint64_t nova = p->cap ? p->cap : 64;
+    while (nova < (uint64_t) p->usados + extra) nova *= 2;
+    if (nova > UINT32_MAX) { printf("Erro: associacoes demais.\n"); exit(1); }
+    Postagem *v = (Postagem*) memRealocar(MEM_HASH, p->itens, nova * sizeof(Postagem));
+    if (v == NULL) { printf("Erro: memoria insuficiente (postagens).\n"); exit(1); }
+    p->itens = v;
+    p->cap = (uint32_t) nova;
+}
+
+// acrescenta (id, peso) a lista 'l'; custo amortizado O(1)
+static void anexarPostagem(PoolPostagens *p, ListaPostagens *l, uint32_t id, uint32_t peso) {
+    uint32_t q = l->quantidade;
+    if (q == capacidadeLista(q)) {
+        // cheia: copia para o fim do vetor reservando o dobro; o trecho antigo vira lixo
+        uint32_t nova = q ? q * 2 : 1;
+        reservarPostagens(p, nova);
+        memcpy(p->itens + p->usados, p->itens + l->inicio, q * sizeof(Postagem));
+        p->lixo += q;
+        l->inicio = p->usados;
+        p->usados += nova;
+    }
+    p->itens[l->inicio + q].id = id;
+    p->itens[l->inicio + q].peso = peso;
+    l->quantidade = q + 1;
+}
+
+// copia a lista 'l' para o vetor novo (mantendo a capacidade reservada) e atualiza seu inicio
+static void moverLista(const PoolPostagens *p, ListaPostagens *l, Postagem *novo, uint32_t *usados) {
+    memcpy(novo + *usados, p->itens + l->inicio, l->quantidade * sizeof(Postagem));
+    l->inicio = *usados;
+    *usados += capacidadeLista(l->quantidade);
+}
+
+static Postagem* vetorCompacto(const PoolPostagens *p) {
+    Postagem *novo = (Postagem*) memAlocar(MEM_HASH, (p->cap ? p->cap : 1) * sizeof(Postagem));
+    if (novo == NULL) { printf("Erro: memoria insuficiente (postagens).\n"); exit(1); }
+    return novo;
+}
+
+static void trocarVetor(PoolPostagens *p, Postagem *novo, uint32_t usados) {
+    memLiberar(p->itens);
+    p->itens = novo;
+    p->usados = usados;
+    p->lixo = 0;
+}
+
+// recolhe o lixo dos vetores de postagens quando ele passa da metade do que esta em uso
+// (usados - lixo); comparado com 'usados' inteiro nunca passaria, porque cada lista que cresce
+// deixa q de lixo e ocupa 2q
+static void recolherPostagens(HashTable *ht) {
+    PoolPostagens *pp = &ht->postagensPistas, *ps = &ht->postagensSuspeitos;
+    if (pp->lixo * 2 > pp->usados - pp->lixo) {
+        Postagem *novo = vetorCompacto(pp);
+        uint32_t usados = 0;
+        for (size_t k = 0; k < ht->capacidade; ++k)
+            if (ht->entradas[k].pista != TEXTO_VAZIO) moverLista(pp, &ht->entradas[k].suspeitos, novo, &usados);
+        trocarVetor(pp, novo, usados);
+    }
+    if (ps->lixo * 2 > ps->usados - ps->lixo) {
+        Postagem *novo = vetorCompacto(ps);
+        uint32_t usados = 0;
+        for (uint32_t i = 0; i < ht->numSuspeitos; ++i) moverLista(ps, &ht->pistasSuspeito[i], novo, &usados);
+        trocarVetor(ps, novo, usados);
+    }
+}
+
+// postagem de 'id' na lista, ou NULL (as listas sao curtas: varredura linear)
+static Postagem* buscarPostagem(const PoolPostagens *p, const ListaPostagens *l, uint32_t id) {
+    for (uint32_t k = 0; k < l->quantidade; ++k)
+        if (p->itens[l->inicio + k].id == id) return &p->itens[l->inicio + k];
+    return NULL;
+}
+
+// inserirNaHashId() – associa a pista ao suspeito com 'peso' pontos, a partir de ids
+// 'chave' e o id do nome do suspeito em minusculas; a pista pode implicar varios suspeitos
+// e, se ja implicar este, so o peso e substituido
+void inserirNaHashId(HashTable *ht, uint32_t pista, uint32_t suspeito, uint32_t chave, uint32_t peso) {
+    if (pista == TEXTO_VAZIO) return;
+    if (ht->deslocPistas != NULL) { printf("Erro: a hash perfeita e somente leitura.\n"); exit(1); }
+    // fator de carga maximo de 3/4: cresce antes de inserir
+    if ((ht->quantidade + 1) * 4 > ht->capacidade * 3) redimensionarHash(ht);
+    HashEntrada *e = &ht->entradas[sondarHash(ht, pista)];
+    if (e->pista == TEXTO_VAZIO) {
+        ht->quantidade++;
+        e->pista = pista;
+        e->suspeitos.inicio = e->suspeitos.quantidade = 0;
+    }
+    uint32_t idx = registrarSuspeito(ht, suspeito, chave);
+    Postagem *ja = buscarPostagem(&ht->postagensPistas, &e->suspeitos, idx);
+    if (ja != NULL) {
+        ja->peso = peso;
+        buscarPostagem(&ht->postagensSuspeitos, &ht->pistasSuspeito[idx], pista)->peso = peso;
+        return;
+    }
+    anexarPostagem(&ht->postagensPistas, &e->suspeitos, idx, peso);
+    anexarPostagem(&ht->postagensSuspeitos, &ht->pistasSuspeito[idx], pista, peso);
+    ht->numAssociacoes++;
+    recolherPostagens(ht);
+}
+
+// inserirNaHash() – associa a pista ao suspeito com 1 ponto de evidencia
+void inserirNaHash(HashTable *ht, const char *pista, const char *suspeito) {
+    if (pista == NULL || pista[0] == '\0') return;
+    uint32_t p = internar(ht->textos, pista, MAXPISTA);
+    uint32_t s = internar(ht->textos, suspeito, MAXNOME);
+    inserirNaHashId(ht, p, s, internarChave(ht->textos, textoInterno(ht->textos, s)), 1);
+}
+
+// entrada associada ao id da pista, ou NULL se nao houver
+const HashEntrada* encontrarEntrada(const HashTable *ht, uint32_t pista) {
+    if (pista == TEXTO_VAZIO) return NULL;
+    const HashEntrada *e = &ht->entradas[sondarHash(ht, pista)];
+    return e->pista == pista ? e : NULL;
+}
+
+// pontos que a pista da entrada 'e' soma contra o suspeito 'idx' (0 se nao o implicar)
+uint32_t pesoContra(const HashTable *ht, const HashEntrada *e, uint32_t idx) {
+    const Postagem *p = suspeitosDaPista(ht, e);
+    for (uint32_t k = 0; k < e->suspeitos.quantidade; ++k)
+        if (p[k].id == idx) return p[k].peso;
+    return 0;
+}
+
+// suspeito que a pista mais implica (o de maior peso; no empate, o cadastrado antes)
+uint32_t suspeitoPrincipal(const HashTable *ht, const HashEntrada *e) {
+    const Postagem *p = suspeitosDaPista(ht, e);
+    uint32_t melhor = 0;
+    for (uint32_t k = 1; k < e->suspeitos.quantidade; ++k)
+        if (p[k].peso > p[melhor].peso) melhor = k;
+    return p[melhor].id;
+}
+
+// encontrarSuspeito() – consulta o suspeito que a pista mais implica
+// retorna NULL se nao encontrar
+const char* encontrarSuspeito(HashTable *ht, const char *pista) {
+    if (pista == NULL || pista[0] == '\0') return NULL;
+    uint32_t id = buscarInterno(ht->textos, pista, MAXPISTA);
+    const HashEntrada *e = id != UINT32_MAX ? encontrarEntrada(ht, id) : NULL;
+    return e != NULL ? textoInterno(ht->textos, ht->nomeSuspeito[suspeitoPrincipal(ht, e)]) : NULL;
+}
+
+// libera memoria da hash table (os textos pertencem a tabela de internados; os vetores de uma
+// hash perfeita pertencem a quem a montou)
+void liberarHash(HashTable *ht) {
+    if (ht->deslocPistas != NULL) {
+        memset(ht, 0, sizeof *ht);
+        return;
+    }
+    memLiberar(ht->entradas);
+    memLiberar(ht->chaveSuspeito);
+    memLiberar(ht->nomeSuspeito);
+    memLiberar(ht->pistasSuspeito);
+    memLiberar(ht->indiceSuspeitos);
+    memLiberar(ht->postagensPistas.itens);
+    memLiberar(ht->postagensSuspeitos.itens);
+    ht->entradas = NULL;
+    ht->chaveSuspeito = ht->nomeSuspeito = NULL;
+    ht->pistasSuspeito = NULL;
+    ht->indiceSuspeitos = NULL;
+    memset(&ht->postagensPistas, 0, sizeof ht->postagensPistas);
+    memset(&ht->postagensSuspeitos, 0, sizeof ht->postagensSuspeitos);
+    ht->capacidade = ht->quantidade = ht->numAssociacoes = 0;
+    ht->numSuspeitos = ht->capSuspeitos = 0;
+}
+
+// carregarHashEmLote() – carrega 'n' associacoes numa hash vazia com o mesmo resultado de
+// inserirNaHashId chamada em ordem (suspeitos numerados pela primeira aparicao, par repetido fica
+// na posicao da primeira vez com o peso da ultima). As associacoes sao agrupadas por pista com uma
+// ordenacao por contagem sobre os ids (estavel, O(n + textos)); depois a tabela e os vetores de
+// postagens sao alocados uma vez, ja com o tamanho final, e preenchidos sem realocar nem mover
+// listas. Numa hash que ja tem pistas, insere uma a uma
+void carregarHashEmLote(HashTable *ht, const Associacao *a, size_t n) {
+    if (ht->quantidade > 0 || n >= UINT32_MAX) {
+        for (size_t i = 0; i < n; ++i) inserirNaHashId(ht, a[i].pista, a[i].suspeito, a[i].chave, a[i].peso);
+        return;
+    }
+    uint32_t totalTextos = totalInternos(ht->textos);
+    RegistroCarga *r = (RegistroCarga*) memAlocar(MEM_HASH, (n ? n : 1) * sizeof(RegistroCarga));
+    uint32_t *primeira = (uint32_t*) memAlocar(MEM_HASH, (n ? n : 1) * sizeof(uint32_t));
+    uint32_t *inicioPista = (uint32_t*) memZerada(MEM_HASH, (size_t) totalTextos + 1, sizeof(uint32_t));
+    if (r == NULL || primeira == NULL || inicioPista == NULL) {
+        printf("Erro: memoria insuficiente (carga da hash).\n");
+        exit(1);
+    }
+    // suspeitos numerados na ordem da entrada ('primeira' guarda o indice de cada associacao
+    // ate a distribuicao) e quantas associacoes cada pista tem
+    size_t m = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (a[i].pista == TEXTO_VAZIO) continue;
+        primeira[m++] = registrarSuspeito(ht, a[i].suspeito, a[i].chave);
+        inicioPista[a[i].pista]++;
+    }
+    for (uint32_t t = 0, soma = 0; t <= totalTextos; ++t) {
+        uint32_t q = inicioPista[t];
+        inicioPista[t] = soma;
+        soma += q;
+    }
+    for (size_t i = 0, k = 0; i < n; ++i) {
+        if (a[i].pista == TEXTO_VAZIO) continue;
+        RegistroCarga *x = &r[inicioPista[a[i].pista]++];
+        x->pista = a[i].pista;
+        x->idx = primeira[k];
+        x->peso = a[i].peso;
+        x->pos = (uint32_t) k++;
+    }
+    memLiberar(inicioPista);
+    memset(primeira, 0, (n ? n : 1) * sizeof(uint32_t));
+
+    // repetidas: a primeira aparicao do par fica com o peso da ultima; conta pistas e listas
+    uint32_t *marca = (uint32_t*) memZerada(MEM_HASH, ht->numSuspeitos ? ht->numSuspeitos : 1, sizeof(uint32_t));
+    uint32_t *ondeMarca = (uint32_t*) memAlocar(MEM_HASH, (ht->numSuspeitos ? ht->numSuspeitos : 1) * sizeof(uint32_t));
+    uint32_t *porSuspeito = (uint32_t*) memZerada(MEM_HASH, ht->numSuspeitos ? ht->numSuspeitos : 1, sizeof(uint32_t));
+    if (marca == NULL || ondeMarca == NULL || porSuspeito == NULL) {
+        printf("Erro: memoria insuficiente (carga da hash).\n");
+        exit(1);
+    }
+    size_t numPistas = 0, numPares = 0;
+    uint64_t reservaPistas = 0;
+    for (size_t ini = 0, fim; ini < m; ini = fim) {
+        uint32_t q = 0;
+        for (fim = ini; fim < m && r[fim].pista == r[ini].pista; ++fim) {
+            uint32_t s = r[fim].idx;
+            if (marca[s] == numPistas + 1) {
+                r[ondeMarca[s]].peso = r[fim].peso;
+                r[fim].idx = UINT32_MAX;
+                continue;
+            }
+            marca[s] = (uint32_t) numPistas + 1;
+            ondeMarca[s] = (uint32_t) fim;
+            primeira[r[fim].pos] = (uint32_t) fim + 1;
+            porSuspeito[s]++;
+            q++;
+        }
+        reservaPistas += capacidadeLista(q);
+        numPistas++;
+        numPares += q;
+    }
+    uint64_t reservaSuspeitos = 0;
+    for (uint32_t s = 0; s < ht->numSuspeitos; ++s) reservaSuspeitos += capacidadeLista(porSuspeito[s]);
+
+    // tabela com a capacidade final (carga <= 3/4, como no crescimento um a um)
+    size_t cap = HASH_CAP_INICIAL;
+    while (numPistas * 4 > cap * 3) cap *= 2;
+    memLiberar(ht->entradas);
+    ht->capacidade = cap;
+    ht->entradas = (HashEntrada*) memZerada(MEM_HASH, cap, sizeof(HashEntrada));
+    if (ht->entradas == NULL) { printf("Erro: memoria insuficiente (hash).\n"); exit(1); }
+    reservarPostagens(&ht->postagensPistas, (uint32_t) reservaPistas);
+    reservarPostagens(&ht->postagensSuspeitos, (uint32_t) reservaSuspeitos);
+
+    // listas das pistas, na ordem da primeira aparicao de cada par
+    PoolPostagens *pp = &ht->postagensPistas, *ps = &ht->postagensSuspeitos;
+    for (size_t ini = 0, fim; ini < m; ini = fim) {
+        HashEntrada *e = &ht->entradas[sondarHash(ht, r[ini].pista)];
+        e->pista = r[ini].pista;
+        e->suspeitos.inicio = pp->usados;
+        e->suspeitos.quantidade = 0;
+        for (fim = ini; fim < m && r[fim].pista == r[ini].pista; ++fim) {
+            if (r[fim].idx == UINT32_MAX) continue;
+            pp->itens[pp->usados + e->suspeitos.quantidade].id = r[fim].idx;
+            pp->itens[pp->usados + e->suspeitos.quantidade++].peso = r[fim].peso;
+        }
+        pp->usados += capacidadeLista(e->suspeitos.quantidade);
+    }
+    // listas dos suspeitos: percorre os pares na ordem da entrada
+    for (uint32_t s = 0; s < ht->numSuspeitos; ++s) {
+        ht->pistasSuspeito[s].inicio = ps->usados;
+        ht->pistasSuspeito[s].quantidade = 0;
+        ps->usados += capacidadeLista(porSuspeito[s]);
+    }
+    for (size_t i = 0; i < m; ++i) {
+        if (primeira[i] == 0) continue;
+        const RegistroCarga *x = &r[primeira[i] - 1];
+        ListaPostagens *l = &ht->pistasSuspeito[x->idx];
+        ps->itens[l->inicio + l->quantidade].id = x->pista;
+        ps->itens[l->inicio + l->quantidade++].peso = x->peso;
+    }
+    ht->quantidade = numPistas;
+    ht->numAssociacoes = numPares;
+    memLiberar(marca);
+    memLiberar(ondeMarca);
+    memLiberar(porSuspeito);
+    memLiberar(primeira);
+    memLiberar(r);
+}
+
+// carrega na hash as associacoes pista -> suspeito definidas no mapa
+void popularHash(HashTable *ht, const Mansao *m) {
+    carregarHashEmLote(ht, m->associacoes, m->numAssociacoes);
+}
+
+// tamanho do balde 'b' (ids[inicio[b] .. inicio[b+1])), para ordenar os baldes do maior ao menor
+static int compararBaldes(const void *a, const void *b, void *ctx) {
+    const uint32_t *inicio = (const uint32_t*) ctx;
+    uint32_t x = *(const uint32_t*) a, y = *(const uint32_t*) b;
+    uint32_t tx = inicio[x + 1] - inicio[x], ty = inicio[y + 1] - inicio[y];
+    return tx != ty ? (tx > ty ? -1 : 1) : (x > y) - (x < y);
+}
+
+// ordena pares (id << 32 | posicao de origem) pelo id, para que a tabela gerada nao dependa da semente
+static int compararIdOrigem(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*) a, y = *(const uint64_t*) b;
+    return (x > y) - (x < y);
+}
+
+// separarIds() – distribui 'n' ids distintos em 'cap' posicoes (potencia de 2) sem colisoes: os ids
+// sao agrupados em 'numBaldes' baldes e, do maior balde para o menor, cada balde recebe o primeiro
+// deslocamento que leva todos os seus ids a posicoes livres. Preenche desloc[] e posicao[i];
+// retorna 0 se algum balde esgotar as tentativas
+static int separarIds(const uint32_t *ids, uint32_t n, uint32_t semente, uint32_t *desloc,
+                      uint32_t numBaldes, uint32_t cap, uint32_t *posicao) {
+    uint32_t *inicio = (uint32_t*) memZerada(MEM_HASH, (size_t) numBaldes + 1, sizeof(uint32_t));
+    uint32_t *cursor = (uint32_t*) memAlocar(MEM_HASH, (size_t) numBaldes * sizeof(uint32_t));
+    uint32_t *ordem = (uint32_t*) memAlocar(MEM_HASH, (n ? n : 1) * sizeof(uint32_t));
+    unsigned char *ocupada = (unsigned char*) memZerada(MEM_HASH, cap, 1);
+    if (inicio == NULL || cursor == NULL || ordem == NULL || ocupada == NULL) {
+        printf("Erro: memoria insuficiente (hash perfeita).\n");
+        exit(1);
+    }
+    for (uint32_t i = 0; i < n; ++i) inicio[(espalharId(ids[i], semente) & (numBaldes - 1)) + 1]++;
+    for (uint32_t b = 0; b < numBaldes; ++b) inicio[b + 1] += inicio[b];
+    memcpy(cursor, inicio, (size_t) numBaldes * sizeof(uint32_t));
+    for (uint32_t i = 0; i < n; ++i) ordem[cursor[espalharId(ids[i], semente) & (numBaldes - 1)]++] = i;
+    for (uint32_t b = 0; b < numBaldes; ++b) cursor[b] = b;
+    qsort_r(cursor, numBaldes, sizeof(uint32_t), compararBaldes, inicio);
+
+    int ok = 1;
+    for (uint32_t k = 0; k < numBaldes && ok; ++k) {
+        uint32_t b = cursor[k];
+        if (inicio[b] == inicio[b + 1]) break; // os demais baldes estao vazios
+        desloc[b] = 0;
+        for (uint32_t d = 1; d <= HASH_PERFEITA_TENTATIVAS; ++d) {
+            uint32_t j = inicio[b];
+            for (; j < inicio[b + 1]; ++j) {
+                uint32_t p = espalharId(espalharId(ids[ordem[j]], semente), d) & (cap - 1);
+                if (ocupada[p]) break;
+                ocupada[p] = 1;
+                posicao[ordem[j]] = p;
+            }
+            if (j == inicio[b + 1]) { desloc[b] = d; break; }
+            while (j > inicio[b]) ocupada[posicao[ordem[--j]]] = 0; // desfaz a tentativa
+        }
+        if (desloc[b] == 0) ok = 0;
+    }
+    memLiberar(ocupada);
+    memLiberar(ordem);
+    memLiberar(cursor);
+    memLiberar(inicio);
+    return ok;
+}
+
+// deslocamentos de uma tabela perfeita para 'n' ids: um balde para cada 4 ids e capacidade
+// >= 5n/4, dobrada enquanto algum balde nao se separar; posicao[i] recebe a posicao de ids[i]
+static uint32_t* montarTabelaPerfeita(const uint32_t *ids, uint32_t n, uint32_t semente,
+                                      uint32_t *cap, uint32_t *numBaldes, uint32_t *posicao) {
+    *numBaldes = 1;
+    while (*numBaldes * 4 < n) *numBaldes *= 2;
+    *cap = 2;
+    while (*cap < n + n / 4) *cap *= 2;
+    for (;;) {
+        uint32_t *desloc = (uint32_t*) memZerada(MEM_HASH, *numBaldes, sizeof(uint32_t));
+        if (desloc == NULL) { printf("Erro: memoria insuficiente (hash perfeita).\n"); exit(1); }
+        if (separarIds(ids, n, semente, desloc, *numBaldes, *cap, posicao)) return desloc;
+        memLiberar(desloc);
+        *cap *= 2;
+    }
+}
+
+// construirHashPerfeita() – copia o conteudo de 'ht' para vetores de uma hash perfeita, com as
+// listas de postagens compactadas e, ate 64 suspeitos, a mascara de suspeitos de cada pista
+void construirHashPerfeita(const HashTable *ht, HashPerfeita *hp) {
+    memset(hp, 0, sizeof *hp);
+    uint32_t n = (uint32_t) ht->quantidade, ns = ht->numSuspeitos;
+    uint64_t *origem = (uint64_t*) memAlocar(MEM_HASH, (n ? n : 1) * sizeof(uint64_t));
+    uint32_t *ids = (uint32_t*) memAlocar(MEM_HASH, ((n > ns ? n : ns) + 1) * sizeof(uint32_t));
+    uint32_t *posicao = (uint32_t*) memAlocar(MEM_HASH, ((n > ns ? n : ns) + 1) * sizeof(uint32_t));
+    if (origem == NULL || ids == NULL || posicao == NULL) {
+        printf("Erro: memoria insuficiente (hash perfeita).\n");
+        exit(1);
+    }
+    hp->semente = HASH_PERFEITA_SEMENTE;
+    hp->quantidade = n;
+    hp->numSuspeitos = ns;
+    hp->numAssociacoes = (uint32_t) ht->numAssociacoes;
+
+    // pistas: entradas nas posicoes perfeitas, listas copiadas na ordem dos ids (e nao na ordem
+    // da tabela de origem, que muda com a semente)
+    uint32_t k = 0;
+    for (size_t i = 0; i < ht->capacidade; ++i)
+        if (ht->entradas[i].pista != TEXTO_VAZIO) origem[k++] = (uint64_t) ht->entradas[i].pista << 32 | i;
+    qsort(origem, n, sizeof(uint64_t), compararIdOrigem);
+    for (uint32_t j = 0; j < n; ++j) ids[j] = (uint32_t) (origem[j] >> 32);
+    hp->deslocPistas = montarTabelaPerfeita(ids, n, hp->semente, &hp->capacidade, &hp->numBaldesPistas, posicao);
+    HashEntrada *entradas = (HashEntrada*) memZerada(MEM_HASH, hp->capacidade, sizeof(HashEntrada));
+    Postagem *pp = (Postagem*) memAlocar(MEM_HASH, (hp->numAssociacoes ? hp->numAssociacoes : 1) * sizeof(Postagem));
+    uint64_t *mascaras = ns <= 64 ? (uint64_t*) memZerada(MEM_HASH, hp->capacidade, sizeof(uint64_t)) : NULL;
+    if (entradas == NULL || pp == NULL || (ns <= 64 && mascaras == NULL)) {
+        printf("Erro: memoria insuficiente (hash perfeita).\n");
+        exit(1);
+    }
+    uint32_t usados = 0;
+    for (uint32_t j = 0; j < n; ++j) {
+        const HashEntrada *e = &ht->entradas[(uint32_t) origem[j]];
+        HashEntrada *d = &entradas[posicao[j]];
+        d->pista = e->pista;
+        d->suspeitos.inicio = usados;
+        d->suspeitos.quantidade = e->suspeitos.quantidade;
+        memcpy(pp + usados, suspeitosDaPista(ht, e), e->suspeitos.quantidade * sizeof(Postagem));
+        for (uint32_t q = 0; q < e->suspeitos.quantidade && mascaras != NULL; ++q)
+            if (pp[usados + q].peso > 0) mascaras[posicao[j]] |= 1ull << pp[usados + q].id;
+        usados += e->suspeitos.quantidade;
+    }
+    hp->entradas = entradas;
+    hp->postagensPistas = pp;
+    hp->numPostagensPistas = usados;
+    hp->mascaras = mascaras;
+
+    // suspeitos: indice perfeito pela chave e listas compactadas na ordem dos indices
+    hp->deslocSuspeitos = montarTabelaPerfeita(ht->chaveSuspeito, ns, hp->semente, &hp->capIndiceSuspeitos,
+                                               &hp->numBaldesSuspeitos, posicao);
+    IndiceSuspeito *indice = (IndiceSuspeito*) memZerada(MEM_HASH, hp->capIndiceSuspeitos, sizeof(IndiceSuspeito));
+    uint32_t *chaves = (uint32_t*) memAlocar(MEM_HASH, (ns ? ns : 1) * sizeof(uint32_t));
+    uint32_t *nomes = (uint32_t*) memAlocar(MEM_HASH, (ns ? ns : 1) * sizeof(uint32_t));
+    ListaPostagens *listas = (ListaPostagens*) memAlocar(MEM_HASH, (ns ? ns : 1) * sizeof(ListaPostagens));
+    Postagem *ps = (Postagem*) memAlocar(MEM_HASH, (hp->numAssociacoes ? hp->numAssociacoes : 1) * sizeof(Postagem));
+    if (indice == NULL || chaves == NULL || nomes == NULL || listas == NULL || ps == NULL) {
+        printf("Erro: memoria insuficiente (hash perfeita).\n");
+        exit(1);
+    }
+    usados = 0;
+    for (uint32_t s = 0; s < ns; ++s) {
+        indice[posicao[s]].chave = ht->chaveSuspeito[s];
+        indice[posicao[s]].idxMais1 = s + 1;
+        chaves[s] = ht->chaveSuspeito[s];
+        nomes[s] = ht->nomeSuspeito[s];
+        listas[s].inicio = usados;
+        listas[s].quantidade = ht->pistasSuspeito[s].quantidade;
+        memcpy(ps + usados, pistasDoSuspeito(ht, s), listas[s].quantidade * sizeof(Postagem));
+        usados += listas[s].quantidade;
+    }
+    hp->indiceSuspeitos = indice;
+    hp->chaveSuspeito = chaves;
+    hp->nomeSuspeito = nomes;
+    hp->pistasSuspeito = listas;
+    hp->postagensSuspeitos = ps;
+    hp->numPostagensSuspeitos = usados;
+    memLiberar(posicao);
+    memLiberar(ids);
+    memLiberar(origem);
+}
+
+// libera os vetores de uma hash perfeita montada por construirHashPerfeita()
+void liberarHashPerfeita(HashPerfeita *hp) {
+    memLiberar((void*) hp->entradas);
+    memLiberar((void*) hp->deslocPistas);
+    memLiberar((void*) hp->indiceSuspeitos);
+    memLiberar((void*) hp->deslocSuspeitos);
+    memLiberar((void*) hp->chaveSuspeito);
+    memLiberar((void*) hp->nomeSuspeito);
+    memLiberar((void*) hp->pistasSuspeito);
+    memLiberar((void*) hp->postagensPistas);
+    memLiberar((void*) hp->postagensSuspeitos);
+    memLiberar((void*) hp->mascaras);
+    memset(hp, 0, sizeof *hp);
+}
+
+// abrirHashPerfeita() – usa os vetores de 'hp' como a hash 'ht', sem copiar nem alocar nada.
+// Os vetores nunca sao escritos (inserirNaHashId recusa a hash perfeita), entao podem ser as
+// tabelas constantes de uma mansao compilada; liberarHash() nao os libera
+void abrirHashPerfeita(HashTable *ht, const HashPerfeita *hp, InternPool *textos) {
+    memset(ht, 0, sizeof *ht);
+    ht->textos = textos;
+    ht->entradas = (HashEntrada*) hp->entradas;
+    ht->capacidade = hp->capacidade;
+    ht->quantidade = hp->quantidade;
+    ht->chaveSuspeito = (uint32_t*) hp->chaveSuspeito;
+    ht->nomeSuspeito = (uint32_t*) hp->nomeSuspeito;
+    ht->pistasSuspeito = (ListaPostagens*) hp->pistasSuspeito;
+    ht->numSuspeitos = ht->capSuspeitos = hp->numSuspeitos;
+    ht->indiceSuspeitos = (IndiceSuspeito*) hp->indiceSuspeitos;
+    ht->capIndiceSuspeitos = hp->capIndiceSuspeitos;
+    ht->postagensPistas.itens = (Postagem*) hp->postagensPistas;
+    ht->postagensPistas.usados = ht->postagensPistas.cap = hp->numPostagensPistas;
+    ht->postagensSuspeitos.itens = (Postagem*) hp->postagensSuspeitos;
+    ht->postagensSuspeitos.usados = ht->postagensSuspeitos.cap = hp->numPostagensSuspeitos;
+    ht->numAssociacoes = hp->numAssociacoes;
+    ht->semente = hp->semente;
+    ht->deslocPistas = hp->deslocPistas;
+    ht->deslocSuspeitos = hp->deslocSuspeitos;
+    ht->mascaraBaldesPistas = hp->numBaldesPistas - 1;
+    ht->mascaraBaldesSuspeitos = hp->numBaldesSuspeitos - 1;
+    ht->mascaras = hp->mascaras;
+}
+
+// =========================
+// RELATORIO DE PISTAS (SAIDA BUFERIZADA)
+// =========================
+
+
+void inicializarBufferSaida(BufferSaida *b, FILE *destino, char *memoria, size_t cap) {
+    b->dados = memoria;
+    b->cap = cap;
+    b->usado = 0;
+    b->destino = destino;
+}
+
+// buffer sem destino: cresce conforme precisa e guarda tudo ate quem o usa consumir 'dados'
+void inicializarBufferCrescente(BufferSaida *b, size_t cap) {
+    b->dados = (char*) memAlocar(MEM_BUFFERS, cap);
+    if (b->dados == NULL) { printf("Erro: memoria insuficiente (buffer de saida).\n"); exit(1); }
+    b->cap = cap;
+    b->usado = 0;
+    b->destino = NULL;
+}
+
+void liberarBufferCrescente(BufferSaida *b) {
+    memLiberar(b->dados);
+    b->dados = NULL;
+    b->cap = b->usado = 0;
+}
+
+// garante 'n' bytes livres num buffer sem destino (dobra a capacidade)
+static void crescerBuffer(BufferSaida *b, size_t n) {
+    if (b->cap - b->usado >= n) return;
+    size_t nova = b->cap ? b->cap : BUFFER_SAIDA;
+    while (nova - b->usado < n) nova *= 2;
+    char *d = (char*) memRealocar(MEM_BUFFERS, b->dados, nova);
+    if (d == NULL) { printf("Erro: memoria insuficiente (buffer de saida).\n"); exit(1); }
+    b->dados = d;
+    b->cap = nova;
+}
+
+// escreve o conteudo acumulado no destino e esvazia o buffer (sem destino, nao faz nada)
+void descarregarBuffer(BufferSaida *b) {
+    if (b->destino == NULL) return;
+    if (b->usado > 0) fwrite(b->dados, 1, b->usado, b->destino);
+    b->usado = 0;
+}
+
+void bufEscrever(BufferSaida *b, const char *s, size_t n) {
+    if (b->usado + n > b->cap) {
+        if (b->destino == NULL) {
+            crescerBuffer(b, n);
+        } else {
+            descarregarBuffer(b);
+            if (n > b->cap) { // maior que o buffer inteiro: vai direto
+                fwrite(s, 1, n, b->destino);
+                return;
+            }
+        }
+    }
+    memcpy(b->dados + b->usado, s, n);
+    b->usado += n;
+}
+
+// bufFormatar() – printf no buffer: formata direto no espaco livre e, se nao couber,
+// abre espaco (descarregando ou crescendo) e formata de novo
+__attribute__((format(printf, 2, 3)))
+void bufFormatar(BufferSaida *b, const char *fmt, ...) {
+    va_list ap, copia;
+    va_start(ap, fmt);
+    va_copy(copia, ap);
+    int n = vsnprintf(b->dados + b->usado, b->cap - b->usado, fmt, ap);
+    va_end(ap);
+    if (n >= 0 && (size_t) n >= b->cap - b->usado) {
+        if (b->destino == NULL) crescerBuffer(b, (size_t) n + 1);
+        else descarregarBuffer(b);
+        if ((size_t) n < b->cap - b->usado) {
+            vsnprintf(b->dados + b->usado, b->cap - b->usado, fmt, copia);
+        } else { // maior que o buffer inteiro
+            char *tmp = (char*) memAlocar(MEM_BUFFERS, (size_t) n + 1);
+            if (tmp == NULL) { printf("Erro: memoria insuficiente (buffer de saida).\n"); exit(1); }
+            vsnprintf(tmp, (size_t) n + 1, fmt, copia);
+            fwrite(tmp, 1, (size_t) n, b->destino);
+            memLiberar(tmp);
+            n = 0;
+        }
+    }
+    va_end(copia);
+    if (n > 0) b->usado += (size_t) n;
+}
+
+void bufTexto(BufferSaida *b, const char *s) {
+    bufEscrever(b, s, strlen(s));
+}
+
+static void bufNumero(BufferSaida *b, size_t v) {
+    char tmp[24];
+    int n = snprintf(tmp, sizeof tmp, "%zu", v);
+    bufEscrever(b, tmp, (size_t) n);
+}
+
+// string JSON entre aspas; escapa aspas, barra invertida e caracteres de controle
+// (bytes UTF-8 passam sem alteracao)
+static void bufJson(BufferSaida *b, const char *s) {
+    static const char hex[] = "0123456789abcdef";
+    bufEscrever(b, "\"", 1);
+    const char *ini = s;
+    for (; *s != '\0'; ++s) {
+        unsigned char ch = (unsigned char) *s;
+        if (ch >= 0x20 && ch != '"' && ch != '\\') continue;
+        bufEscrever(b, ini, (size_t) (s - ini));
+        char esc[6] = { '\\', (char) ch, 0, 0, 0, 0 };
+        size_t n = 2;
+        if (ch < 0x20) {
+            memcpy(esc + 1, "u00", 3);
+            esc[4] = hex[ch >> 4];
+            esc[5] = hex[ch & 15];
+            n = 6;
+        }
+        bufEscrever(b, esc, n);
+        ini = s + 1;
+    }
+    bufEscrever(b, ini, (size_t) (s - ini));
+    bufEscrever(b, "\"", 1);
+}
+
+// escreve os suspeitos que a pista implica: "A" se for um so com peso 1, senao "A (2), B (1)"
+void bufSuspeitos(BufferSaida *b, const HashTable *ht, const HashEntrada *e) {
+    const Postagem *p = suspeitosDaPista(ht, e);
+    int comPeso = e->suspeitos.quantidade > 1 || p[0].peso != 1;
+    for (uint32_t k = 0; k < e->suspeitos.quantidade; ++k) {
+        if (k > 0) bufTexto(b, ", ");
+        bufTexto(b, textoInterno(ht->textos, ht->nomeSuspeito[p[k].id]));
+        if (comPeso) {
+            bufTexto(b, " (");
+            bufNumero(b, p[k].peso);
+            bufEscrever(b, ")", 1);
+        }
+    }
+}
+
+// escreverPaginaPistas() – acrescenta ao buffer ate 'maxItens' pistas do cursor
+// texto:  "- <pista>" (com " -> <suspeito>[ (peso)], ..." se 'ht' for informada)
+// json:   {"n":<ordem>,"pista":"...","suspeito":"..."|null,"suspeitos":[{"nome":"...","peso":<p>},...]}
+//         (uma linha por pista; "suspeito" e o que a pista mais implica)
+// retorna quantas pistas foram escritas (0 = cursor esgotado)
+size_t escreverPaginaPistas(CursorPistas *c, const HashTable *ht, BufferSaida *b,
+                            FormatoRelatorio formato, size_t maxItens) {
+    size_t escritas = 0;
+    const InternPool *textos = c->arv->textos;
+    uint32_t id;
+    while (escritas < maxItens && (id = proximaPista(c)) != TEXTO_VAZIO) {
+        const HashEntrada *e = ht != NULL ? encontrarEntrada(ht, id) : NULL;
+        if (formato == RELATORIO_JSON) {
+            bufTexto(b, "{\"n\":");
+            bufNumero(b, c->lidas);
+            bufTexto(b, ",\"pista\":");
+            bufJson(b, textoInterno(textos, id));
+            if (ht != NULL) {
+                bufTexto(b, ",\"suspeito\":");
+                if (e != NULL) bufJson(b, textoInterno(textos, ht->nomeSuspeito[suspeitoPrincipal(ht, e)]));
+                else bufTexto(b, "null");
+                bufTexto(b, ",\"suspeitos\":[");
+                for (uint32_t k = 0; e != NULL && k < e->suspeitos.quantidade; ++k) {
+                    const Postagem *ps = &suspeitosDaPista(ht, e)[k];
+                    bufTexto(b, k > 0 ? ",{\"nome\":" : "{\"nome\":");
+                    bufJson(b, textoInterno(textos, ht->nomeSuspeito[ps->id]));
+                    bufTexto(b, ",\"peso\":");
+                    bufNumero(b, ps->peso);
+                    bufEscrever(b, "}", 1);
+                }
+                bufEscrever(b, "]", 1);
+            }
+            bufTexto(b, "}\n");
+        } else {
+            bufTexto(b, "- ");
+            bufTexto(b, textoInterno(textos, id));
+            if (e != NULL) {
+                bufTexto(b, " -> ");
+                bufSuspeitos(b, ht, e);
+            }
+            bufEscrever(b, "\n", 1);
+        }
+        escritas++;
+    }
+    return escritas;
+}
+
+// relatorioPistas() – escreve as pistas da faixa [de, ate] que comecam com 'prefixo'
+// (qualquer um deles pode ser NULL), uma pagina de PAGINA_PISTAS por vez no buffer 'b'
+// retorna o numero de pistas escritas
+size_t relatorioPistas(const ArvorePistas *arv, const HashTable *ht, BufferSaida *b,
+                       FormatoRelatorio formato, const char *de, const char *ate, const char *prefixo) {
+    CursorPistas c;
+    if (prefixo != NULL && (de == NULL || strcmp(de, prefixo) < 0)) de = prefixo;
+    abrirCursor(&c, arv, de, ate);
+    c.prefixo = prefixo;
+    c.tamPrefixo = prefixo != NULL ? strlen(prefixo) : 0;
+    while (escreverPaginaPistas(&c, ht, b, formato, PAGINA_PISTAS) == PAGINA_PISTAS)
+        descarregarBuffer(b);
+    descarregarBuffer(b);
+    return c.lidas;
+}
+
+// exibirPistasInOrder - imprime as pistas em ordem alfabetica (uma escrita por pagina)
+void exibirPistasInOrder(const ArvorePistas *arv) {
+    char memoria[BUFFER_SAIDA];
+    BufferSaida b;
+    inicializarBufferSaida(&b, stdout, memoria, sizeof memoria);
+    relatorioPistas(arv, NULL, &b, RELATORIO_TEXTO, NULL, NULL, NULL);
+}
+
+// =========================
+// ENTRADA BUFERIZADA
+// =========================
+
+
+void inicializarLeitor(LeitorEntrada *l, int fd) {
+    l->fd = fd;
+    l->terminou = 0;
+    l->descartando = 0;
+    l->ini = l->fim = 0;
+}
+
+// lerLinhaEntrada() – entrega em '*linha' a proxima linha, sem o '\n' e terminada em '\0'
+// (valida ate a proxima chamada). Le do descritor em blocos de ate BUFFER_ENTRADA bytes, entao
+// varias linhas chegam com um unico read. Retorna LINHA_PENDENTE se o descritor e nao
+// bloqueante e ainda nao ha linha completa; LINHA_FIM no fim da entrada (a ultima linha, mesmo
+// sem '\n', e entregue antes)
+ResultadoLinha lerLinhaEntrada(LeitorEntrada *l, char **linha, size_t *tam) {
+    for (;;) {
+        char *nl = (char*) memchr(l->dados + l->ini, '\n', l->fim - l->ini);
+        if (nl != NULL) {
+            char *inicio = l->dados + l->ini;
+            l->ini = (size_t) (nl - l->dados) + 1;
+            if (l->descartando) { // resto de uma linha longa
+                l->descartando = 0;
+                continue;
+            }
+            *nl = '\0';
+            *linha = inicio;
+            *tam = (size_t) (nl - inicio);
+            return LINHA_OK;
+        }
+        if (l->terminou) {
+            if (l->ini == l->fim || l->descartando) {
+                l->ini = l->fim = 0;
+                return LINHA_FIM;
+            }
+            l->dados[l->fim] = '\0';
+            *linha = l->dados + l->ini;
+            *tam = l->fim - l->ini;
+            l->ini = l->fim;
+            return LINHA_OK;
+        }
+        // sem linha completa: junta o resto no inicio e le mais
+        if (l->ini > 0) {
+            memmove(l->dados, l->dados + l->ini, l->fim - l->ini);
+            l->fim -= l->ini;
+            l->ini = 0;
+        }
+        if (l->fim == sizeof l->dados - 1) {
+            // linha maior que o buffer: entrega o que coube e descarta o resto dela
+            int entregar = !l->descartando;
+            l->dados[l->fim] = '\0';
+            *linha = l->dados;
+            *tam = l->fim;
+            l->fim = 0;
+            l->descartando = 1;
+            if (entregar) return LINHA_OK;
+        }
+        ssize_t r = read(l->fd, l->dados + l->fim, sizeof l->dados - 1 - l->fim);
+        if (r > 0) {
+            l->fim += (size_t) r;
+        } else if (r == 0) {
+            l->terminou = 1;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return LINHA_PENDENTE;
+        } else if (errno != EINTR) {
+            l->terminou = 1;
+        }
+    }
+}
+
+// =========================
+// CONTADORES DE EVIDENCIAS
+// =========================
+
+
+// limiarDoCaso() – pontos que condenam: 'pedido' (--limiar) se houver, senao o do mapa,
+// senao LIMIAR_CULPA
+uint32_t limiarDoCaso(const Mansao *m, uint32_t pedido) {
+    return pedido > 0 ? pedido : m->limiar > 0 ? m->limiar : LIMIAR_CULPA;
+}
+
+// inicializa os contadores zerados para os suspeitos ja cadastrados na hash
+void inicializarEvidencias(Evidencias *ev, const HashTable *ht, uint32_t limiar) {
+    ev->numSuspeitos = ht->numSuspeitos;
+    ev->limiar = limiar;
+    ev->pontos = (uint32_t*) memZerada(MEM_EVIDENCIAS, ev->numSuspeitos ? ev->numSuspeitos : 1, sizeof(uint32_t));
+    if (ev->pontos == NULL) { printf("Erro: memoria insuficiente (evidencias).\n"); exit(1); }
+}
+
+// acompanha suspeitos cadastrados depois que os contadores foram criados
+static void ajustarEvidencias(Evidencias *ev, const HashTable *ht) {
+    if (ht->numSuspeitos <= ev->numSuspeitos) return;
+    uint32_t novo = ht->numSuspeitos;
+    ev->pontos = (uint32_t*) memRealocar(MEM_EVIDENCIAS, ev->pontos, novo * sizeof(uint32_t));
+    if (ev->pontos == NULL) { printf("Erro: memoria insuficiente (evidencias).\n"); exit(1); }
+    memset(ev->pontos + ev->numSuspeitos, 0, (novo - ev->numSuspeitos) * sizeof(uint32_t));
+    ev->numSuspeitos = novo;
+}
+
+// soma os pesos da pista aos suspeitos que ela implica
+static inline void somarPista(Evidencias *ev, const HashTable *ht, uint32_t pista) {
+    const HashEntrada *e = encontrarEntrada(ht, pista);
+    if (e == NULL) return;
+    const Postagem *p = suspeitosDaPista(ht, e);
+    for (uint32_t k = 0; k < e->suspeitos.quantidade; ++k) ev->pontos[p[k].id] += p[k].peso;
+}
+
+// registrarEvidencia() – soma a evidencia de uma pista recem-coletada
+// deve ser chamada apenas quando a pista e nova na colecao (inserirPistaId retornou 1)
+void registrarEvidencia(Evidencias *ev, const HashTable *ht, uint32_t pista) {
+    ajustarEvidencias(ev, ht);
+    somarPista(ev, ht, pista);
+}
+
+// pontuarSuspeitos() – recalcula os pontos de todos os suspeitos numa unica passada pelas
+// 'n' pistas coletadas; custo O(suspeitos + postagens das pistas), sem busca por suspeito
+void pontuarSuspeitos(Evidencias *ev, const HashTable *ht, const uint32_t *pistas, size_t n) {
+    ajustarEvidencias(ev, ht);
+    memset(ev->pontos, 0, ev->numSuspeitos * sizeof(uint32_t));
+    for (size_t i = 0; i < n; ++i) somarPista(ev, ht, pistas[i]);
+}
+
+// indice denso do suspeito pelo nome (sem diferenciar maiusculas); UINT32_MAX se nao existir
+uint32_t suspeitoPorNome(const HashTable *ht, const char *nome) {
+    char lower[MAXPISTA];
+    strToLower(nome, lower);
+    uint32_t chave = buscarInterno(ht->textos, lower, MAXNOME);
+    return chave != UINT32_MAX ? indiceSuspeito(ht, chave) : UINT32_MAX;
+}
+
+// evidenciasContra() – pontos das pistas coletadas contra o suspeito (nome sem diferenciar maiusculas)
+// O(1): uma busca do nome na tabela de textos e outra no indice de suspeitos
+uint32_t evidenciasContra(const Evidencias *ev, const HashTable *ht, const char *nome) {
+    uint32_t idx = suspeitoPorNome(ht, nome);
+    return idx < ev->numSuspeitos ? ev->pontos[idx] : 0;
+}
+
+static int compararRanking(const void *a, const void *b) {
+    const ItemRanking *x = (const ItemRanking*) a, *y = (const ItemRanking*) b;
+    if (x->evidencias != y->evidencias) return x->evidencias > y->evidencias ? -1 : 1;
+    return x->idxSuspeito < y->idxSuspeito ? -1 : (x->idxSuspeito > y->idxSuspeito);
+}
+
+// rankingSuspeitos() – preenche 'saida' (ht->numSuspeitos itens) com os suspeitos
+// em ordem decrescente de evidencias; empates ficam na ordem de cadastro
+void rankingSuspeitos(const Evidencias *ev, const HashTable *ht, ItemRanking *saida) {
+    for (uint32_t i = 0; i < ht->numSuspeitos; ++i) {
+        saida[i].idxSuspeito = i;
+        saida[i].evidencias = i < ev->numSuspeitos ? ev->pontos[i] : 0;
+    }
+    qsort(saida, ht->numSuspeitos, sizeof(ItemRanking), compararRanking);
+}
+
+// imprime o ranking de suspeitos por pontos de evidencia (os RANKING_EXIBIDOS primeiros)
+void escreverRanking(BufferSaida *b, const Evidencias *ev, const HashTable *ht) {
+    if (ht->numSuspeitos == 0) return;
+    ItemRanking *itens = (ItemRanking*) memAlocar(MEM_EVIDENCIAS, ht->numSuspeitos * sizeof(ItemRanking));
+    if (itens == NULL) { printf("Erro: memoria insuficiente (ranking).\n"); exit(1); }
+    rankingSuspeitos(ev, ht, itens);
+    bufTexto(b, "\n===== RANKING DE SUSPEITOS =====\n");
+    uint32_t exibir = ht->numSuspeitos < RANKING_EXIBIDOS ? ht->numSuspeitos : RANKING_EXIBIDOS;
+    for (uint32_t i = 0; i < exibir; ++i)
+        bufFormatar(b, "%u. %s: %u ponto(s)\n", i + 1,
+                    textoInterno(ht->textos, ht->nomeSuspeito[itens[i].idxSuspeito]), itens[i].evidencias);
+    if (exibir < ht->numSuspeitos) bufFormatar(b, "(... e mais %u suspeito(s))\n", ht->numSuspeitos - exibir);
+    memLiberar(itens);
+}
+
+void liberarEvidencias(Evidencias *ev) {
+    memLiberar(ev->pontos);
+    ev->pontos = NULL;
+    ev->numSuspeitos = 0;
+}
+
+// =========================
+// INDICE DE NOMES DE SUSPEITOS
+// =========================
+
+
+// letras acentuadas do Latin-1 (segundo byte de U+00C0..U+00FF em UTF-8, 0x80..0xBF) sem acento;
+// '_' descarta o caractere
+static const char SEM_ACENTO[64] = "aaaaaaaceeeeiiiidnooooo_ouuuuy_saaaaaaaceeeeiiiidnooooo_ouuuuy_y";
+
+// normalizarNome() – minusculas, sem acentos, pontuacao e espacos repetidos viram um espaco
+// ("  Sr. JOAO da Silva!" -> "sr joao da silva"); retorna o tamanho do resultado
+size_t normalizarNome(const char *src, char *dst, size_t cap) {
+    const unsigned char *p = (const unsigned char*) src;
+    size_t n = 0;
+    int espaco = 0;
+    for (; *p != '\0' && n + 2 < cap; ++p) {
+        unsigned char c = *p;
+        char saida = 0;
+        if (c >= 'A' && c <= 'Z') saida = (char) (c + 32);
+        else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) saida = (char) c;
+        else if (c == 0xC3 && p[1] >= 0x80 && p[1] <= 0xBF) {
+            saida = SEM_ACENTO[*++p - 0x80];
+            if (saida == '_') saida = 0;
+        } else if (c >= 0x80) {
+            while ((p[1] & 0xC0) == 0x80) ++p; // outro caractere UTF-8: descarta
+            continue;
+        } else {
+            espaco = n > 0;
+            continue;
+        }
+        if (saida == 0) continue;
+        if (espaco) dst[n++] = ' ';
+        espaco = 0;
+        dst[n++] = saida;
+    }
+    dst[n] = '\0';
+    return n;
+}
+
+// chaves pelo texto normalizado (em 'ctx') e, no empate, pelo suspeito
+static int compararChaveNome(const void *a, const void *b, void *ctx) {
+    const char *textos = (const char*) ctx;
+    const ChaveNome *x = (const ChaveNome*) a, *y = (const ChaveNome*) b;
+    int c = strcmp(textos + x->texto, textos + y->texto);
+    if (c != 0) return c;
+    return (x->idxSuspeito > y->idxSuspeito) - (x->idxSuspeito < y->idxSuspeito);
+}
+
+void* alocarIndiceNomes(size_t n, size_t tam) {
+    void *p = memAlocar(MEM_NOMES, (n ? n : 1) * tam);
+    if (p == NULL) { printf("Erro: memoria insuficiente (indice de nomes).\n"); exit(1); }
+    return p;
+}
+
+// construirIndiceNomes() – normaliza os nomes dos suspeitos cadastrados, ordena as chaves
+// (nome inteiro e cada fim de nome a partir de uma palavra) e monta a trie em largura a partir
+// dos trechos ordenados; custo O(chaves log chaves + caracteres)
+void construirIndiceNomes(IndiceNomes *ix, const HashTable *ht) {
+    memset(ix, 0, sizeof *ix);
+    uint32_t numSus = ht->numSuspeitos;
+    ix->numSuspeitos = numSus;
+    ix->marca = (uint32_t*) memZerada(MEM_NOMES, numSus ? numSus : 1, sizeof(uint32_t));
+    ix->textos = (char*) alocarIndiceNomes((size_t) numSus * MAXNOME + 1, 1);
+    if (ix->marca == NULL) { printf("Erro: memoria insuficiente (indice de nomes).\n"); exit(1); }
+
+    // textos normalizados e contagem de chaves (uma por palavra)
+    size_t usado = 0, numChaves = 0;
+    uint32_t *inicio = (uint32_t*) alocarIndiceNomes(numSus, sizeof(uint32_t));
+    for (uint32_t s = 0; s < numSus; ++s) {
+        inicio[s] = (uint32_t) usado;
+        size_t n = normalizarNome(textoInterno(ht->textos, ht->nomeSuspeito[s]), ix->textos + usado, MAXNOME);
+        for (size_t i = 0; i < n; ++i) numChaves += (i == 0 || ix->textos[usado + i - 1] == ' ');
+        usado += n + 1;
+    }
+    ix->chaves = (ChaveNome*) alocarIndiceNomes(numChaves, sizeof(ChaveNome));
+    for (uint32_t s = 0; s < numSus; ++s)
+        for (uint32_t i = inicio[s]; ix->textos[i] != '\0'; ++i)
+            if (i == inicio[s] || ix->textos[i - 1] == ' ') {
+                ix->chaves[ix->numChaves].texto = i;
+                ix->chaves[ix->numChaves++].idxSuspeito = s;
+            }
+    memLiberar(inicio);
+    qsort_r(ix->chaves, ix->numChaves, sizeof(ChaveNome), compararChaveNome, ix->textos);
+
+    // trie: cada no guarda o trecho de chaves com o seu prefixo; os nos sao processados na
+    // ordem em que foram criados (largura), e os filhos de um no sao criados juntos
+    size_t capNos = 1;
+    for (uint32_t k = 0; k < ix->numChaves; ++k) capNos += strlen(ix->textos + ix->chaves[k].texto);
+    ix->nos = (NoNome*) alocarIndiceNomes(capNos, sizeof(NoNome));
+    uint8_t *prof = (uint8_t*) alocarIndiceNomes(capNos, 1);
+    ix->nos[0] = (NoNome) { 0, 0, ix->numChaves, 0, 0 };
+    prof[0] = 0;
+    ix->numNos = 1;
+    for (uint32_t v = 0; v < ix->numNos; ++v) {
+        NoNome *no = &ix->nos[v];
+        uint32_t d = prof[v], k = no->lo;
+        while (k < no->hi && ix->textos[ix->chaves[k].texto + d] == '\0') k++; // terminam aqui
+        no->filhos = ix->numNos;
+        while (k < no->hi) {
+            char c = ix->textos[ix->chaves[k].texto + d];
+            uint32_t fim = k;
+            while (fim < no->hi && ix->textos[ix->chaves[fim].texto + d] == c) fim++;
+            ix->nos[ix->numNos] = (NoNome) { 0, k, fim, 0, c };
+            prof[ix->numNos++] = (uint8_t) (d + 1);
+            no->numFilhos++;
+            k = fim;
+        }
+    }
+    memLiberar(prof);
+}
+
+// filho de 'v' com o simbolo 'c', ou UINT32_MAX
+static inline uint32_t filhoNome(const IndiceNomes *ix, uint32_t v, char c) {
+    const NoNome *no = &ix->nos[v];
+    for (uint32_t k = 0; k < no->numFilhos; ++k) {
+        char s = ix->nos[no->filhos + k].simbolo;
+        if (s == c) return no->filhos + k;
+        if (s > c) break;
+    }
+    return UINT32_MAX;
+}
+
+// fim do trecho de chaves que terminam exatamente no no 'v'
+static inline uint32_t fimExatas(const IndiceNomes *ix, uint32_t v) {
+    const NoNome *no = &ix->nos[v];
+    return no->numFilhos > 0 ? ix->nos[no->filhos].lo : no->hi;
+}
+
+// acrescenta a 'saida' os suspeitos distintos das chaves [lo, hi) ate juntar 'max'; retorna quantos ha
+static uint32_t coletarSuspeitos(IndiceNomes *ix, uint32_t lo, uint32_t hi, uint32_t *saida, uint32_t n, uint32_t max) {
+    for (uint32_t k = lo; k < hi && n < max; ++k) {
+        uint32_t s = ix->chaves[k].idxSuspeito;
+        if (ix->marca[s] == ix->epoca) continue;
+        ix->marca[s] = ix->epoca;
+        saida[n++] = s;
+    }
+    return n;
+}
+
+static void novaEpocaNomes(IndiceNomes *ix) {
+    if (++ix->epoca == 0) {
+        memset(ix->marca, 0, (ix->numSuspeitos ? ix->numSuspeitos : 1) * sizeof(uint32_t));
+        ix->epoca = 1;
+    }
+}
+
+// no da trie com o texto normalizado 'chave', ou UINT32_MAX
+static uint32_t descerNome(const IndiceNomes *ix, const char *chave) {
+    uint32_t v = 0;
+    for (const char *c = chave; *c != '\0' && v != UINT32_MAX; ++c) v = filhoNome(ix, v, *c);
+    return v;
+}
+
+// completarNome() – suspeitos (ate 'max', sem repetir) com um nome ou fim de nome que comeca
+// com 'prefixo'; uma descida pela trie mais 'max' chaves
+uint32_t completarNome(IndiceNomes *ix, const char *prefixo, uint32_t *saida, uint32_t max) {
+    char chave[MAXNOME];
+    normalizarNome(prefixo, chave, sizeof chave);
+    uint32_t v = descerNome(ix, chave);
+    if (v == UINT32_MAX || ix->numChaves == 0) return 0;
+    novaEpocaNomes(ix);
+    return coletarSuspeitos(ix, ix->nos[v].lo, ix->nos[v].hi, saida, 0, max);
+}
+
+// percorre a trie com uma linha da tabela de Levenshtein por nivel contra o texto normalizado
+// 'q' (tamanho 'm') e poda os ramos cuja linha ja passou de 'limite'
+static uint32_t buscarComLimite(IndiceNomes *ix, const char *q, uint32_t m, uint32_t limite,
+                                uint32_t *saida, uint32_t max, uint32_t *dist) {
+    uint8_t linhas[MAXNOME + 1][MAXNOME + 1];
+    uint32_t pilha[MAXNOME * 40], topo = 0, melhor = limite + 1, n = 0;
+    for (uint32_t j = 0; j <= m; ++j) linhas[0][j] = (uint8_t) (j <= limite ? j : limite + 1);
+    uint8_t profNo[MAXNOME * 40];
+    for (uint32_t k = ix->nos[0].numFilhos; k-- > 0; ) {
+        pilha[topo] = ix->nos[0].filhos + k;
+        profNo[topo++] = 1;
+    }
+    while (topo > 0) {
+        uint32_t v = pilha[--topo], d = profNo[topo];
+        const NoNome *no = &ix->nos[v];
+        uint8_t *ant = linhas[d - 1], *lin = linhas[d];
+        // so a faixa |d - j| <= limite pode ficar dentro do limite; as celulas vizinhas da
+        // faixa valem limite + 1 e servem de sentinela para a linha seguinte
+        uint32_t lo = d > limite ? d - limite : 1, hi = d + limite < m ? d + limite : m;
+        uint32_t minimo = limite + 1;
+        lin[lo - 1] = (uint8_t) (lo == 1 ? d : limite + 1);
+        if (lo - 1 == 0 && d < minimo) minimo = d;
+        for (uint32_t j = lo; j <= hi; ++j) {
+            uint32_t custo = ant[j - 1] + (q[j - 1] != no->simbolo);
+            if (ant[j] + 1u < custo) custo = ant[j] + 1u;
+            if (lin[j - 1] + 1u < custo) custo = lin[j - 1] + 1u;
+            lin[j] = (uint8_t) custo;
+            if (custo < minimo) minimo = custo;
+        }
+        if (hi < m) lin[hi + 1] = (uint8_t) (limite + 1);
+        if (minimo > limite || minimo > melhor) continue; // nenhuma extensao chega ao limite
+        if (hi == m && fimExatas(ix, v) > no->lo && lin[m] <= melhor) {
+            if (lin[m] < melhor) { melhor = lin[m]; n = 0; novaEpocaNomes(ix); }
+            n = coletarSuspeitos(ix, no->lo, fimExatas(ix, v), saida, n, max);
+        }
+        if (d >= MAXNOME - 1) continue;
+        for (uint32_t k = no->numFilhos; k-- > 0; ) {
+            pilha[topo] = no->filhos + k;
+            profNo[topo++] = (uint8_t) (d + 1);
+        }
+    }
+    *dist = melhor;
+    return melhor <= limite ? n : 0;
+}
+
+// buscarNomeAproximado() – suspeitos cujo nome (ou fim de nome) esta a menor distancia de edicao
+// de 'nome', se ela for <= 'limite'. Tenta os limites em ordem crescente: um erro de digitacao
+// so explora a vizinhanca de distancia 1, bem menor que a de distancia 2. Retorna quantos
+// candidatos foram postos em 'saida' (ate 'max') e a distancia em '*dist'
+uint32_t buscarNomeAproximado(IndiceNomes *ix, const char *nome, uint32_t limite,
+                              uint32_t *saida, uint32_t max, uint32_t *dist) {
+    char q[MAXNOME];
+    uint32_t m = (uint32_t) normalizarNome(nome, q, sizeof q);
+    *dist = limite + 1;
+    if (ix->numChaves == 0 || m == 0) return 0;
+    if (limite > MAXNOME) limite = MAXNOME;
+    for (uint32_t l = 0; l <= limite; ++l) {
+        uint32_t n = buscarComLimite(ix, q, m, l, saida, max, dist);
+        if (n > 0) return n;
+    }
+    *dist = limite + 1;
+    return 0;
+}
+
+// resolverNomeAcusado() – reconhece o nome digitado: igual a um cadastrado, igual depois de
+// normalizar (ou ao fim do nome: "silva"), prefixo de um so suspeito ou, por fim, a ate 1 edicao
+// (nomes curtos) ou 2 edicoes. Com mais de um candidato devolve NOME_AMBIGUO e os candidatos
+ResultadoNome resolverNomeAcusado(IndiceNomes *ix, const HashTable *ht, const char *nome,
+                                  uint32_t *candidatos, uint32_t max, uint32_t *numCandidatos) {
+    *numCandidatos = 0;
+    uint32_t idx = suspeitoPorNome(ht, nome);
+    if (idx != UINT32_MAX) {
+        candidatos[0] = idx;
+        *numCandidatos = 1;
+        return NOME_EXATO;
+    }
+    char chave[MAXNOME];
+    size_t tam = normalizarNome(nome, chave, sizeof chave);
+    if (tam == 0 || ix->numChaves == 0) return NOME_DESCONHECIDO;
+    uint32_t v = descerNome(ix, chave);
+    ResultadoNome r = NOME_DESCONHECIDO;
+    if (v != UINT32_MAX) {
+        novaEpocaNomes(ix);
+        *numCandidatos = coletarSuspeitos(ix, ix->nos[v].lo, fimExatas(ix, v), candidatos, 0, max);
+        r = NOME_NORMALIZADO;
+        if (*numCandidatos == 0) {
+            *numCandidatos = coletarSuspeitos(ix, ix->nos[v].lo, ix->nos[v].hi, candidatos, 0, max);
+            r = NOME_PREFIXO;
+        }
+    } else {
+        uint32_t dist;
+        *numCandidatos = buscarNomeAproximado(ix, nome, tam <= 6 ? 1 : 2, candidatos, max, &dist);
+        r = NOME_APROXIMADO;
+    }
+    if (*numCandidatos == 0) return NOME_DESCONHECIDO;
+    return *numCandidatos == 1 ? r : NOME_AMBIGUO;
+}
+
+void liberarIndiceNomes(IndiceNomes *ix) {
+    memLiberar(ix->nos);
+    memLiberar(ix->chaves);
+    memLiberar(ix->textos);
+    memLiberar(ix->marca);
+    memset(ix, 0, sizeof *ix);
+}
+
+// =========================
+// SESSOES DE INVESTIGACAO
+// =========================
+
+
+// marcarVisita() – inclui a sala no conjunto; retorna 1 se ela ainda nao estava
+int marcarVisita(ConjuntoSalas *c, int32_t sala) {
+    if ((c->quantidade + 1) * 2 > c->cap) {
+        uint32_t capAntiga = c->cap, *antigos = c->itens;
+        c->cap = capAntiga ? capAntiga * 2 : 16;
+        c->itens = (uint32_t*) memZerada(MEM_SESSOES, c->cap, sizeof(uint32_t));
+        if (c->itens == NULL) { printf("Erro: memoria insuficiente (salas visitadas).\n"); exit(1); }
+        for (uint32_t k = 0; k < capAntiga; ++k) {
+            if (antigos[k] == 0) continue;
+            uint32_t i = hashId(antigos[k]) & (c->cap - 1);
+            while (c->itens[i] != 0) i = (i + 1) & (c->cap - 1);
+            c->itens[i] = antigos[k];
+        }
+        memLiberar(antigos);
+    }
+    uint32_t chave = (uint32_t) sala + 1, i = hashId(chave) & (c->cap - 1);
+    while (c->itens[i] != 0) {
+        if (c->itens[i] == chave) return 0;
+        i = (i + 1) & (c->cap - 1);
+    }
+    c->itens[i] = chave;
+    c->quantidade++;
+    return 1;
+}
+
+// salaMarcada() – 1 se a sala ja esta no conjunto (sem incluir)
+int salaMarcada(const ConjuntoSalas *c, int32_t sala) {
+    if (c->quantidade == 0) return 0;
+    uint32_t chave = (uint32_t) sala + 1, i = hashId(chave) & (c->cap - 1);
+    while (c->itens[i] != 0) {
+        if (c->itens[i] == chave) return 1;
+        i = (i + 1) & (c->cap - 1);
+    }
+    return 0;
+}
+
+void limparVisitas(ConjuntoSalas *c) {
+    if (c->quantidade > 0) memset(c->itens, 0, c->cap * sizeof(uint32_t));
+    c->quantidade = 0;
+}
+
+// iniciarSessao() – prepara uma investigacao na sala inicial, ainda sem coletar a pista dela
+void iniciarSessao(Sessao *se, const Mansao *m, const HashTable *ht, uint32_t limiar) {
+    se->salaAtual = m->raiz;
+    se->movimentos = 0;
+    inicializarPistas(&se->pistas, ht->textos);
+    inicializarEvidencias(&se->ev, ht, limiar);
+    se->coletadas = NULL;
+    se->capColetadas = 0;
+    se->salvas = se->movimentosSalvos = 0;
+    se->snapshotPendente = 1;
+    memset(&se->visitadas, 0, sizeof se->visitadas);
+    se->trilha = NULL;
+    se->inicioTrilha = se->profTrilha = se->capTrilha = 0;
+    se->trilhaMantida = se->trilhaDescartada = 0;
+}
+
+// volta a sessao para a sala inicial reaproveitando a memoria ja alocada
+void reiniciarSessao(Sessao *se, const Mansao *m) {
+    se->salaAtual = m->raiz;
+    se->movimentos = 0;
+    limparPistas(&se->pistas);
+    memset(se->ev.pontos, 0, se->ev.numSuspeitos * sizeof(uint32_t));
+    se->salvas = se->movimentosSalvos = 0;
+    se->snapshotPendente = 1;
+    limparVisitas(&se->visitadas);
+    se->inicioTrilha = se->profTrilha = 0;
+    se->trilhaMantida = se->trilhaDescartada = 0;
+}
+
+// garante espaco para 'n' ids na lista de pistas em ordem de coleta
+static void reservarColetadas(Sessao *se, uint64_t n) {
+    if (n <= se->capColetadas) return;
+    uint64_t nova = se->capColetadas ? se->capColetadas : 16;
+    while (nova < n) nova *= 2;
+    if (nova > UINT32_MAX) { printf("Erro: pistas demais na sessao.\n"); exit(1); }
+    uint32_t *v = (uint32_t*) memRealocar(MEM_SESSOES, se->coletadas, nova * sizeof(uint32_t));
+    if (v == NULL) { printf("Erro: memoria insuficiente (sessao).\n"); exit(1); }
+    se->coletadas = v;
+    se->capColetadas = (uint32_t) nova;
+}
+
+// guarda o id na ordem de coleta (o diario grava so o que veio depois do ultimo registro)
+static void anotarColeta(Sessao *se, uint32_t pista) {
+    uint32_t n = (uint32_t) se->pistas.total - 1;
+    reservarColetadas(se, (uint64_t) n + 1);
+    se->coletadas[n] = pista;
+}
+
+// coletarPistaSala() – coleta a pista da sala atual; retorna 1 se ela era nova
+// salas ja visitadas sao ignoradas sem consultar a AVL (em mapas com ciclos o jogador volta a elas)
+int coletarPistaSala(Sessao *se, const Mansao *m, const HashTable *ht) {
+    uint32_t pista = m->salas[se->salaAtual].pista;
+    if (pista == TEXTO_VAZIO || !marcarVisita(&se->visitadas, se->salaAtual)) return 0;
+    INSTR_INICIO(t0);
+    int nova = inserirPistaId(&se->pistas, pista);
+    INSTR_FIM(MED_INSERIR_PISTA, t0);
+    if (!nova) return 0;
+    anotarColeta(se, pista);
+    registrarEvidencia(&se->ev, ht, pista);
+    return 1;
+}
+
+// salaAnterior() – sala para onde 'v' volta (a ultima da trilha); -1 se a trilha esta vazia
+int32_t salaAnterior(const Sessao *se) {
+    if (se->profTrilha == 0) return -1;
+    return se->trilha[(se->inicioTrilha + se->profTrilha - 1) & (se->capTrilha - 1)];
+}
+
+// sala 'i' da trilha, contando do fundo (a mais antiga que ainda da para voltar)
+static int32_t salaTrilha(const Sessao *se, uint32_t i) {
+    return se->trilha[(se->inicioTrilha + i) & (se->capTrilha - 1)];
+}
+
+// salaMaisAntiga() – fundo da trilha (a sala atual se ela esta vazia): cada sala da trilha tem uma
+// saida para a seguinte, entao tudo o que a sessao alcanca, com saidas e 'v', se alcanca dali
+int32_t salaMaisAntiga(const Sessao *se) {
+    return se->profTrilha > 0 ? salaTrilha(se, 0) : se->salaAtual;
+}
+
+// esquece as 'n' salas mais antigas da trilha
+static void descartarFundoTrilha(Sessao *se, uint32_t n) {
+    if (n > se->profTrilha) n = se->profTrilha;
+    if (se->capTrilha > 0) se->inicioTrilha = (se->inicioTrilha + n) & (se->capTrilha - 1);
+    se->profTrilha -= n;
+    se->trilhaDescartada += n;
+    se->trilhaMantida = se->trilhaMantida > n ? se->trilhaMantida - n : 0;
+}
+
+// guarda 'sala' no topo da trilha: a capacidade dobra ate TRILHA_MAX e, cheia, a sala mais antiga
+// da lugar a nova (em mapas com ciclos o jogador anda sem fim, mas so volta ate TRILHA_MAX salas)
+static void empilharTrilha(Sessao *se, int32_t sala) {
+    if (se->profTrilha == se->capTrilha) {
+        if (se->capTrilha < TRILHA_MAX) {
+            // o anel so da a volta quando esta cheio em TRILHA_MAX: aqui ainda comeca em 0
+            uint32_t nova = se->capTrilha ? se->capTrilha * 2 : 16;
+            int32_t *v = (int32_t*) memRealocar(MEM_SESSOES, se->trilha, nova * sizeof(int32_t));
+            if (v == NULL) { printf("Erro: memoria insuficiente (sessao).\n"); exit(1); }
+            se->trilha = v;
+            se->capTrilha = nova;
+        } else {
+            descartarFundoTrilha(se, 1);
+        }
+    }
+    se->trilha[(se->inicioTrilha + se->profTrilha++) & (se->capTrilha - 1)] = sala;
+}
+
+// segue a saida 'k' (a partir de 0) da sala atual, guardando a sala de onde saiu
+static ResultadoMovimento seguirSaida(Sessao *se, const Mansao *m, uint32_t k) {
+    int32_t destino = saidaSala(m, se->salaAtual, k);
+    if (!salaValida(m, destino)) return MOV_INVALIDO;
+    empilharTrilha(se, se->salaAtual);
+    se->salaAtual = destino;
+    return MOV_OK;
+}
+
+// moverParaSaida() – escolhe a saida 'k' (a partir de 0) pelo numero
+ResultadoMovimento moverParaSaida(Sessao *se, const Mansao *m, uint32_t k) {
+    se->movimentos++;
+    return seguirSaida(se, m, k);
+}
+
+// moverSessao() – aplica a escolha a partir da sala atual:
+// 'e'/'d' = saidas 1 e 2, '1'..'9' = saida pelo numero, 'v' = volta a sala anterior, 's' = sair
+ResultadoMovimento moverSessao(Sessao *se, const Mansao *m, char escolha) {
+    se->movimentos++;
+    if (escolha == 'e') return seguirSaida(se, m, 0);
+    if (escolha == 'd') return seguirSaida(se, m, 1);
+    if (escolha >= '1' && escolha <= '9') return seguirSaida(se, m, (uint32_t) (escolha - '1'));
+    if (escolha == 'v') {
+        if (se->profTrilha == 0) return MOV_INVALIDO;
+        se->salaAtual = salaAnterior(se);
+        se->profTrilha--;
+        if (se->trilhaMantida > se->profTrilha) se->trilhaMantida = se->profTrilha;
+        return MOV_OK;
+    }
+    if (escolha == 's') return MOV_SAIR;
+    return MOV_INVALIDO;
+}
+
+void liberarSessao(Sessao *se) {
+    liberarEvidencias(&se->ev);
+    liberarPistas(&se->pistas);
+    memLiberar(se->coletadas);
+    se->coletadas = NULL;
+    se->capColetadas = 0;
+    memLiberar(se->visitadas.itens);
+    memset(&se->visitadas, 0, sizeof se->visitadas);
+    memLiberar(se->trilha);
+    se->trilha = NULL;
+    se->inicioTrilha = se->profTrilha = se->capTrilha = 0;
+    se->trilhaMantida = se->trilhaDescartada = 0;
+}
+
+// =========================
+// DIARIO DE SESSOES (SNAPSHOTS E DELTAS)
+// =========================
+
+
+static size_t tamVarint(uint64_t v) {
+    size_t n = 1;
+    while (v >= 0x80) { v >>= 7; n++; }
+    return n;
+}
+
+static unsigned char* escreverVarint(unsigned char *p, uint64_t v) {
+    while (v >= 0x80) {
+        *p++ = (unsigned char) (v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (unsigned char) v;
+    return p;
+}
+
+// le um varint de [p, fim); retorna o ponteiro seguinte ou NULL se estiver truncado/invalido
+static const unsigned char* lerVarint(const unsigned char *p, const unsigned char *fim, uint64_t *v) {
+    uint64_t r = 0;
+    for (int desl = 0; p < fim && desl < 64; desl += 7) {
+        unsigned char b = *p++;
+        r |= (uint64_t) (b & 0x7f) << desl;
+        if (!(b & 0x80)) { *v = r; return p; }
+    }
+    return NULL;
+}
+
+// impressaoMansao() – resume salas, saidas, associacoes e textos do mapa (os registros guardam ids)
+uint64_t impressaoMansao(const Mansao *m) {
+    uint64_t h = hashTexto(m->salas, (size_t) m->numSalas * sizeof(Sala), DIARIO_SEMENTE ^ m->raiz);
+    h = hashTexto(m->inicioSaidas, ((size_t) m->numSalas + 1) * sizeof(uint32_t), h);
+    h = hashTexto(m->saidas, (size_t) m->numSaidas * sizeof(int32_t), h);
+    h = hashTexto(m->associacoes, (size_t) m->numAssociacoes * sizeof(Associacao), h);
+    uint32_t total = totalInternos(&m->textos);
+    for (uint32_t i = 0; i < total; ++i) {
+        const char *t = textoInterno(&m->textos, i);
+        h = hashTexto(t, strlen(t), h);
+    }
+    return h;
+}
+
+static unsigned char* reservarDiario(DiarioSessoes *d, size_t n) {
+    if (d->usado + n > d->cap) {
+        size_t nova = d->cap ? d->cap : 4096;
+        while (nova < d->usado + n) nova *= 2;
+        unsigned char *b = (unsigned char*) memRealocar(MEM_DIARIO, d->buf, nova);
+        if (b == NULL) { printf("Erro: memoria insuficiente (diario).\n"); exit(1); }
+        d->buf = b;
+        d->cap = nova;
+    }
+    return d->buf + d->usado;
+}
+
+static int compararU32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t*) a, y = *(const uint32_t*) b;
+    return (x > y) - (x < y);
+}
+
+// abre um registro de ate 'max' bytes de conteudo no fim do buffer; devolve onde escrever
+// o conteudo (deixa espaco para o tipo e o tamanho, que so e conhecido no fim)
+static unsigned char* abrirRegistro(DiarioSessoes *d, size_t max) {
+    reservarDiario(d, 1 + 10 + max + 4);
+    return d->buf + d->usado + 11;
+}
+
+// fecha o registro aberto: grava tipo e tamanho, encosta o conteudo neles e acrescenta a checagem
+static void fecharRegistro(DiarioSessoes *d, unsigned char tipo, const unsigned char *fim) {
+    unsigned char *reg = d->buf + d->usado, *conteudo = reg + 11;
+    size_t tam = (size_t) (fim - conteudo);
+    reg[0] = tipo;
+    unsigned char *p = escreverVarint(reg + 1, tam);
+    memmove(p, conteudo, tam);
+    uint32_t chk = (uint32_t) hashTexto(p, tam, DIARIO_SEMENTE ^ tipo);
+    memcpy(p + tam, &chk, 4);
+    d->usado = (size_t) (p + tam + 4 - d->buf);
+    d->pendentes++;
+}
+
+// acrescenta ao buffer um snapshot completo da sessao 'id'
+static void registrarSnapshot(DiarioSessoes *d, uint32_t id, Sessao *se) {
+    uint32_t n = (uint32_t) se->pistas.total;
+    if (n > d->capIds) {
+        uint32_t *v = (uint32_t*) memRealocar(MEM_DIARIO, d->ids, n * sizeof(uint32_t));
+        if (v == NULL) { printf("Erro: memoria insuficiente (diario).\n"); exit(1); }
+        d->ids = v;
+        d->capIds = n;
+    }
+    memcpy(d->ids, se->coletadas, n * sizeof(uint32_t));
+    qsort(d->ids, n, sizeof(uint32_t), compararU32);
+
+    // lista de diferencas em varint ou bitset, o que for menor
+    size_t tamLista = tamVarint(n), tamBits = 0;
+    for (uint32_t i = 0; i < n; ++i) tamLista += tamVarint(d->ids[i] - (i ? d->ids[i-1] : 0));
+    if (n > 0) tamBits = (d->ids[n-1] >> 3) + 1;
+    int bitset = n > 0 && tamBits + tamVarint(tamBits) < tamLista;
+
+    unsigned char *p = abrirRegistro(d, 4 * 5 + (size_t) se->ev.numSuspeitos * 5 + 1 +
+                                        (bitset ? tamBits + 5 : tamLista) + ((size_t) se->profTrilha + 1) * 5);
+    p = escreverVarint(p, id);
+    p = escreverVarint(p, (uint32_t) se->salaAtual);
+    p = escreverVarint(p, se->movimentos);
+    p = escreverVarint(p, se->ev.numSuspeitos);
+    for (uint32_t i = 0; i < se->ev.numSuspeitos; ++i) p = escreverVarint(p, se->ev.pontos[i]);
+    *p++ = (unsigned char) bitset;
+    if (bitset) {
+        p = escreverVarint(p, tamBits);
+        memset(p, 0, tamBits);
+        for (uint32_t i = 0; i < n; ++i) p[d->ids[i] >> 3] |= (unsigned char) (1u << (d->ids[i] & 7));
+        p += tamBits;
+    } else {
+        p = escreverVarint(p, n);
+        for (uint32_t i = 0; i < n; ++i) p = escreverVarint(p, d->ids[i] - (i ? d->ids[i-1] : 0));
+    }
+    p = escreverVarint(p, se->profTrilha);
+    for (uint32_t i = 0; i < se->profTrilha; ++i) p = escreverVarint(p, (uint32_t) salaTrilha(se, i));
+    fecharRegistro(d, 'S', p);
+}
+
+// registrarSessao() – acrescenta ao buffer o que mudou na sessao desde o ultimo registro
+// (snapshot completo se ela e nova ou foi reiniciada, delta caso contrario; nada se nao mudou)
+void registrarSessao(DiarioSessoes *d, uint32_t id, Sessao *se) {
+    uint32_t total = (uint32_t) se->pistas.total;
+    if (se->snapshotPendente) {
+        registrarSnapshot(d, id, se);
+    } else {
+        if (se->movimentos == se->movimentosSalvos && total == se->salvas) return;
+        uint32_t novas = total - se->salvas, empilhadas = se->profTrilha - se->trilhaMantida;
+        unsigned char *p = abrirRegistro(d, 7 * 5 + ((size_t) novas + empilhadas) * 5);
+        p = escreverVarint(p, id);
+        p = escreverVarint(p, (uint32_t) se->salaAtual);
+        p = escreverVarint(p, se->movimentos);
+        p = escreverVarint(p, novas);
+        for (uint32_t i = se->salvas; i < total; ++i) p = escreverVarint(p, se->coletadas[i]);
+        p = escreverVarint(p, se->trilhaDescartada);
+        p = escreverVarint(p, se->trilhaMantida);
+        p = escreverVarint(p, empilhadas);
+        for (uint32_t i = se->trilhaMantida; i < se->profTrilha; ++i) p = escreverVarint(p, (uint32_t) salaTrilha(se, i));
+        fecharRegistro(d, 'D', p);
+    }
+    se->trilhaMantida = se->profTrilha;
+    se->trilhaDescartada = 0;
+    se->salvas = total;
+    se->movimentosSalvos = se->movimentos;
+    se->snapshotPendente = 0;
+}
+
+// escreve tudo (ignorando interrupcoes e escritas parciais); retorna 1 se conseguiu
+static int escreverTudo(int fd, const void *dados, size_t n) {
+    const char *p = (const char*) dados;
+    while (n > 0) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0) return 0;
+        p += w;
+        n -= (size_t) w;
+    }
+    return 1;
+}
+
+// gravarDiario() – grava os registros pendentes com uma unica escrita em modo O_APPEND
+// um registro cortado por uma queda e descartado (e truncado) na proxima abertura
+int gravarDiario(DiarioSessoes *d) {
+    if (d->usado == 0) return 1;
+    int ok = escreverTudo(d->fd, d->buf, d->usado);
+    if (ok && d->sincronizar) ok = fdatasync(d->fd) == 0;
+    d->registros += d->pendentes;
+    d->usado = d->pendentes = 0;
+    return ok;
+}
+
+// aplica um registro validado a sessao; retorna 0 se o conteudo nao faz sentido para o mapa
+static int aplicarRegistro(unsigned char tipo, const unsigned char *p, const unsigned char *fim,
+                           const Mansao *m, const HashTable *ht, Sessao *sessoes, size_t numSessoes) {
+    uint64_t id, sala, movs, n, v;
+    if ((p = lerVarint(p, fim, &id)) == NULL || (p = lerVarint(p, fim, &sala)) == NULL ||
+        (p = lerVarint(p, fim, &movs)) == NULL) return 0;
+    if (sala > INT32_MAX || !salaValida(m, (int32_t) sala)) return 0;
+    if (id >= numSessoes) return 1; // sessao fora do intervalo pedido: ignora
+    Sessao *se = &sessoes[id];
+    uint32_t totalTextos = totalInternos(ht->textos);
+
+    if (tipo == 'S') {
+        reiniciarSessao(se, m);
+        if ((p = lerVarint(p, fim, &n)) == NULL || n != se->ev.numSuspeitos) return 0;
+        for (uint32_t i = 0; i < n; ++i) {
+            if ((p = lerVarint(p, fim, &v)) == NULL) return 0;
+            se->ev.pontos[i] = (uint32_t) v;
+        }
+        if (p >= fim) return 0;
+        int bitset = *p++;
+        // as pistas vem em ordem de id, sem repetir: vao direto para a lista de coleta, e a AVL
+        // e montada de uma vez a partir dela
+        if ((p = lerVarint(p, fim, &n)) == NULL) return 0;
+        if (n > (uint64_t) (fim - p)) return 0; // cada varint ou byte do bitset ocupa um byte
+        uint32_t k = 0;
+        if (bitset) {
+            reservarColetadas(se, n * 8);
+            for (uint64_t b = 0; b < n; ++b)
+                for (unsigned j = 0; j < 8; ++j) {
+                    if (!(p[b] & (1u << j))) continue;
+                    uint64_t pista = b * 8 + j;
+                    if (pista >= totalTextos) return 0;
+                    if (pista != TEXTO_VAZIO) se->coletadas[k++] = (uint32_t) pista;
+                }
+            p += n;
+        } else {
+            reservarColetadas(se, n);
+            uint64_t pista = 0;
+            for (uint64_t i = 0; i < n; ++i) {
+                if ((p = lerVarint(p, fim, &v)) == NULL) return 0;
+                pista += v;
+                if (pista >= totalTextos) return 0;
+                if (pista != TEXTO_VAZIO && (k == 0 || se->coletadas[k - 1] != pista))
+                    se->coletadas[k++] = (uint32_t) pista;
+            }
+        }
+        construirPistas(&se->pistas, se->coletadas, k, 1);
+    } else {
+        if ((p = lerVarint(p, fim, &n)) == NULL) return 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            if ((p = lerVarint(p, fim, &v)) == NULL || v >= totalTextos) return 0;
+            if (inserirPistaId(&se->pistas, (uint32_t) v)) {
+                anotarColeta(se, (uint32_t) v);
+                registrarEvidencia(&se->ev, ht, (uint32_t) v);
+            }
+        }
+        // trilha: esquece o fundo que o anel descartou e fica so com a parte que nao foi desfeita
+        uint64_t descartadas, mantidas;
+        if ((p = lerVarint(p, fim, &descartadas)) == NULL || (p = lerVarint(p, fim, &mantidas)) == NULL)
+            return 0;
+        descartarFundoTrilha(se, descartadas > se->profTrilha ? se->profTrilha : (uint32_t) descartadas);
+        if (mantidas > se->profTrilha) return 0;
+        se->profTrilha = (uint32_t) mantidas;
+    }
+    // salas empilhadas na trilha (todas no snapshot, as novas no delta)
+    if ((p = lerVarint(p, fim, &n)) == NULL || n > TRILHA_MAX) return 0;
+    for (uint64_t i = 0; i < n; ++i) {
+        if ((p = lerVarint(p, fim, &v)) == NULL || v > INT32_MAX || !salaValida(m, (int32_t) v)) return 0;
+        empilharTrilha(se, (int32_t) v);
+    }
+    se->trilhaMantida = se->profTrilha;
+    se->trilhaDescartada = 0;
+    se->salaAtual = (int32_t) sala;
+    se->movimentos = (uint32_t) movs;
+    se->salvas = (uint32_t) se->pistas.total;
+    se->movimentosSalvos = se->movimentos;
+    se->snapshotPendente = 0;
+    return 1;
+}
+
+// abrirDiario() – abre (ou cria) o diario e restaura nele as sessoes ja iniciadas em 'sessoes'
+// o arquivo e lido com uma unica leitura; a parte final invalida (escrita interrompida) e
+// truncada. Em '*restauradas' fica o numero de sessoes que tinham registros. Retorna 0 em erro
+int abrirDiario(DiarioSessoes *d, const char *caminho, const Mansao *m, const HashTable *ht,
+                Sessao *sessoes, size_t numSessoes, size_t *restauradas) {
+    memset(d, 0, sizeof *d);
+    d->fd = -1;
+    d->impressao = impressaoMansao(m);
+    d->numSuspeitos = ht->numSuspeitos;
+    size_t tamCaminho = strlen(caminho) + 1;
+    d->caminho = (char*) memAlocar(MEM_DIARIO, tamCaminho); // sem strdup: a copia entra na contabilidade
+    if (d->caminho == NULL) { printf("Erro: memoria insuficiente (diario).\n"); exit(1); }
+    memcpy(d->caminho, caminho, tamCaminho);
+    *restauradas = 0;
+
+    int fd = open(caminho, O_RDWR | O_CREAT, 0644);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        printf("Erro: nao foi possivel abrir o diario '%s'.\n", caminho);
+        if (fd >= 0) close(fd);
+        return 0;
+    }
+    size_t tam = (size_t) st.st_size, valido = sizeof(CabecalhoDiario);
+    if (tam == 0) {
+        CabecalhoDiario cab = { {0}, DIARIO_VERSAO, d->impressao, d->numSuspeitos, 0 };
+        memcpy(cab.magica, DIARIO_MAGICA, 4);
+        if (!escreverTudo(fd, &cab, sizeof cab)) { close(fd); return 0; }
+    } else {
+        unsigned char *dados = (unsigned char*) memAlocar(MEM_DIARIO, tam);
+        size_t lidos = 0;
+        while (dados != NULL && lidos < tam) {
+            ssize_t r = read(fd, dados + lidos, tam - lidos);
+            if (r <= 0) break;
+            lidos += (size_t) r;
+        }
+        CabecalhoDiario cab;
+        if (dados == NULL || lidos < sizeof cab) {
+            printf("Erro: diario '%s' ilegivel.\n", caminho);
+            memLiberar(dados);
+            close(fd);
+            return 0;
+        }
+        memcpy(&cab, dados, sizeof cab);
+        if (memcmp(cab.magica, DIARIO_MAGICA, 4) != 0 || cab.versao != DIARIO_VERSAO ||
+            cab.impressao != d->impressao || cab.numSuspeitos != d->numSuspeitos) {
+            printf("Erro: o diario '%s' nao pertence a este mapa.\n", caminho);
+            memLiberar(dados);
+            close(fd);
+            return 0;
+        }
+        unsigned char *vistas = (unsigned char*) memZerada(MEM_DIARIO, numSessoes ? numSessoes : 1, 1);
+        const unsigned char *p = dados + valido, *fim = dados + lidos;
+        while (p < fim) {
+            unsigned char tipo = *p;
+            uint64_t t;
+            const unsigned char *c = lerVarint(p + 1, fim, &t);
+            if ((tipo != 'S' && tipo != 'D') || c == NULL || t + 4 > (uint64_t) (fim - c)) break;
+            uint32_t chk;
+            memcpy(&chk, c + t, 4);
+            if (chk != (uint32_t) hashTexto(c, t, DIARIO_SEMENTE ^ tipo)) break;
+            if (!aplicarRegistro(tipo, c, c + t, m, ht, sessoes, numSessoes)) break;
+            uint64_t id = 0;
+            lerVarint(c, c + t, &id);
+            if (id < numSessoes && !vistas[id]) { vistas[id] = 1; (*restauradas)++; }
+            d->registros++;
+            p = c + t + 4;
+            valido = (size_t) (p - dados);
+        }
+        memLiberar(vistas);
+        memLiberar(dados);
+        if (valido < tam && ftruncate(fd, (off_t) valido) != 0) { close(fd); return 0; }
+    }
+    close(fd);
+    d->fd = open(caminho, O_WRONLY | O_APPEND);
+    return d->fd >= 0;
+}
+
+// compactarDiario() – reescreve o diario so com snapshots das sessoes atuais
+// (arquivo temporario + fsync + rename: uma queda deixa o diario antigo ou o novo, nunca metade)
+int compactarDiario(DiarioSessoes *d, Sessao *sessoes, size_t numSessoes) {
+    char tmp[4096];
+    snprintf(tmp, sizeof tmp, "%s.tmp", d->caminho);
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return 0;
+    CabecalhoDiario cab = { {0}, DIARIO_VERSAO, d->impressao, d->numSuspeitos, 0 };
+    memcpy(cab.magica, DIARIO_MAGICA, 4);
+    int ok = escreverTudo(fd, &cab, sizeof cab);
+
+    // o buffer pendente e substituido pelos snapshots
+    d->usado = d->pendentes = 0;
+    for (size_t i = 0; ok && i < numSessoes; ++i) {
+        sessoes[i].snapshotPendente = 1;
+        registrarSessao(d, (uint32_t) i, &sessoes[i]);
+        if (d->usado >= (1u << 20)) { ok = escreverTudo(fd, d->buf, d->usado); d->usado = 0; }
+    }
+    ok = ok && escreverTudo(fd, d->buf, d->usado) && fsync(fd) == 0;
+    if (close(fd) != 0) ok = 0;
+    if (ok && rename(tmp, d->caminho) != 0) ok = 0;
+    if (!ok) {
+        remove(tmp);
+        d->usado = d->pendentes = 0;
+        return 0;
+    }
+    close(d->fd);
+    d->fd = open(d->caminho, O_WRONLY | O_APPEND);
+    d->registros = d->pendentes;
+    d->usado = d->pendentes = 0;
+    return d->fd >= 0;
+}
+
+void fecharDiario(DiarioSessoes *d) {
+    gravarDiario(d);
+    if (d->fd >= 0) close(d->fd);
+    memLiberar(d->buf);
+    memLiberar(d->ids);
+    memLiberar(d->caminho);
+    memset(d, 0, sizeof *d);
+    d->fd = -1;
+}
+
+// =========================
+// CONSULTAS DE CAMINHO E ALCANCE
+// =========================
+
+
+// letra da saida 'k' nos roteiros: 'e'/'d' para as saidas 1 e 2, '3'..'9' para as seguintes
+// ('?' alem da nona, que so pode ser escolhida pelo numero no modo interativo)
+char letraSaida(uint32_t k) {
+    return k == 0 ? 'e' : k == 1 ? 'd' : k < 9 ? (char) ('1' + k) : '?';
+}
+
+void* alocarConsulta(size_t n, size_t tam) {
+    void *p = memZerada(MEM_CONSULTAS, n ? n : 1, tam);
+    if (p == NULL) { printf("Erro: memoria insuficiente (consultas).\n"); exit(1); }
+    return p;
+}
+
+// componentes fortemente conexas (Tarjan iterativo: a pilha de chamadas guarda sala e proxima saida)
+// sao numeradas em ordem topologica reversa: quem e alcancado recebe numero menor
+static void componentesFortes(ConsultasMansao *cq) {
+    const Mansao *m = cq->m;
+    uint32_t n = m->numSalas, ordem = 0;
+    uint32_t *indice = (uint32_t*) alocarConsulta(n, sizeof(uint32_t)); // 0 = nao visitada
+    uint32_t *baixo = (uint32_t*) alocarConsulta(n, sizeof(uint32_t));
+    int32_t *pilha = (int32_t*) alocarConsulta(n, sizeof(int32_t));
+    int32_t *chamadas = (int32_t*) alocarConsulta(n, sizeof(int32_t));
+    uint32_t *proxSaida = (uint32_t*) alocarConsulta(n, sizeof(uint32_t));
+    size_t topo = 0, prof = 0;
+    for (uint32_t i = 0; i < n; ++i) cq->componente[i] = UINT32_MAX;
+    for (uint32_t r = 0; r < n; ++r) {
+        if (indice[r] != 0) continue;
+        chamadas[prof++] = (int32_t) r;
+        indice[r] = baixo[r] = ++ordem;
+        pilha[topo++] = (int32_t) r;
+        while (prof > 0) {
+            int32_t v = chamadas[prof - 1];
+            if (proxSaida[v] < numSaidasSala(m, v)) {
+                int32_t w = saidaSala(m, v, proxSaida[v]++);
+                if (!salaValida(m, w)) continue;
+                if (indice[w] == 0) {
+                    indice[w] = baixo[w] = ++ordem;
+                    pilha[topo++] = w;
+                    chamadas[prof++] = w;
+                } else if (cq->componente[w] == UINT32_MAX && indice[w] < baixo[v]) {
+                    baixo[v] = indice[w]; // w ainda na pilha
+                }
+                continue;
+            }
+            prof--;
+            if (prof > 0) {
+                int32_t u = chamadas[prof - 1];
+                if (baixo[v] < baixo[u]) baixo[u] = baixo[v];
+            }
+            if (baixo[v] == indice[v]) {
+                int32_t w;
+                do {
+                    w = pilha[--topo];
+                    cq->componente[w] = cq->numComponentes;
+                } while (w != v);
+                cq->numComponentes++;
+            }
+        }
+    }
+    memLiberar(indice);
+    memLiberar(baixo);
+    memLiberar(pilha);
+    memLiberar(chamadas);
+    memLiberar(proxSaida);
+}
+
+// se cada componente tem no maximo uma componente de onde se chega a ela, o grafo condensado e uma
+// floresta: numera as componentes em pre-ordem (Euler) e guarda o fim do intervalo de cada uma
+static void intervalosEuler(ConsultasMansao *cq) {
+    const Mansao *m = cq->m;
+    uint32_t nc = cq->numComponentes;
+    uint32_t *paiComp = (uint32_t*) alocarConsulta(nc, sizeof(uint32_t));
+    for (uint32_t c = 0; c < nc; ++c) paiComp[c] = UINT32_MAX;
+    cq->floresta = 1;
+    for (uint32_t v = 0; v < m->numSalas && cq->floresta; ++v)
+        for (uint32_t k = 0; k < numSaidasSala(m, (int32_t) v); ++k) {
+            int32_t w = saidaSala(m, (int32_t) v, k);
+            if (!salaValida(m, w)) continue;
+            uint32_t cv = cq->componente[v], cw = cq->componente[w];
+            if (cv == cw) continue;
+            if (paiComp[cw] != UINT32_MAX && paiComp[cw] != cv) { cq->floresta = 0; break; }
+            paiComp[cw] = cv;
+        }
+    if (cq->floresta) {
+        // filhas de cada componente em CSR e pre-ordem iterativa a partir das raizes
+        uint32_t *inicio = (uint32_t*) alocarConsulta((size_t) nc + 1, sizeof(uint32_t));
+        uint32_t *filhas = (uint32_t*) alocarConsulta(nc, sizeof(uint32_t));
+        uint32_t *pilha = (uint32_t*) alocarConsulta(nc, sizeof(uint32_t));
+        for (uint32_t c = 0; c < nc; ++c) if (paiComp[c] != UINT32_MAX) inicio[paiComp[c] + 1]++;
+        for (uint32_t c = 0; c < nc; ++c) inicio[c + 1] += inicio[c];
+        uint32_t *pos = (uint32_t*) alocarConsulta(nc, sizeof(uint32_t));
+        memcpy(pos, inicio, nc * sizeof(uint32_t));
+        for (uint32_t c = 0; c < nc; ++c) if (paiComp[c] != UINT32_MAX) filhas[pos[paiComp[c]]++] = c;
+        uint32_t ordem = 0;
+        for (uint32_t r = 0; r < nc; ++r) {
+            if (paiComp[r] != UINT32_MAX) continue;
+            size_t topo = 0;
+            pilha[topo++] = r;
+            while (topo > 0) {
+                uint32_t c = pilha[--topo];
+                cq->entradaComp[c] = ordem++;
+                for (uint32_t k = inicio[c]; k < inicio[c + 1]; ++k) pilha[topo++] = filhas[k];
+            }
+        }
+        // fim do intervalo: maior entrada da subarvore (filhas terminam antes das maes na ordem reversa)
+        for (uint32_t c = 0; c < nc; ++c) cq->saidaComp[c] = cq->entradaComp[c];
+        uint32_t *porEntrada = pos; // reaproveita: componente de cada posicao da pre-ordem
+        for (uint32_t c = 0; c < nc; ++c) porEntrada[cq->entradaComp[c]] = c;
+        for (uint32_t e = nc; e-- > 0; ) {
+            uint32_t c = porEntrada[e];
+            if (paiComp[c] != UINT32_MAX && cq->saidaComp[c] > cq->saidaComp[paiComp[c]])
+                cq->saidaComp[paiComp[c]] = cq->saidaComp[c];
+        }
+        memLiberar(inicio);
+        memLiberar(filhas);
+        memLiberar(pilha);
+        memLiberar(pos);
+    }
+    memLiberar(paiComp);
+}
+
+// resumirPistasGrafo() – fora da floresta, o bitset de cada componente recebe as salas com pista
+// dela e as das componentes a que ela leva. A numeracao de Tarjan e topologica reversa, entao as
+// sucessoras de 'c' ja estao completas quando 'c' e processada: O((componentes + ligacoes) *
+// pistas / 64). Nao monta nada se a memoria passar de ALCANCE_PALAVRAS ou o trabalho de 8 vezes isso
+static void resumirPistasGrafo(ConsultasMansao *cq) {
+    const Mansao *m = cq->m;
+    uint32_t n = m->numSalas, nc = cq->numComponentes, palavras = (cq->numPistas + 63) / 64;
+    if (cq->floresta || cq->numPistas == 0 || (uint64_t) nc * palavras > ALCANCE_PALAVRAS) return;
+
+    // salas agrupadas por componente e ligacoes distintas entre componentes
+    uint32_t *inicio = (uint32_t*) alocarConsulta((size_t) nc + 1, sizeof(uint32_t));
+    int32_t *salas = (int32_t*) alocarConsulta(n, sizeof(int32_t));
+    uint32_t *vista = (uint32_t*) alocarConsulta(nc, sizeof(uint32_t)); // c + 1 = ja ligada a 'c'
+    for (uint32_t v = 0; v < n; ++v) inicio[cq->componente[v] + 1]++;
+    for (uint32_t c = 0; c < nc; ++c) inicio[c + 1] += inicio[c];
+    uint32_t *pos = (uint32_t*) alocarConsulta(nc, sizeof(uint32_t));
+    memcpy(pos, inicio, nc * sizeof(uint32_t));
+    for (uint32_t v = 0; v < n; ++v) salas[pos[cq->componente[v]]++] = (int32_t) v;
+    memLiberar(pos);
+    uint64_t ligacoes = 0;
+    for (uint32_t c = 0; c < nc; ++c)
+        for (uint32_t i = inicio[c]; i < inicio[c + 1]; ++i)
+            for (uint32_t k = 0; k < numSaidasSala(m, salas[i]); ++k) {
+                int32_t w = saidaSala(m, salas[i], k);
+                if (!salaValida(m, w) || cq->componente[w] == c || vista[cq->componente[w]] == c + 1) continue;
+                vista[cq->componente[w]] = c + 1;
+                ligacoes++;
+            }
+
+    if ((ligacoes + nc) * palavras <= 8ull * ALCANCE_PALAVRAS) {
+        uint64_t *bits = (uint64_t*) alocarConsulta((size_t) nc * palavras, sizeof(uint64_t));
+        for (uint32_t i = 0; i < cq->numPistas; ++i)
+            bits[(size_t) cq->componente[cq->pistasPorEntrada[i].sala] * palavras + i / 64] |= 1ull << (i % 64);
+        memset(vista, 0, nc * sizeof(uint32_t));
+        for (uint32_t c = 0; c < nc; ++c) {
+            uint64_t *dst = bits + (size_t) c * palavras;
+            for (uint32_t i = inicio[c]; i < inicio[c + 1]; ++i)
+                for (uint32_t k = 0; k < numSaidasSala(m, salas[i]); ++k) {
+                    int32_t w = saidaSala(m, salas[i], k);
+                    if (!salaValida(m, w)) continue;
+                    uint32_t cw = cq->componente[w];
+                    if (cw == c || vista[cw] == c + 1) continue;
+                    vista[cw] = c + 1;
+                    const uint64_t *src = bits + (size_t) cw * palavras;
+                    for (uint32_t j = 0; j < palavras; ++j) dst[j] |= src[j];
+                }
+        }
+        cq->pistasComp = bits;
+        cq->palavrasPistas = palavras;
+    }
+    memLiberar(inicio);
+    memLiberar(salas);
+    memLiberar(vista);
+}
+
+static int compararAlcance(const void *a, const void *b) {
+    const ItemAlcance *x = (const ItemAlcance*) a, *y = (const ItemAlcance*) b;
+    if (x->entrada != y->entrada) return x->entrada < y->entrada ? -1 : 1;
+    return (x->sala > y->sala) - (x->sala < y->sala);
+}
+
+// prepararConsultas() – monta o CSR transposto, as componentes e os resumos de alcance
+// custo O(salas + saidas + pistas log pistas), mais o resumo por componente fora da floresta;
+// feito uma vez por mapa
+void prepararConsultas(ConsultasMansao *cq, const Mansao *m, const HashTable *ht) {
+    memset(cq, 0, sizeof *cq);
+    cq->m = m;
+    cq->ht = ht;
+    uint32_t n = m->numSalas;
+
+    cq->inicioEntradas = (uint32_t*) alocarConsulta((size_t) n + 1, sizeof(uint32_t));
+    cq->entradas = (int32_t*) alocarConsulta(m->numSaidas, sizeof(int32_t));
+    for (uint32_t v = 0; v < n; ++v)
+        for (uint32_t k = 0; k < numSaidasSala(m, (int32_t) v); ++k) {
+            int32_t w = saidaSala(m, (int32_t) v, k);
+            if (salaValida(m, w)) cq->inicioEntradas[w + 1]++;
+        }
+    for (uint32_t v = 0; v < n; ++v) cq->inicioEntradas[v + 1] += cq->inicioEntradas[v];
+    uint32_t *pos = (uint32_t*) alocarConsulta(n, sizeof(uint32_t));
+    memcpy(pos, cq->inicioEntradas, n * sizeof(uint32_t));
+    for (uint32_t v = 0; v < n; ++v)
+        for (uint32_t k = 0; k < numSaidasSala(m, (int32_t) v); ++k) {
+            int32_t w = saidaSala(m, (int32_t) v, k);
+            if (salaValida(m, w)) cq->entradas[pos[w]++] = (int32_t) v;
+        }
+    memLiberar(pos);
+
+    cq->componente = (uint32_t*) alocarConsulta(n, sizeof(uint32_t));
+    componentesFortes(cq);
+    cq->entradaComp = (uint32_t*) alocarConsulta(cq->numComponentes, sizeof(uint32_t));
+    cq->saidaComp = (uint32_t*) alocarConsulta(cq->numComponentes, sizeof(uint32_t));
+    intervalosEuler(cq);
+
+    // salas com pista ligada a um suspeito, por entrada e por (suspeito, entrada);
+    // uma pista que implica varios suspeitos entra na lista de cada um
+    uint32_t numSus = ht->numSuspeitos;
+    cq->inicioSuspeito = (uint32_t*) alocarConsulta((size_t) numSus + 1, sizeof(uint32_t));
+    for (uint32_t v = 0; v < n; ++v) {
+        const HashEntrada *e = encontrarEntrada(ht, m->salas[v].pista);
+        if (e == NULL) continue;
+        cq->numPistas++;
+        for (uint32_t j = 0; j < e->suspeitos.quantidade; ++j) cq->inicioSuspeito[suspeitosDaPista(ht, e)[j].id + 1]++;
+    }
+    for (uint32_t s = 0; s < numSus; ++s) cq->inicioSuspeito[s + 1] += cq->inicioSuspeito[s];
+    cq->pistasPorEntrada = (ItemAlcance*) alocarConsulta(cq->numPistas, sizeof(ItemAlcance));
+    cq->pistasPorSuspeito = (ItemAlcance*) alocarConsulta(cq->inicioSuspeito[numSus], sizeof(ItemAlcance));
+    uint32_t *posSus = (uint32_t*) alocarConsulta(numSus, sizeof(uint32_t));
+    memcpy(posSus, cq->inicioSuspeito, numSus * sizeof(uint32_t));
+    uint32_t k = 0;
+    for (uint32_t v = 0; v < n; ++v) {
+        const HashEntrada *e = encontrarEntrada(ht, m->salas[v].pista);
+        if (e == NULL) continue;
+        ItemAlcance it = { cq->floresta ? cq->entradaComp[cq->componente[v]] : k, (int32_t) v };
+        cq->pistasPorEntrada[k++] = it;
+        for (uint32_t j = 0; j < e->suspeitos.quantidade; ++j)
+            cq->pistasPorSuspeito[posSus[suspeitosDaPista(ht, e)[j].id]++] = it;
+    }
+    memLiberar(posSus);
+    qsort(cq->pistasPorEntrada, cq->numPistas, sizeof(ItemAlcance), compararAlcance);
+    for (uint32_t s = 0; s < numSus; ++s)
+        qsort(cq->pistasPorSuspeito + cq->inicioSuspeito[s], cq->inicioSuspeito[s + 1] - cq->inicioSuspeito[s],
+              sizeof(ItemAlcance), compararAlcance);
+    resumirPistasGrafo(cq);
+
+    cq->marca = (uint32_t*) alocarConsulta(n, sizeof(uint32_t));
+    cq->marcaVolta = (uint32_t*) alocarConsulta(n, sizeof(uint32_t));
+    cq->pai = (int32_t*) alocarConsulta(n, sizeof(int32_t));
+    cq->paiVolta = (int32_t*) alocarConsulta(n, sizeof(int32_t));
+    cq->fila = (int32_t*) alocarConsulta(n, sizeof(int32_t));
+    cq->filaVolta = (int32_t*) alocarConsulta(n, sizeof(int32_t));
+    cq->marcaPista = (uint32_t*) alocarConsulta(totalInternos(ht->textos), sizeof(uint32_t));
+}
+
+// nova epoca para os vetores de marca (zera de fato so quando o contador da a volta)
+static uint32_t novaEpoca(ConsultasMansao *cq) {
+    if (++cq->epoca == 0) {
+        memset(cq->marca, 0, cq->m->numSalas * sizeof(uint32_t));
+        memset(cq->marcaVolta, 0, cq->m->numSalas * sizeof(uint32_t));
+        cq->epoca = 1;
+    }
+    return cq->epoca;
+}
+
+// busca em largura a partir de 'de' que para ao chegar em 'para' (-1 = percorre tudo);
+// as salas visitadas ficam marcadas com a epoca atual
+static int buscarAlcance(ConsultasMansao *cq, int32_t de, int32_t para) {
+    const Mansao *m = cq->m;
+    uint32_t ep = novaEpoca(cq);
+    size_t ini = 0, fim = 0;
+    cq->marca[de] = ep;
+    cq->fila[fim++] = de;
+    while (ini < fim) {
+        int32_t v = cq->fila[ini++];
+        if (v == para) return 1;
+        for (uint32_t k = 0; k < numSaidasSala(m, v); ++k) {
+            int32_t w = saidaSala(m, v, k);
+            if (salaValida(m, w) && cq->marca[w] != ep) { cq->marca[w] = ep; cq->fila[fim++] = w; }
+        }
+    }
+    return 0;
+}
+
+// alcanca() – 1 se da sala 'de' e possivel chegar a sala 'para'
+// O(1) com floresta de componentes; busca em largura caso contrario
+int alcanca(ConsultasMansao *cq, int32_t de, int32_t para) {
+    const Mansao *m = cq->m;
+    if (!salaValida(m, de) || !salaValida(m, para)) return 0;
+    if (cq->floresta) {
+        uint32_t a = cq->componente[de], b = cq->componente[para];
+        return cq->entradaComp[b] >= cq->entradaComp[a] && cq->entradaComp[b] <= cq->saidaComp[a];
+    }
+    return buscarAlcance(cq, de, para);
+}
+
+// primeira posicao de [ini, fim) com entrada >= 'chave'
+static uint32_t limiteInferior(const ItemAlcance *v, uint32_t ini, uint32_t fim, uint32_t chave) {
+    while (ini < fim) {
+        uint32_t meio = ini + (fim - ini) / 2;
+        if (v[meio].entrada < chave) ini = meio + 1;
+        else fim = meio;
+    }
+    return ini;
+}
+
+// resumoAlcance() – 1 se contarPistasAlcancaveis responde sem busca em largura
+int resumoAlcance(const ConsultasMansao *cq) {
+    return cq->floresta || cq->pistasComp != NULL || cq->numPistas == 0;
+}
+
+// contarPistasAlcancaveis() – salas com pista (do suspeito 'idxSuspeito'; UINT32_MAX = qualquer um)
+// alcancaveis a partir de 'de', incluindo a propria. O(log n) com floresta de componentes;
+// com o resumo por componente, O(pistas / 64) (ou O(pistas do suspeito)); sem resumo
+// (ver resumoAlcance), uma busca em largura mais uma passada pelas pistas
+uint32_t contarPistasAlcancaveis(ConsultasMansao *cq, int32_t de, uint32_t idxSuspeito) {
+    if (!salaValida(cq->m, de)) return 0;
+    const ItemAlcance *v = cq->pistasPorEntrada;
+    uint32_t ini = 0, fim = cq->numPistas;
+    if (idxSuspeito != UINT32_MAX) {
+        if (idxSuspeito >= cq->ht->numSuspeitos) return 0;
+        v = cq->pistasPorSuspeito;
+        ini = cq->inicioSuspeito[idxSuspeito];
+        fim = cq->inicioSuspeito[idxSuspeito + 1];
+    }
+    if (cq->floresta) {
+        uint32_t c = cq->componente[de];
+        return limiteInferior(v, ini, fim, cq->saidaComp[c] + 1) - limiteInferior(v, ini, fim, cq->entradaComp[c]);
+    }
+    if (cq->pistasComp != NULL) {
+        const uint64_t *bits = cq->pistasComp + (size_t) cq->componente[de] * cq->palavrasPistas;
+        uint32_t total = 0;
+        if (idxSuspeito == UINT32_MAX) {
+            for (uint32_t j = 0; j < cq->palavrasPistas; ++j) total += (uint32_t) __builtin_popcountll(bits[j]);
+        } else {
+            for (uint32_t i = ini; i < fim; ++i) total += (uint32_t) (bits[v[i].entrada / 64] >> (v[i].entrada % 64)) & 1;
+        }
+        return total;
+    }
+    // uma busca em largura marca tudo o que 'de' alcanca; depois basta contar as marcadas
+    buscarAlcance(cq, de, -1);
+    uint32_t ep = cq->epoca, total = 0;
+    for (uint32_t i = ini; i < fim; ++i) total += cq->marca[v[i].sala] == ep;
+    return total;
+}
+
+// marca as pistas ja coletadas pela sessao (para as buscas ignorarem essas salas)
+static uint32_t marcarColetadas(ConsultasMansao *cq, const Sessao *se) {
+    if (++cq->epocaPista == 0) {
+        memset(cq->marcaPista, 0, totalInternos(cq->ht->textos) * sizeof(uint32_t));
+        cq->epocaPista = 1;
+    }
+    for (size_t i = 0; i < se->pistas.total; ++i) cq->marcaPista[se->coletadas[i]] = cq->epocaPista;
+    return cq->epocaPista;
+}
+
+// escreve em 'rota' 'voltas' letras 'v' e depois as das saidas de 'de' ate 'para' seguindo cq->pai;
+// retorna o total de movimentos
+static int32_t montarRota(ConsultasMansao *cq, uint32_t voltas, int32_t de, int32_t para, char *rota, size_t cap) {
+    const Mansao *m = cq->m;
+    uint32_t n = voltas;
+    for (int32_t v = para; v != de; v = cq->pai[v]) n++;
+    if (rota != NULL && cap > 0) {
+        size_t pos = n < cap ? n : cap - 1;
+        rota[pos] = '\0';
+        for (uint32_t i = 0; i < voltas && i < pos; ++i) rota[i] = 'v';
+        uint32_t i = n;
+        for (int32_t v = para; v != de; v = cq->pai[v]) {
+            int32_t p = cq->pai[v];
+            uint32_t k = 0;
+            while (saidaSala(m, p, k) != v) k++;
+            if (--i < pos) rota[i] = letraSaida(k);
+        }
+    }
+    return (int32_t) n;
+}
+
+// rotaPistaMaisProxima() – menor numero de movimentos da sala atual da sessao ate uma sala com pista
+// ainda nao coletada do suspeito 'idxSuspeito' (UINT32_MAX = qualquer suspeito). Em 'rota' ficam as
+// letras dos movimentos e em '*destino' a sala encontrada. Retorna -1 se nao houver nenhuma alcancavel
+// a rota pode comecar voltando pela trilha: a melhor e sempre 'k' vezes 'v' e depois so saidas (voltar
+// depois de avancar so desfaz o avanco), entao a sala 'k' posicoes abaixo do topo da trilha entra
+// na busca em largura no nivel 'k', com pai -1 - k (a sala atual, origem sem voltas, tem pai -1)
+int32_t rotaPistaMaisProxima(ConsultasMansao *cq, const Sessao *se, uint32_t idxSuspeito,
+                             char *rota, size_t cap, int32_t *destino) {
+    const Mansao *m = cq->m;
+    int32_t de = se->salaAtual;
+    if (resumoAlcance(cq) && contarPistasAlcancaveis(cq, salaMaisAntiga(se), idxSuspeito) == 0)
+        return -1; // poda barata
+    uint32_t epPista = marcarColetadas(cq, se), ep = novaEpoca(cq);
+    size_t ini = 0, fim = 0;
+    cq->marca[de] = ep;
+    cq->pai[de] = -1;
+    cq->fila[fim++] = de;
+    for (uint32_t nivel = 0; ini < fim || nivel <= se->profTrilha; ++nivel) {
+        if (nivel > 0 && nivel <= se->profTrilha) {
+            int32_t t = salaTrilha(se, se->profTrilha - nivel);
+            if (cq->marca[t] != ep) {
+                cq->marca[t] = ep;
+                cq->pai[t] = -1 - (int32_t) nivel;
+                cq->fila[fim++] = t;
+            }
+        }
+        for (size_t fimNivel = fim; ini < fimNivel; ) {
+            int32_t v = cq->fila[ini++];
+            uint32_t pista = m->salas[v].pista;
+            if (pista != TEXTO_VAZIO && cq->marcaPista[pista] != epPista) {
+                const HashEntrada *e = encontrarEntrada(cq->ht, pista);
+                if (e != NULL && (idxSuspeito == UINT32_MAX || implicaSuspeito(cq->ht, e, idxSuspeito))) {
+                    int32_t origem = v;
+                    while (cq->pai[origem] >= 0) origem = cq->pai[origem];
+                    if (destino != NULL) *destino = v;
+                    return montarRota(cq, (uint32_t) (-1 - cq->pai[origem]), origem, v, rota, cap);
+                }
+            }
+            for (uint32_t k = 0; k < numSaidasSala(m, v); ++k) {
+                int32_t w = saidaSala(m, v, k);
+                if (salaValida(m, w) && cq->marca[w] != ep) {
+                    cq->marca[w] = ep;
+                    cq->pai[w] = v;
+                    cq->fila[fim++] = w;
+                }
+            }
+        }
+    }
+    return -1;
+}
+
+// caminhoMaisCurto() – busca bidirecional de 'de' ate 'para' (para frente pelas saidas, para tras
+// pelo CSR transposto), expandindo sempre a fronteira menor. Retorna o numero de movimentos e
+// escreve as letras em 'rota', ou -1 se 'para' nao for alcancavel
+int32_t caminhoMaisCurto(ConsultasMansao *cq, int32_t de, int32_t para, char *rota, size_t cap) {
+    const Mansao *m = cq->m;
+    if (!salaValida(m, de) || !salaValida(m, para)) return -1;
+    if (cq->floresta && !alcanca(cq, de, para)) return -1; // resposta O(1) antes de buscar
+    if (de == para) { if (rota != NULL && cap > 0) rota[0] = '\0'; return 0; }
+    uint32_t ep = novaEpoca(cq);
+    size_t iniF = 0, fimF = 0, iniV = 0, fimV = 0;
+    cq->marca[de] = ep;
+    cq->fila[fimF++] = de;
+    cq->marcaVolta[para] = ep;
+    cq->paiVolta[para] = -1;
+    cq->filaVolta[fimV++] = para;
+    int32_t encontro = -1;
+    while (encontro < 0 && iniF < fimF && iniV < fimV) {
+        // expande um nivel inteiro do lado com menos salas na fronteira
+        if (fimF - iniF <= fimV - iniV) {
+            size_t nivel = fimF;
+            while (iniF < nivel && encontro < 0) {
+                int32_t v = cq->fila[iniF++];
+                for (uint32_t k = 0; k < numSaidasSala(m, v) && encontro < 0; ++k) {
+                    int32_t w = saidaSala(m, v, k);
+                    if (!salaValida(m, w) || cq->marca[w] == ep) continue;
+                    cq->marca[w] = ep;
+                    cq->pai[w] = v;
+                    cq->fila[fimF++] = w;
+                    if (cq->marcaVolta[w] == ep) encontro = w;
+                }
+            }
+        } else {
+            size_t nivel = fimV;
+            while (iniV < nivel && encontro < 0) {
+                int32_t v = cq->filaVolta[iniV++];
+                for (uint32_t k = cq->inicioEntradas[v]; k < cq->inicioEntradas[v + 1] && encontro < 0; ++k) {
+                    int32_t w = cq->entradas[k];
+                    if (cq->marcaVolta[w] == ep) continue;
+                    cq->marcaVolta[w] = ep;
+                    cq->paiVolta[w] = v;
+                    cq->filaVolta[fimV++] = w;
+                    if (cq->marca[w] == ep) encontro = w;
+                }
+            }
+        }
+    }
+    if (encontro < 0) return -1;
+    // completa o lado de ida com o lado de volta (paiVolta aponta para 'para')
+    for (int32_t v = encontro; v != para; v = cq->paiVolta[v]) cq->pai[cq->paiVolta[v]] = v;
+    return montarRota(cq, 0, de, para, rota, cap);
+}
+
+void liberarConsultas(ConsultasMansao *cq) {
+    memLiberar(cq->inicioEntradas);
+    memLiberar(cq->entradas);
+    memLiberar(cq->componente);
+    memLiberar(cq->entradaComp);
+    memLiberar(cq->saidaComp);
+    memLiberar(cq->pistasPorEntrada);
+    memLiberar(cq->pistasPorSuspeito);
+    memLiberar(cq->inicioSuspeito);
+    memLiberar(cq->pistasComp);
+    memLiberar(cq->marca);
+    memLiberar(cq->marcaVolta);
+    memLiberar(cq->pai);
+    memLiberar(cq->paiVolta);
+    memLiberar(cq->fila);
+    memLiberar(cq->filaVolta);
+    memLiberar(cq->marcaPista);
+    memset(cq, 0, sizeof *cq);
+}
+
+// =========================
+// MANSAO PADRAO
+// =========================
+
+
+// mansao compilada por --gerar-c que substitui a padrao (sem montagem em tempo de execucao)
+#ifdef MANSAO_FIXA
+#include MANSAO_FIXA
+#endif
+
+// mansaoFixaCompilada() – a mansao de -DMANSAO_FIXA, ou NULL se o binario nao tiver uma
+const MansaoFixa* mansaoFixaCompilada(void) {
+#ifdef MANSAO_FIXA
+    return &mansaoFixa;
+#else
+    return NULL;
+#endif
+}
+
+// montarMansaoPadrao() – mapa embutido usado quando nenhum arquivo e informado
+void montarMansaoPadrao(Mansao *m) {
+    ConstrutorMansao c;
+    inicializarConstrutor(&c, 0);
+
+    // Montagem manual do mapa da mansao (arvore binaria de Salas)
+    int32_t hall = criarSala(&c, "Hall de Entrada", "pegadas_no_chao");
+    int32_t salaEstar = criarSala(&c, "Sala de Estar", "livro_aberto_sobre_enigmas");
+    int32_t cozinha = criarSala(&c, "Cozinha", "faca_limpa_na_mesa");
+    int32_t biblioteca = criarSala(&c, "Biblioteca", "mapa_rasgado_com_x");
+    int32_t jardim = criarSala(&c, "Jardim", "vaso_quebrado");
+    int32_t porao = criarSala(&c, "Porao", "cofre_trancado_com_simbolos");
+    int32_t quarto = criarSala(&c, "Quarto Principal", "retrato_antigo_quebrado");
+
+    // ligar as salas
+    ligarSalas(&c, hall, salaEstar, cozinha);
+    ligarSalas(&c, salaEstar, biblioteca, jardim);
+    ligarSalas(&c, cozinha, porao, quarto);
+
+    // A associacao e definida aqui (simplificacao: pistas estaticas associadas a suspeitos)
+    associarPista(&c, "pegadas_no_chao", "Sr. Silva");
+    associarPista(&c, "livro_aberto_sobre_enigmas", "Sra. Almeida");
+    associarPista(&c, "faca_limpa_na_mesa", "Sr. Silva");
+    associarPista(&c, "mapa_rasgado_com_x", "Dr. Costa");
+    associarPista(&c, "vaso_quebrado", "Sra. Almeida");
+    associarPista(&c, "cofre_trancado_com_simbolos", "Dr. Costa");
+    associarPista(&c, "retrato_antigo_quebrado", "Sr. Oliveira");
+
+    finalizarMansao(&c, hall, m);
+}
@@ -0,0 +1,428 @@
+// Versoes do caso publicadas por epocas, servidor de sessoes (--servir) e recarga do caso
+
+#include "NivelMestre4.h"
+
+// =========================
+// VERSOES DO CASO (PUBLICACAO POR EPOCAS)
+// =========================
+
+
+// impressao do que uma sessao guarda por id: salas, saidas e os textos de nome e pista de cada
+// sala. Duas versoes com a mesma impressao so diferem nas associacoes (e no limiar)
+static uint64_t impressaoSalas(const Mansao *m) {
+    uint64_t h = hashTexto(m->salas, (size_t) m->numSalas * sizeof(Sala), DIARIO_SEMENTE ^ m->raiz);
+    h = hashTexto(m->inicioSaidas, ((size_t) m->numSalas + 1) * sizeof(uint32_t), h);
+    h = hashTexto(m->saidas, (size_t) m->numSaidas * sizeof(int32_t), h);
+    for (uint32_t i = 0; i < m->numSalas; ++i) {
+        const char *nome = nomeSala(m, (int32_t) i), *pista = pistaSala(m, (int32_t) i);
+        h = hashTexto(nome, strlen(nome) + 1, h);
+        h = hashTexto(pista, strlen(pista) + 1, h);
+    }
+    return h;
+}
+
+// montarVersaoCaso() – toma posse de uma mansao e da hash ja carregadas (que nao devem mais ser
+// usadas nem liberadas por quem chamou) e monta a versao com os indices derivados. Tudo que uma
+// leitura pode construir sob demanda e construido aqui, antes de publicar
+VersaoCaso* montarVersaoCaso(Mansao *m, HashTable *ht, uint32_t limiar) {
+    VersaoCaso *v = (VersaoCaso*) memZerada(MEM_SERVIDOR, 1, sizeof(VersaoCaso));
+    if (v == NULL) { printf("Erro: memoria insuficiente (versao do caso).\n"); exit(1); }
+    v->mansao = *m;
+    v->ht = *ht;
+    v->ht.textos = &v->mansao.textos; // a hash apontava para a mansao de quem chamou
+    memset(m, 0, sizeof *m);
+    memset(ht, 0, sizeof *ht);
+    prepararInternos(&v->mansao.textos);
+    prepararConsultas(&v->consultas, &v->mansao, &v->ht);
+    construirIndiceNomes(&v->nomes, &v->ht);
+    v->limiar = limiarDoCaso(&v->mansao, limiar);
+    v->impressaoSalas = impressaoSalas(&v->mansao);
+    atomic_init(&v->sessoes, 0);
+    return v;
+}
+
+void liberarVersaoCaso(VersaoCaso *v) {
+    liberarIndiceNomes(&v->nomes);
+    liberarConsultas(&v->consultas);
+    liberarHash(&v->ht);
+    liberarMansao(&v->mansao);
+    memLiberar(v);
+}
+
+// iniciarPublicador() – publica 'inicial' como versao 1, ainda sem leitores
+void iniciarPublicador(PublicadorCasos *pub, VersaoCaso *inicial) {
+    memset(pub, 0, sizeof *pub);
+    inicial->numero = pub->publicadas = 1;
+    atomic_init(&pub->atual, inicial);
+    atomic_init(&pub->epoca, 1);
+    for (int i = 0; i < EPOCA_LEITORES; ++i) atomic_init(&pub->leitores[i].epoca, EPOCA_OCIOSO);
+    atomic_init(&pub->numLeitores, 0);
+    atomic_init(&pub->numRetiradas, 0);
+    pthread_mutex_init(&pub->trava, NULL);
+}
+
+// registrarLeitor() – reserva a vaga de uma thread leitora; -1 se todas estiverem ocupadas
+int registrarLeitor(PublicadorCasos *pub) {
+    int i = atomic_fetch_add(&pub->numLeitores, 1);
+    return i < EPOCA_LEITORES ? i : -1;
+}
+
+// recolherVersoes() – libera as versoes retiradas que nenhum leitor e nenhuma sessao usam mais;
+// retorna quantas ainda esperam
+size_t recolherVersoes(PublicadorCasos *pub) {
+    pthread_mutex_lock(&pub->trava);
+    uint64_t menor = EPOCA_OCIOSO;
+    int n = atomic_load(&pub->numLeitores);
+    for (int i = 0; i < n && i < EPOCA_LEITORES; ++i) {
+        uint64_t e = atomic_load(&pub->leitores[i].epoca);
+        if (e < menor) menor = e;
+    }
+    VersaoCaso **p = &pub->retiradas;
+    while (*p != NULL) {
+        VersaoCaso *v = *p;
+        // as epocas sao conferidas antes das sessoes: quem prendeu a versao ja saiu da leitura
+        if (v->epocaRetirada <= menor && atomic_load_explicit(&v->sessoes, memory_order_acquire) == 0) {
+            *p = v->proximaRetirada;
+            liberarVersaoCaso(v);
+            atomic_fetch_sub(&pub->numRetiradas, 1);
+        } else {
+            p = &v->proximaRetirada;
+        }
+    }
+    size_t restantes = atomic_load(&pub->numRetiradas);
+    pthread_mutex_unlock(&pub->trava);
+    return restantes;
+}
+
+// publicarVersao() – troca a versao atual por 'nova' de uma vez: leituras ja iniciadas terminam
+// com a antiga, as seguintes pegam a nova. A antiga vai para a lista de retiradas
+void publicarVersao(PublicadorCasos *pub, VersaoCaso *nova) {
+    pthread_mutex_lock(&pub->trava);
+    nova->numero = ++pub->publicadas;
+    VersaoCaso *antiga = atomic_exchange(&pub->atual, nova);
+    antiga->epocaRetirada = atomic_fetch_add(&pub->epoca, 1) + 1;
+    antiga->proximaRetirada = pub->retiradas;
+    pub->retiradas = antiga;
+    atomic_fetch_add(&pub->numRetiradas, 1);
+    pthread_mutex_unlock(&pub->trava);
+    recolherVersoes(pub);
+}
+
+// encerrarPublicador() – libera a versao atual e as retiradas; nao pode haver leitores nem sessoes
+void encerrarPublicador(PublicadorCasos *pub) {
+    liberarVersaoCaso(atomic_load(&pub->atual));
+    for (VersaoCaso *v = pub->retiradas, *prox; v != NULL; v = prox) {
+        prox = v->proximaRetirada;
+        liberarVersaoCaso(v);
+    }
+    pthread_mutex_destroy(&pub->trava);
+    memset(pub, 0, sizeof *pub);
+}
+
+// =========================
+// SERVIDOR DE SESSOES
+// =========================
+
+
+static volatile sig_atomic_t servidorParar;
+
+static void pedirParadaServidor(int sinal) {
+    (void) sinal;
+    servidorParar = 1;
+}
+
+// registra no epoll os eventos que a conexao precisa agora: leitura enquanto a saida pendente
+// for pequena (o jogador que nao le para de ser atendido) e escrita enquanto houver pendencia
+static int atualizarEventos(ServidorSessoes *sv, Conexao *c) {
+    size_t pendente = c->saida.usado - c->enviado;
+    uint32_t eventos = (c->fase != FASE_ENCERRANDO && pendente < SERVIDOR_PENDENTE ? EPOLLIN : 0) |
+                       (pendente > 0 ? EPOLLOUT : 0);
+    if (eventos == c->eventos) return 1;
+    struct epoll_event ev = { .events = eventos, .data.ptr = c };
+    if (epoll_ctl(sv->fdEpoll, EPOLL_CTL_MOD, c->fd, &ev) != 0) return 0;
+    c->eventos = eventos;
+    return 1;
+}
+
+// enviarSaida() – escreve o que der da saida pendente sem bloquear; a saida volta a ficar vazia
+// quando tudo foi enviado. Retorna 0 se a conexao falhou
+static int enviarSaida(Conexao *c) {
+    while (c->enviado < c->saida.usado) {
+        ssize_t r = send(c->fd, c->saida.dados + c->enviado, c->saida.usado - c->enviado, MSG_NOSIGNAL);
+        if (r > 0) c->enviado += (size_t) r;
+        else if (r < 0 && errno == EINTR) continue;
+        else if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 1;
+        else return 0;
+    }
+    c->saida.usado = c->enviado = 0;
+    return 1;
+}
+
+static void fecharConexao(ServidorSessoes *sv, Conexao *c) {
+    epoll_ctl(sv->fdEpoll, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    sv->conexoes[c->pos] = sv->conexoes[--sv->numConexoes];
+    sv->conexoes[c->pos]->pos = c->pos;
+    soltarVersao(c->versao);
+    liberarSessao(&c->se);
+    liberarBufferCrescente(&c->saida);
+    memLiberar(c);
+}
+
+// migrarSessao() – leva a sessao para a versao atual do caso se as salas forem as mesmas: as
+// pistas coletadas continuam validas (mesmos ids) e os pontos sao refeitos com a hash nova.
+// Se as salas mudaram, a sessao termina na versao em que comecou
+static void migrarSessao(ServidorSessoes *sv, Conexao *c) {
+    VersaoCaso *nova = sv->atual;
+    if (c->versao == nova || c->versao->impressaoSalas != nova->impressaoSalas) return;
+    c->se.pistas.textos = &nova->mansao.textos;
+    pontuarSuspeitos(&c->se.ev, &nova->ht, c->se.coletadas, c->se.pistas.total);
+    c->se.ev.limiar = nova->limiar;
+    prenderVersao(nova);
+    soltarVersao(c->versao);
+    c->versao = nova;
+    bufFormatar(&c->saida, "\n(o caso foi atualizado: versao %llu)\n", (unsigned long long) nova->numero);
+}
+
+static void encerrarConexao(Conexao *c) {
+    bufTexto(&c->saida, TEXTO_DESPEDIDA);
+    c->fase = FASE_ENCERRANDO;
+}
+
+// atenderEntrada() – trata as linhas completas que chegaram (exploracao e depois julgamento);
+// as respostas e a proxima tela vao para a saida da conexao, enviada de uma vez depois.
+// Com saida demais pendente, a conexao fica pausada (linhas ja lidas esperam no leitor).
+// Cada jogada da exploracao comeca migrando a sessao para a versao atual do caso; o julgamento
+// fica na versao em que a exploracao terminou
+static void atenderEntrada(ServidorSessoes *sv, Conexao *c) {
+    c->pausada = 0;
+    while (c->fase != FASE_ENCERRANDO) {
+        if (c->saida.usado - c->enviado >= SERVIDOR_PENDENTE) {
+            c->pausada = 1;
+            return;
+        }
+        char *linha;
+        size_t tam;
+        ResultadoLinha rl = lerLinhaEntrada(&c->entrada, &linha, &tam);
+        if (rl == LINHA_PENDENTE) return;
+        if (rl == LINHA_FIM) { // o jogador fechou a conexao
+            c->fase = FASE_ENCERRANDO;
+            return;
+        }
+        if (c->fase == FASE_EXPLORANDO) migrarSessao(sv, c);
+        VersaoCaso *v = c->versao;
+        if (c->fase == FASE_EXPLORANDO) {
+            ResultadoComando r = processarComando(&c->saida, &v->mansao, &c->se, &v->ht, &v->consultas, linha);
+            if (r == COMANDO_FEITO) {
+                escreverTelaSala(&c->saida, &v->mansao, &c->se, &v->ht, &v->consultas);
+            } else if (r == COMANDO_SAIR) {
+                if (iniciarJulgamento(&c->saida, &c->se)) c->fase = FASE_JULGANDO;
+                else encerrarConexao(c);
+            }
+        } else if (processarAcusacao(&c->saida, &c->se, &v->ht, &v->nomes, linha) != ACUSACAO_REPETIR) {
+            encerrarConexao(c);
+        }
+    }
+}
+
+// atenderConexao() – trata os eventos de uma conexao: linhas recebidas (ou ainda no leitor,
+// se ela estava pausada) e envio da saida. Retorna 0 se a conexao deve ser fechada
+static int atenderConexao(ServidorSessoes *sv, Conexao *c, uint32_t eventos) {
+    int ler = (eventos & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0;
+    for (;;) {
+        if (ler || c->pausada) atenderEntrada(sv, c);
+        if (!enviarSaida(c)) return 0;
+        if (!c->pausada || c->saida.usado > 0) break; // pausada com tudo enviado: continua
+        ler = 0;
+    }
+    if (c->fase == FASE_ENCERRANDO && c->saida.usado == 0) return 0;
+    return atualizarEventos(sv, c);
+}
+
+// aceita todas as conexoes pendentes; cada uma comeca com a abertura e a tela da sala inicial
+static void aceitarConexoes(ServidorSessoes *sv) {
+    for (;;) {
+        int fd = accept4(sv->fdEscuta, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                fprintf(stderr, "Aviso: accept falhou: %s\n", strerror(errno));
+            return;
+        }
+        if (sv->numConexoes == sv->capConexoes) {
+            size_t nova = sv->capConexoes ? sv->capConexoes * 2 : 64;
+            Conexao **v = (Conexao**) memRealocar(MEM_SERVIDOR, sv->conexoes, nova * sizeof(Conexao*));
+            if (v == NULL) { printf("Erro: memoria insuficiente (conexoes).\n"); exit(1); }
+            sv->conexoes = v;
+            sv->capConexoes = nova;
+        }
+        Conexao *c = (Conexao*) memZerada(MEM_SERVIDOR, 1, sizeof(Conexao));
+        if (c == NULL) { printf("Erro: memoria insuficiente (conexoes).\n"); exit(1); }
+        c->fd = fd;
+        c->fase = FASE_EXPLORANDO;
+        c->versao = sv->atual;
+        prenderVersao(c->versao);
+        iniciarSessao(&c->se, &c->versao->mansao, &c->versao->ht, c->versao->limiar);
+        inicializarLeitor(&c->entrada, fd);
+        inicializarBufferCrescente(&c->saida, BUFFER_SAIDA);
+        c->pos = sv->numConexoes;
+        sv->conexoes[sv->numConexoes++] = c;
+        sv->atendidas++;
+        struct epoll_event ev = { .events = EPOLLIN, .data.ptr = c };
+        if (epoll_ctl(sv->fdEpoll, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            fecharConexao(sv, c);
+            continue;
+        }
+        c->eventos = EPOLLIN;
+        bufTexto(&c->saida, TEXTO_ABERTURA);
+        coletarPistaSala(&c->se, &c->versao->mansao, &c->versao->ht);
+        escreverTelaSala(&c->saida, &c->versao->mansao, &c->se, &c->versao->ht, &c->versao->consultas);
+        if (!enviarSaida(c) || !atualizarEventos(sv, c)) fecharConexao(sv, c);
+    }
+}
+
+// servirSessoes() – atende jogadores num socket local (AF_UNIX) em 'caminho', uma sessao
+// independente por conexao, todas numa unica thread: epoll avisa quais conexoes tem linhas para
+// ler ou saida para escrever, e nenhuma leitura ou escrita bloqueia. Cada lote de linhas recebido
+// gera uma resposta escrita com um unico send. O caso vem de 'casos': cada lote de eventos e
+// uma leitura (a versao publicada pode mudar entre dois lotes, sem parar as sessoes). Roda ate
+// SIGINT/SIGTERM; retorna 0 se nao conseguiu abrir o socket
+int servirSessoes(const char *caminho, PublicadorCasos *casos) {
+    ServidorSessoes sv = { .fdEscuta = -1, .fdEpoll = -1, .casos = casos, .leitor = registrarLeitor(casos) };
+    if (sv.leitor < 0) {
+        printf("Erro: leitores demais para as versoes do caso.\n");
+        return 0;
+    }
+    struct sockaddr_un end = { .sun_family = AF_UNIX };
+    if (strlen(caminho) >= sizeof end.sun_path) {
+        printf("Erro: caminho de socket longo demais: %s\n", caminho);
+        return 0;
+    }
+    strcpy(end.sun_path, caminho);
+    unlink(caminho); // socket de uma execucao anterior
+    sv.fdEscuta = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    sv.fdEpoll = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = NULL };
+    if (sv.fdEscuta < 0 || sv.fdEpoll < 0 || bind(sv.fdEscuta, (struct sockaddr*) &end, sizeof end) != 0 ||
+        listen(sv.fdEscuta, SOMAXCONN) != 0 || epoll_ctl(sv.fdEpoll, EPOLL_CTL_ADD, sv.fdEscuta, &ev) != 0) {
+        printf("Erro: nao foi possivel escutar em '%s': %s\n", caminho, strerror(errno));
+        if (sv.fdEscuta >= 0) close(sv.fdEscuta);
+        if (sv.fdEpoll >= 0) close(sv.fdEpoll);
+        return 0;
+    }
+
+    // sem SA_RESTART: o sinal interrompe o epoll_wait
+    struct sigaction sa;
+    memset(&sa, 0, sizeof sa);
+    sa.sa_handler = pedirParadaServidor;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    fprintf(stderr, "Servidor de sessoes em '%s' (SIGHUP recarrega o caso, SIGINT encerra).\n", caminho);
+
+    struct epoll_event eventos[SERVIDOR_EVENTOS];
+    while (!servidorParar) {
+        int n = epoll_wait(sv.fdEpoll, eventos, SERVIDOR_EVENTOS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            printf("Erro: epoll_wait falhou: %s\n", strerror(errno));
+            break;
+        }
+        sv.atual = entrarLeitura(casos, sv.leitor);
+        for (int i = 0; i < n; ++i) {
+            Conexao *c = (Conexao*) eventos[i].data.ptr;
+            if (c == NULL) {
+                aceitarConexoes(&sv);
+                continue;
+            }
+            if (!atenderConexao(&sv, c, eventos[i].events)) fecharConexao(&sv, c);
+        }
+        sairLeitura(casos, sv.leitor);
+        // sessoes que migraram ou fecharam podem ter soltado a ultima referencia a uma versao antiga
+        if (atomic_load_explicit(&casos->numRetiradas, memory_order_relaxed) > 0) recolherVersoes(casos);
+    }
+
+    while (sv.numConexoes > 0) fecharConexao(&sv, sv.conexoes[sv.numConexoes - 1]);
+    memLiberar(sv.conexoes);
+    close(sv.fdEpoll);
+    close(sv.fdEscuta);
+    unlink(caminho);
+    fprintf(stderr, "Servidor encerrado: %zu conexao(oes) atendida(s).\n", sv.atendidas);
+    return 1;
+}
+
+// =========================
+// RECARGA DO CASO
+// =========================
+
+
+// carregarVersaoCaso() – carrega o caso de novo a partir da fonte; NULL (com a mensagem) se o
+// mapa nao puder ser lido. Um mapa binario fica mapeado enquanto a versao viver: para troca-lo,
+// grave outro arquivo e renomeie por cima (como faz --compilar), em vez de reescreve-lo
+VersaoCaso* carregarVersaoCaso(const FonteCaso *f) {
+    Mansao m;
+    HashTable ht;
+    if (f->fixa != NULL) {
+        abrirMansaoFixa(f->fixa, &m, &ht);
+        return montarVersaoCaso(&m, &ht, f->limiar);
+    }
+    if (f->gerado != NULL) {
+        ParamGeracao g;
+        if (!lerParamGeracao(f->gerado, &g)) return NULL;
+        gerarMansao(&g, &m);
+    } else if (f->caminho != NULL) {
+        if (!carregarMansao(f->caminho, &m)) return NULL;
+    } else {
+        montarMansaoPadrao(&m);
+    }
+    inicializarHash(&ht, &m.textos);
+    popularHash(&ht, &m);
+    return montarVersaoCaso(&m, &ht, f->limiar);
+}
+
+// thread de recarga: a cada SIGHUP carrega o caso fora da thread do servidor e publica a versao
+static void* recarregarCaso(void *arg) {
+    RecargaCaso *r = (RecargaCaso*) arg;
+    sigset_t sinais;
+    sigemptyset(&sinais);
+    sigaddset(&sinais, SIGHUP);
+    for (;;) {
+        int sinal;
+        if (sigwait(&sinais, &sinal) != 0) continue;
+        if (atomic_load(&r->parar)) break;
+        VersaoCaso *nova = carregarVersaoCaso(r->fonte);
+        if (nova == NULL) {
+            fflush(stdout);
+            fprintf(stderr, "Aviso: recarga do caso falhou; a versao em uso continua valendo.\n");
+            continue;
+        }
+        publicarVersao(r->casos, nova);
+        fprintf(stderr, "Caso recarregado: versao %llu (%u salas, %u associacoes); versoes antigas em uso: %zu\n",
+                (unsigned long long) nova->numero, nova->mansao.numSalas, nova->mansao.numAssociacoes,
+                atomic_load(&r->casos->numRetiradas));
+    }
+    return NULL;
+}
+
+// iniciarRecarga() – bloqueia SIGHUP nesta thread (e nas que ela criar depois) e dispara a thread
+// que espera por ele: kill -HUP <pid> recarrega o caso sem parar as sessoes
+void iniciarRecarga(RecargaCaso *r, PublicadorCasos *casos, const FonteCaso *fonte) {
+    r->casos = casos;
+    r->fonte = fonte;
+    atomic_init(&r->parar, 0);
+    sigset_t sinais;
+    sigemptyset(&sinais);
+    sigaddset(&sinais, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &sinais, NULL);
+    if (pthread_create(&r->thread, NULL, recarregarCaso, r) != 0) {
+        printf("Erro: nao foi possivel criar a thread de recarga.\n");
+        exit(1);
+    }
+}
+
+// encerra a thread de recarga (uma recarga em andamento termina antes); SIGHUP segue bloqueado
+void pararRecarga(RecargaCaso *r) {
+    atomic_store(&r->parar, 1);
+    pthread_kill(r->thread, SIGHUP);
+    pthread_join(r->thread, NULL);
+}
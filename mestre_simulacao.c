@@ -0,0 +1,436 @@
+// Simulacao de agentes do Detetive Quest (--simular)
+
+#include "NivelMestre4.h"
+
+// =========================
+// SIMULACAO DE AGENTES
+// =========================
+
+
+static const char *nomesEstrategias[NUM_ESTRATEGIAS] = { "aleatorio", "guloso", "informado" };
+
+// lerParamSimulacao() – interpreta "<estrategias>:<agentes>[:chave=valor...]", p.ex.
+//   guloso,informado:1000000:passos=128:semente=7:culpado=Sr. Silva
+// estrategias: aleatorio, guloso, informado (separadas por virgula) ou todas;
+// chaves: semente, passos (movimentos maximos por agente) e culpado (padrao: o suspeito com
+// maior peso total de evidencias no mapa)
+int lerParamSimulacao(const char *spec, ParamSimulacao *p) {
+    char buf[512];
+    snprintf(buf, sizeof buf, "%s", spec);
+    memset(p, 0, sizeof *p);
+    p->semente = 1;
+    p->passos = SIM_PASSOS;
+    char *campo = strtok(buf, ":");
+    for (char *nome = campo; nome != NULL && *nome != '\0'; ) {
+        size_t n = strcspn(nome, ",");
+        int e = 0;
+        while (e < NUM_ESTRATEGIAS && (strlen(nomesEstrategias[e]) != n || strncmp(nome, nomesEstrategias[e], n) != 0)) e++;
+        if (n == 5 && strncmp(nome, "todas", 5) == 0) p->estrategias = (1u << NUM_ESTRATEGIAS) - 1;
+        else if (e < NUM_ESTRATEGIAS) p->estrategias |= 1u << e;
+        else { p->estrategias = 0; break; }
+        nome += n + (nome[n] == ',');
+    }
+    if (p->estrategias == 0) {
+        printf("Erro: estrategia invalida em '%s' (use aleatorio, guloso, informado ou todas).\n", spec);
+        return 0;
+    }
+    uint64_t v;
+    campo = strtok(NULL, ":");
+    if (campo == NULL || !lerLimitado(campo, 1, UINT32_MAX, &v)) {
+        printf("Erro: numero de agentes invalido em '%s' (1 a %u).\n", spec, UINT32_MAX);
+        return 0;
+    }
+    p->agentes = (uint32_t) v;
+    while ((campo = strtok(NULL, ":")) != NULL) {
+        char *igual = strchr(campo, '=');
+        int ok = 0;
+        if (igual != NULL) {
+            *igual = '\0';
+            const char *valor = igual + 1;
+            if (strcmp(campo, "semente") == 0) ok = lerLimitado(valor, 0, UINT64_MAX, &p->semente);
+            if (strcmp(campo, "passos") == 0 && lerLimitado(valor, 1, 1u << 24, &v)) {
+                p->passos = (uint32_t) v;
+                ok = 1;
+            }
+            if (strcmp(campo, "culpado") == 0 && valor[0] != '\0') {
+                snprintf(p->culpado, sizeof p->culpado, "%s", valor);
+                ok = 1;
+            }
+        }
+        if (!ok) {
+            printf("Erro: parametro invalido '%s' na especificacao da simulacao.\n", campo);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// suspeito com o maior peso total de evidencias espalhadas pelo mapa (empate: o primeiro cadastrado)
+static uint32_t culpadoPadrao(const HashTable *ht) {
+    uint32_t melhor = UINT32_MAX;
+    uint64_t maior = 0;
+    for (uint32_t s = 0; s < ht->numSuspeitos; ++s) {
+        const Postagem *p = pistasDoSuspeito(ht, s);
+        uint64_t total = 0;
+        for (uint32_t k = 0; k < ht->pistasSuspeito[s].quantidade; ++k) total += p[k].peso;
+        if (total > maior) { maior = total; melhor = s; }
+    }
+    return melhor;
+}
+
+static void iniciarEstatisticas(EstatisticasSim *est, uint32_t passos, uint32_t numSuspeitos) {
+    memset(est, 0, sizeof *est);
+    est->movimentos = (uint64_t*) memZerada(MEM_SIMULACAO, (size_t) passos + 2, sizeof(uint64_t));
+    est->pistas = (uint64_t*) memZerada(MEM_SIMULACAO, (size_t) passos + 2, sizeof(uint64_t));
+    if (numSuspeitos > 0 && numSuspeitos <= SIM_SUSPEITOS_LOCAIS) {
+        est->acusacoes = (uint64_t*) memZerada(MEM_SIMULACAO, numSuspeitos, sizeof(uint64_t));
+        est->condenados = (uint64_t*) memZerada(MEM_SIMULACAO, numSuspeitos, sizeof(uint64_t));
+        if (est->acusacoes == NULL || est->condenados == NULL) {
+            printf("Erro: memoria insuficiente (simulacao).\n");
+            exit(1);
+        }
+    }
+    if (est->movimentos == NULL || est->pistas == NULL) { printf("Erro: memoria insuficiente (simulacao).\n"); exit(1); }
+}
+
+// zera as contagens mantendo os vetores (reaproveitados de uma estrategia para a outra)
+static void zerarEstatisticas(EstatisticasSim *est, uint32_t passos, uint32_t numSuspeitos) {
+    est->agentes = est->semAcusacao = est->condenacoes = est->acertos = 0;
+    est->somaMovimentos = est->somaPistas = 0;
+    memset(est->movimentos, 0, ((size_t) passos + 2) * sizeof(uint64_t));
+    memset(est->pistas, 0, ((size_t) passos + 2) * sizeof(uint64_t));
+    if (est->acusacoes != NULL) {
+        memset(est->acusacoes, 0, numSuspeitos * sizeof(uint64_t));
+        memset(est->condenados, 0, numSuspeitos * sizeof(uint64_t));
+    }
+}
+
+// soma as estatisticas de uma thread no total (os vetores por suspeito vao para a simulacao)
+static void somarEstatisticas(EstatisticasSim *total, const EstatisticasSim *est, Simulacao *sim) {
+    total->agentes += est->agentes;
+    total->semAcusacao += est->semAcusacao;
+    total->condenacoes += est->condenacoes;
+    total->acertos += est->acertos;
+    total->somaMovimentos += est->somaMovimentos;
+    total->somaPistas += est->somaPistas;
+    for (uint32_t v = 0; v < sim->p->passos + 2; ++v) {
+        total->movimentos[v] += est->movimentos[v];
+        total->pistas[v] += est->pistas[v];
+    }
+    for (uint32_t s = 0; est->acusacoes != NULL && s < sim->ht->numSuspeitos; ++s) {
+        atomic_fetch_add_explicit(&sim->acusacoes[s], est->acusacoes[s], memory_order_relaxed);
+        atomic_fetch_add_explicit(&sim->condenados[s], est->condenados[s], memory_order_relaxed);
+    }
+}
+
+static void liberarEstatisticas(EstatisticasSim *est) {
+    memLiberar(est->movimentos);
+    memLiberar(est->pistas);
+    memLiberar(est->acusacoes);
+    memLiberar(est->condenados);
+    memset(est, 0, sizeof *est);
+}
+
+static inline uint64_t sortearAgente(AgenteSim *a) {
+    uint64_t x = a->sorteio;
+    x ^= x << 13; x ^= x >> 7; x ^= x << 17; // xorshift64
+    return a->sorteio = x;
+}
+
+// atualiza o lider depois da coleta de 'pista': os pontos so crescem, entao basta comparar o
+// lider atual com os suspeitos que a pista implica (empate: fica quem chegou primeiro)
+static void atualizarLider(AgenteSim *a, const HashTable *ht, uint32_t pista) {
+    const HashEntrada *e = encontrarEntrada(ht, pista);
+    if (e == NULL) return;
+    const Postagem *p = suspeitosDaPista(ht, e);
+    const uint32_t *pontos = a->se.ev.pontos;
+    for (uint32_t k = 0; k < e->suspeitos.quantidade; ++k)
+        if (p[k].peso > 0 && (a->lider == UINT32_MAX || pontos[p[k].id] > pontos[a->lider])) a->lider = p[k].id;
+}
+
+// o agente acaba de chegar a sala atual: marca como vista e coleta a pista
+static void entrarSalaAgente(AgenteSim *a, const Mansao *m, const HashTable *ht) {
+    marcarVisita(&a->vistas, a->se.salaAtual);
+    if (coletarPistaSala(&a->se, m, ht)) atualizarLider(a, ht, m->salas[a->se.salaAtual].pista);
+}
+
+// nota de uma saida para as estrategias que olham um passo a frente: 0 = sala ja vista,
+// 1 = nova sem pista, 2 = nova com pista, 3 = nova com pista contra o lider (so a informada)
+static uint32_t notaSaida(const AgenteSim *a, const Mansao *m, const HashTable *ht, int32_t destino, int informada) {
+    if (salaMarcada(&a->vistas, destino)) return 0;
+    uint32_t pista = m->salas[destino].pista;
+    if (pista == TEXTO_VAZIO) return 1;
+    if (informada && a->lider != UINT32_MAX) {
+        const HashEntrada *e = encontrarEntrada(ht, pista);
+        if (e != NULL && implicaSuspeito(ht, e, a->lider)) return 3;
+    }
+    return 2;
+}
+
+// escolherSaida() – saida da sala atual para o proximo passo, entre as de maior nota (empates
+// sorteados); UINT32_MAX se nao houver saida valida ou, fora da aleatoria, nenhuma sala nova
+static uint32_t escolherSaida(AgenteSim *a, const Mansao *m, const HashTable *ht, EstrategiaAgente est) {
+    int32_t sala = a->se.salaAtual;
+    uint32_t grau = numSaidasSala(m, sala), escolhida = UINT32_MAX, melhor = 0, empates = 0;
+    for (uint32_t k = 0; k < grau; ++k) {
+        int32_t destino = saidaSala(m, sala, k);
+        if (!salaValida(m, destino)) continue;
+        uint32_t nota = est == ESTRATEGIA_ALEATORIA ? 1 : notaSaida(a, m, ht, destino, est == ESTRATEGIA_INFORMADA);
+        if (nota == 0 || nota < melhor) continue;
+        if (nota > melhor) { melhor = nota; empates = 0; }
+        if (sorteioAte(sortearAgente(a), ++empates) == 0) escolhida = k;
+    }
+    return escolhida;
+}
+
+// simularAgente() – uma investigacao completa do agente 'i'. O gerador e refeito a partir de
+// (semente, i, estrategia), entao o agente faz o mesmo caminho em qualquer thread
+static void simularAgente(AgenteSim *a, const Simulacao *sim, uint64_t i) {
+    const Mansao *m = sim->mansao;
+    const HashTable *ht = sim->ht;
+    reiniciarSessao(&a->se, m);
+    limparVisitas(&a->vistas);
+    a->lider = UINT32_MAX;
+    a->sorteio = sorteioGerador(sim->p->semente, i, (uint64_t) sim->estrategia + 1) | 1;
+    entrarSalaAgente(a, m, ht);
+    while (a->se.movimentos < sim->p->passos) {
+        if (sim->estrategia == ESTRATEGIA_INFORMADA && a->lider != UINT32_MAX &&
+            a->se.ev.pontos[a->lider] >= a->se.ev.limiar) break; // ja da para condenar
+        uint32_t k = escolherSaida(a, m, ht, sim->estrategia);
+        if (k != UINT32_MAX) moverParaSaida(&a->se, m, k);
+        else if (sim->estrategia == ESTRATEGIA_ALEATORIA || moverSessao(&a->se, m, 'v') != MOV_OK) break;
+        entrarSalaAgente(a, m, ht);
+    }
+}
+
+// acusa o lider e conta o resultado do agente 'i' nas estatisticas da thread
+static void contabilizarAgente(TrabalhadorSim *t, uint64_t i) {
+    const AgenteSim *a = &t->agente;
+    EstatisticasSim *est = &t->est;
+    Simulacao *sim = t->sim;
+    uint32_t mov = a->se.movimentos, pistas = (uint32_t) a->se.pistas.total, pontos = 0;
+    int condenado = 0;
+    est->agentes++;
+    est->somaMovimentos += mov;
+    est->somaPistas += pistas;
+    est->movimentos[mov]++;
+    est->pistas[pistas]++;
+    if (a->lider == UINT32_MAX) {
+        est->semAcusacao++;
+    } else {
+        pontos = a->se.ev.pontos[a->lider];
+        condenado = pontos >= a->se.ev.limiar;
+        est->condenacoes += condenado;
+        est->acertos += condenado && a->lider == sim->culpado;
+        if (est->acusacoes != NULL) {
+            est->acusacoes[a->lider]++;
+            est->condenados[a->lider] += condenado;
+        } else { // suspeitos demais para um vetor por thread
+            atomic_fetch_add_explicit(&sim->acusacoes[a->lider], 1, memory_order_relaxed);
+            if (condenado) atomic_fetch_add_explicit(&sim->condenados[a->lider], 1, memory_order_relaxed);
+        }
+    }
+    if (sim->registros != NULL)
+        bufFormatar(&t->registros, "%llu\t%s\t%d\t%u\t%u\t%u\t%d\t%s\n", (unsigned long long) i + 1,
+                    nomesEstrategias[sim->estrategia], (int) a->se.salaAtual, mov, pistas, pontos, condenado,
+                    a->lider != UINT32_MAX ? textoInterno(sim->ht->textos, sim->ht->nomeSuspeito[a->lider]) : "");
+}
+
+// laco de cada trabalhador: o mesmo roubo de trabalho do motor de sessoes, sobre faixas de agentes
+static void* trabalhadorSimulacao(void *arg) {
+    TrabalhadorSim *t = (TrabalhadorSim*) arg;
+    Simulacao *sim = t->sim;
+    uint32_t ini, fim;
+    for (;;) {
+        while (pegarLote(&t->faixa, MOTOR_LOTE, &ini, &fim)) {
+            for (uint32_t i = ini; i < fim; ++i) {
+                simularAgente(&t->agente, sim, i);
+                contabilizarAgente(t, i);
+            }
+        }
+        int roubou = 0;
+        for (int k = 1; k < sim->numTrabalhadores && !roubou; ++k) {
+            TrabalhadorSim *v = &sim->trabalhadores[(t->indice + k) % sim->numTrabalhadores];
+            if (roubarMetade(&v->faixa, &ini, &fim)) {
+                atomic_store_explicit(&t->faixa.faixa, empacotarFaixa(ini, fim), memory_order_release);
+                roubou = 1;
+            }
+        }
+        if (!roubou) break;
+    }
+    descarregarBuffer(&t->registros);
+    return NULL;
+}
+
+// menor valor v com pelo menos a fracao 'q' dos agentes em h[0..v]
+static uint32_t percentilSim(const uint64_t *h, uint32_t n, uint64_t total, double q) {
+    uint64_t alvo = (uint64_t) (q * (double) total + 0.5), acumulado = 0;
+    if (alvo == 0) alvo = 1;
+    for (uint32_t v = 0; v < n; ++v) {
+        acumulado += h[v];
+        if (acumulado >= alvo) return v;
+    }
+    return n - 1;
+}
+
+static void escreverDistribuicao(FILE *saida, const char *nome, const uint64_t *h, uint32_t n,
+                                 uint64_t soma, uint64_t total) {
+    uint32_t maximo = n - 1;
+    while (maximo > 0 && h[maximo] == 0) maximo--;
+    fprintf(saida, "%-11s media=%.2f p50=%u p90=%u p99=%u max=%u\n", nome, (double) soma / (double) total,
+            percentilSim(h, n, total, 0.50), percentilSim(h, n, total, 0.90), percentilSim(h, n, total, 0.99), maximo);
+}
+
+// suspeitos do mais condenado para o menos (empate: ordem de cadastro); 'ctx' sao as condenacoes
+static int compararCondenados(const void *a, const void *b, void *ctx) {
+    const _Atomic uint64_t *condenados = (const _Atomic uint64_t*) ctx;
+    uint32_t x = *(const uint32_t*) a, y = *(const uint32_t*) b;
+    uint64_t cx = atomic_load_explicit(&condenados[x], memory_order_relaxed);
+    uint64_t cy = atomic_load_explicit(&condenados[y], memory_order_relaxed);
+    if (cx != cy) return cx > cy ? -1 : 1;
+    return (x > y) - (x < y);
+}
+
+// resumo de uma estrategia: acertos, condenacoes por suspeito, cobertura de pistas e caminhos
+static void escreverResumoSimulacao(FILE *saida, const Simulacao *sim, const EstatisticasSim *total,
+                                    uint32_t pistasMapa, double seg) {
+    const HashTable *ht = sim->ht;
+    double n = (double) total->agentes;
+    fprintf(saida, "===== SIMULACAO: %s (%llu agentes, semente %llu, ate %u movimentos, limiar %u) =====\n",
+            nomesEstrategias[sim->estrategia], (unsigned long long) total->agentes,
+            (unsigned long long) sim->p->semente, sim->p->passos, sim->p->limiar);
+    if (sim->culpado != UINT32_MAX)
+        fprintf(saida, "culpado: %s\n", textoInterno(ht->textos, ht->nomeSuspeito[sim->culpado]));
+    fprintf(saida, "condenam o culpado:   %llu (%.2f%%)\n", (unsigned long long) total->acertos,
+            100.0 * (double) total->acertos / n);
+    fprintf(saida, "condenam um inocente: %llu (%.2f%%)\n", (unsigned long long) (total->condenacoes - total->acertos),
+            100.0 * (double) (total->condenacoes - total->acertos) / n);
+    uint64_t fracas = total->agentes - total->condenacoes - total->semAcusacao;
+    fprintf(saida, "sem evidencias para condenar: %llu (%.2f%%), sem acusacao: %llu (%.2f%%)\n",
+            (unsigned long long) fracas, 100.0 * (double) fracas / n,
+            (unsigned long long) total->semAcusacao, 100.0 * (double) total->semAcusacao / n);
+    fprintf(saida, "cobertura de pistas: %.2f%% das %u pistas do mapa por agente\n",
+            pistasMapa ? 100.0 * (double) total->somaPistas / n / (double) pistasMapa : 0.0, pistasMapa);
+    escreverDistribuicao(saida, "pistas", total->pistas, sim->p->passos + 2, total->somaPistas, total->agentes);
+    escreverDistribuicao(saida, "movimentos", total->movimentos, sim->p->passos + 2, total->somaMovimentos, total->agentes);
+
+    // por suspeito: fracao dos agentes que o acusaram e que o condenaram
+    uint32_t ns = ht->numSuspeitos;
+    uint32_t *ordem = (uint32_t*) memAlocar(MEM_SIMULACAO, (ns ? ns : 1) * sizeof(uint32_t));
+    if (ordem == NULL) { printf("Erro: memoria insuficiente (simulacao).\n"); exit(1); }
+    for (uint32_t s = 0; s < ns; ++s) ordem[s] = s;
+    qsort_r(ordem, ns, sizeof(uint32_t), compararCondenados, (void*) sim->condenados);
+    uint32_t exibir = ns < RANKING_EXIBIDOS ? ns : RANKING_EXIBIDOS;
+    fprintf(saida, "por suspeito (acusado / condenado):\n");
+    for (uint32_t k = 0; k < exibir; ++k) {
+        uint32_t s = ordem[k];
+        fprintf(saida, "  %s%s: %.2f%% / %.2f%%\n", textoInterno(ht->textos, ht->nomeSuspeito[s]),
+                s == sim->culpado ? " (culpado)" : "",
+                100.0 * (double) atomic_load_explicit(&sim->acusacoes[s], memory_order_relaxed) / n,
+                100.0 * (double) atomic_load_explicit(&sim->condenados[s], memory_order_relaxed) / n);
+    }
+    if (exibir < ns) fprintf(saida, "  (... e mais %u suspeito(s))\n", ns - exibir);
+    fprintf(saida, "tempo_ms=%.1f agentes/s=%.0f\n\n", seg * 1e3, n / seg);
+    memLiberar(ordem);
+}
+
+// simularAgentes() – roda p->agentes investigacoes automaticas para cada estrategia pedida, em
+// 'numThreads' trabalhadores, e escreve em 'saida' o resumo de cada uma. Nada e guardado por
+// agente: cada thread soma os resultados nas proprias estatisticas e, com 'registros', escreve
+// uma linha por agente, em blocos, enquanto simula (as threads se intercalam nesse arquivo):
+//   agente  estrategia  sala_final  movimentos  pistas  pontos  veredito(1 = culpado)  acusado
+// retorna 0 se o culpado informado nao for um suspeito do mapa
+int simularAgentes(FILE *saida, const Mansao *m, const HashTable *ht, const ParamSimulacao *p,
+                   int numThreads, FILE *registros) {
+    if (numThreads < 1) numThreads = 1;
+    uint32_t culpado = p->culpado[0] != '\0' ? suspeitoPorNome(ht, p->culpado) : culpadoPadrao(ht);
+    if (p->culpado[0] != '\0' && culpado == UINT32_MAX) {
+        printf("Erro: suspeito culpado desconhecido: %s\n", p->culpado);
+        return 0;
+    }
+
+    // pistas distintas espalhadas pelas salas (o denominador da cobertura)
+    uint32_t numTextos = m->textos.numBase + m->textos.numProprios, pistasMapa = 0;
+    unsigned char *vista = (unsigned char*) memZerada(MEM_SIMULACAO, numTextos ? numTextos : 1, 1);
+    if (vista == NULL) { printf("Erro: memoria insuficiente (simulacao).\n"); exit(1); }
+    for (uint32_t s = 0; s < m->numSalas; ++s) {
+        uint32_t pista = m->salas[s].pista;
+        if (pista != TEXTO_VAZIO && pista < numTextos && !vista[pista]) { vista[pista] = 1; pistasMapa++; }
+    }
+    memLiberar(vista);
+
+    Simulacao sim;
+    sim.mansao = m;
+    sim.ht = ht;
+    sim.p = p;
+    sim.culpado = culpado;
+    sim.registros = registros;
+    sim.numTrabalhadores = numThreads;
+    sim.trabalhadores = (TrabalhadorSim*) memZerada(MEM_SIMULACAO, (size_t) numThreads, sizeof(TrabalhadorSim));
+    sim.acusacoes = (_Atomic uint64_t*) memZerada(MEM_SIMULACAO, ht->numSuspeitos ? ht->numSuspeitos : 1, sizeof(uint64_t));
+    sim.condenados = (_Atomic uint64_t*) memZerada(MEM_SIMULACAO, ht->numSuspeitos ? ht->numSuspeitos : 1, sizeof(uint64_t));
+    pthread_t *threads = (pthread_t*) memAlocar(MEM_SIMULACAO, (size_t) numThreads * sizeof(pthread_t));
+    if (sim.trabalhadores == NULL || sim.acusacoes == NULL || sim.condenados == NULL || threads == NULL) {
+        printf("Erro: memoria insuficiente (simulacao).\n");
+        exit(1);
+    }
+    // agentes e estatisticas vivem a simulacao inteira: cada estrategia so os zera
+    for (int i = 0; i < numThreads; ++i) {
+        TrabalhadorSim *t = &sim.trabalhadores[i];
+        t->sim = &sim;
+        t->indice = i;
+        iniciarSessao(&t->agente.se, m, ht, p->limiar);
+        iniciarEstatisticas(&t->est, p->passos, ht->numSuspeitos);
+        if (registros != NULL) {
+            char *mem = (char*) memAlocar(MEM_SIMULACAO, SIM_BUFFER);
+            if (mem == NULL) { printf("Erro: memoria insuficiente (simulacao).\n"); exit(1); }
+            inicializarBufferSaida(&t->registros, registros, mem, SIM_BUFFER);
+        }
+    }
+    EstatisticasSim total;
+    iniciarEstatisticas(&total, p->passos, 0);
+
+    for (int e = 0; e < NUM_ESTRATEGIAS; ++e) {
+        if (!(p->estrategias & (1u << e))) continue;
+        sim.estrategia = (EstrategiaAgente) e;
+        for (int i = 0; i < numThreads; ++i) {
+            TrabalhadorSim *t = &sim.trabalhadores[i];
+            zerarEstatisticas(&t->est, p->passos, ht->numSuspeitos);
+            atomic_init(&t->faixa.faixa, empacotarFaixa((uint32_t) ((uint64_t) p->agentes * (uint64_t) i / (uint64_t) numThreads),
+                                                        (uint32_t) ((uint64_t) p->agentes * (uint64_t) (i + 1) / (uint64_t) numThreads)));
+        }
+        memset(sim.acusacoes, 0, ht->numSuspeitos * sizeof(uint64_t));
+        memset(sim.condenados, 0, ht->numSuspeitos * sizeof(uint64_t));
+
+        double inicio = agoraNs();
+        for (int i = 1; i < numThreads; ++i) {
+            if (pthread_create(&threads[i], NULL, trabalhadorSimulacao, &sim.trabalhadores[i]) != 0) {
+                printf("Erro: nao foi possivel criar thread de simulacao.\n");
+                exit(1);
+            }
+        }
+        trabalhadorSimulacao(&sim.trabalhadores[0]); // a thread chamadora tambem simula
+        for (int i = 1; i < numThreads; ++i) pthread_join(threads[i], NULL);
+        double seg = (agoraNs() - inicio) / 1e9;
+
+        // o total e somado na ordem das threads depois do join: so somas, o resultado e sempre o mesmo
+        zerarEstatisticas(&total, p->passos, 0);
+        for (int i = 0; i < numThreads; ++i) somarEstatisticas(&total, &sim.trabalhadores[i].est, &sim);
+        escreverResumoSimulacao(saida, &sim, &total, pistasMapa, seg);
+        fflush(saida);
+    }
+
+    for (int i = 0; i < numThreads; ++i) {
+        TrabalhadorSim *t = &sim.trabalhadores[i];
+        liberarSessao(&t->agente.se);
+        memLiberar(t->agente.vistas.itens); // crescido por marcarVisita
+        liberarEstatisticas(&t->est);
+        if (registros != NULL) memLiberar(t->registros.dados);
+    }
+    liberarEstatisticas(&total);
+    memLiberar(threads);
+    memLiberar((void*) sim.acusacoes);
+    memLiberar((void*) sim.condenados);
+    memLiberar(sim.trabalhadores);
+    return 1;
+}
@@ -0,0 +1,27 @@
+// Apoio comum dos testes do nivel mestre (make test roda cada um a partir da raiz do repositorio)
+#ifndef TESTE_H
+#define TESTE_H
+
+#include "../NivelMestre4.h"
+
+#ifndef INSTRUMENTAR
+#error "compile os testes com -DINSTRUMENTAR (make test)"
+#endif
+
+#define VERIFICAR(cond, ...)                                                     \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            printf("Erro: %s:%d: ", __FILE__, __LINE__);                        \
+            printf(__VA_ARGS__);                                                 \
+            printf("\n");                                                        \
+            exit(1);                                                             \
+        }                                                                        \
+    } while (0)
+
+// confere no fim de um teste que toda a memoria contabilizada foi devolvida
+static inline void verificarSemVazamentos(void) {
+    size_t viva = atomic_load(&memoriaViva);
+    VERIFICAR(viva == 0, "%zu bytes ainda vivos no fim", viva);
+}
+
+#endif
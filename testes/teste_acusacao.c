@@ -0,0 +1,96 @@
+// Teste do julgamento (processarAcusacao) nas duas mansoes de exemplo: entradas sem letras nem
+// numeros e nomes que nao lembram nenhum suspeito pedem outra tentativa, com a mensagem certa e
+// sem pontuar ninguem; nomes cadastrados, sobrenomes e prefixos chegam ao veredito
+
+#include "teste.h"
+
+static const char *MAPAS[] = { "mansoes/padrao.txt", "mansoes/casarao.txt" };
+
+typedef struct CasoAcusacao {
+    const char *entrada;
+    ResultadoAcusacao esperado;
+    const char *trecho;      // deve aparecer na resposta
+} CasoAcusacao;
+
+static const CasoAcusacao CASOS[] = {
+    { "",               ACUSACAO_ABORTADA,  "Nenhum nome informado" },
+    { "?",              ACUSACAO_REPETIR,   "letras ou numeros" },
+    { "??",             ACUSACAO_REPETIR,   "letras ou numeros" },
+    { "...",            ACUSACAO_REPETIR,   "letras ou numeros" },
+    { "   \r\n",        ACUSACAO_REPETIR,   "letras ou numeros" },
+    { "zzzzzzzzzzzz",   ACUSACAO_REPETIR,   "Suspeito desconhecido" },
+    { "\xff\xfe",       ACUSACAO_REPETIR,   "Suspeito desconhecido" },
+    { "xyzw?",          ACUSACAO_REPETIR,   "Nenhum suspeito comeca" },
+    { "sr.",            ACUSACAO_REPETIR,   "Voce quis dizer:\n  - " },
+    { "sr?",            ACUSACAO_REPETIR,   "Voce quis dizer:\n  - " },
+    { "silva",          ACUSACAO_CONCLUIDA, "(entendido como: Sr. Silva)" },
+    { "Sr. Silva",      ACUSACAO_CONCLUIDA, "Pontos de evidencia contra Sr. Silva" },
+};
+
+// resposta de uma linha do julgamento, como texto terminado em '\0'
+static ResultadoAcusacao acusar(Sessao *se, const HashTable *ht, IndiceNomes *ix, const char *linha,
+                                char *resposta, size_t cap) {
+    BufferSaida b;
+    inicializarBufferCrescente(&b, 256);
+    ResultadoAcusacao r = processarAcusacao(&b, se, ht, ix, linha);
+    VERIFICAR(b.usado < cap, "resposta longa demais para \"%s\"", linha);
+    memcpy(resposta, b.dados, b.usado);
+    resposta[b.usado] = '\0';
+    liberarBufferCrescente(&b);
+    return r;
+}
+
+static void testarMapa(const char *mapa) {
+    Mansao m;
+    VERIFICAR(carregarMansao(mapa, &m), "nao abriu %s", mapa);
+    HashTable ht;
+    inicializarHash(&ht, &m.textos);
+    popularHash(&ht, &m);
+    IndiceNomes ix;
+    construirIndiceNomes(&ix, &ht);
+    Sessao se;
+    iniciarSessao(&se, &m, &ht, limiarDoCaso(&m, 0));
+    char resposta[4096];
+
+    for (size_t k = 0; k < sizeof CASOS / sizeof CASOS[0]; ++k) {
+        const CasoAcusacao *c = &CASOS[k];
+        ResultadoAcusacao r = acusar(&se, &ht, &ix, c->entrada, resposta, sizeof resposta);
+        VERIFICAR(r == c->esperado, "%s: \"%s\" deu %d, esperado %d:\n%s", mapa, c->entrada, r, c->esperado, resposta);
+        VERIFICAR(strstr(resposta, c->trecho) != NULL, "%s: \"%s\" sem \"%s\":\n%s", mapa, c->entrada, c->trecho, resposta);
+        // so o veredito pontua; e a lista de sugestoes nunca sai sem nenhum nome
+        VERIFICAR((strstr(resposta, "Pontos de evidencia") != NULL) == (r == ACUSACAO_CONCLUIDA),
+                  "%s: \"%s\" pontuou sem veredito (ou o contrario):\n%s", mapa, c->entrada, resposta);
+        const char *lista = strstr(resposta, "Voce quis dizer:\n");
+        VERIFICAR(lista == NULL || strncmp(lista + 17, "  - ", 4) == 0,
+                  "%s: \"%s\" com lista de sugestoes vazia:\n%s", mapa, c->entrada, resposta);
+    }
+
+    // cada suspeito cadastrado, pelo nome exato e em minusculas
+    for (uint32_t s = 0; s < ht.numSuspeitos; ++s) {
+        const char *nome = textoInterno(&m.textos, ht.nomeSuspeito[s]);
+        char esperado[MAXNOME + 64], minusculo[MAXNOME];
+        snprintf(esperado, sizeof esperado, "Pontos de evidencia contra %s:", nome);
+        size_t i = 0;
+        for (; nome[i] != '\0' && i + 1 < sizeof minusculo; ++i) minusculo[i] = (char) tolower((unsigned char) nome[i]);
+        minusculo[i] = '\0';
+        const char *entradas[] = { nome, minusculo };
+        for (size_t k = 0; k < 2; ++k) {
+            ResultadoAcusacao r = acusar(&se, &ht, &ix, entradas[k], resposta, sizeof resposta);
+            VERIFICAR(r == ACUSACAO_CONCLUIDA && strstr(resposta, esperado) != NULL,
+                      "%s: \"%s\" nao acusou %s:\n%s", mapa, entradas[k], nome, resposta);
+        }
+    }
+
+    liberarSessao(&se);
+    liberarIndiceNomes(&ix);
+    liberarHash(&ht);
+    liberarMansao(&m);
+}
+
+int main(void) {
+    inicializarSementeHash();
+    for (size_t i = 0; i < sizeof MAPAS / sizeof MAPAS[0]; ++i) testarMapa(MAPAS[i]);
+    verificarSemVazamentos();
+    printf("teste_acusacao: ok\n");
+    return 0;
+}
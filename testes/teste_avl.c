@@ -0,0 +1,147 @@
+// Teste da AVL de pistas e do cursor iterativo contra uma solucao por forca bruta (vetor ordenado
+// sem repeticoes): insercao em ordem crescente, decrescente e embaralhada, com duplicatas, nos
+// tres alocadores de nos; confere o balanceamento, o percurso em ordem e faixas do cursor
+
+#include "teste.h"
+
+#define PISTAS_TESTE 3000
+#define FAIXAS_TESTE 200
+
+static uint64_t estadoAvl = 0x9e3779b97f4a7c15ull;
+
+static uint64_t proximoAvl(void) {
+    estadoAvl ^= estadoAvl << 13;
+    estadoAvl ^= estadoAvl >> 7;
+    estadoAvl ^= estadoAvl << 17;
+    return estadoAvl;
+}
+
+// texto curto num alfabeto pequeno: muitas repeticoes e prefixos em comum
+static void sortearPista(char *buf) {
+    size_t n = 1 + proximoAvl() % 6;
+    for (size_t i = 0; i < n; ++i) buf[i] = "abcd_"[proximoAvl() % 5];
+    buf[n] = '\0';
+}
+
+static int compararTexto(const void *a, const void *b) {
+    return strcmp(*(const char* const*) a, *(const char* const*) b);
+}
+
+// confere ordem, alturas e fatores de balanceamento; devolve a altura e conta os nos
+static int conferirNo(const ArvorePistas *arv, const PistaNode *n, const char *min, const char *max, size_t *nos) {
+    if (n == NULL) return 0;
+    const char *t = textoInterno(arv->textos, n->pista);
+    VERIFICAR(min == NULL || strcmp(min, t) < 0, "\"%s\" fora de ordem (depois de \"%s\")", t, min);
+    VERIFICAR(max == NULL || strcmp(t, max) < 0, "\"%s\" fora de ordem (antes de \"%s\")", t, max);
+    int he = conferirNo(arv, n->esquerda, min, t, nos);
+    int hd = conferirNo(arv, n->direita, t, max, nos);
+    int h = 1 + (he > hd ? he : hd);
+    VERIFICAR(n->altura == h, "altura de \"%s\": %d, esperado %d", t, n->altura, h);
+    VERIFICAR(he - hd <= 1 && hd - he <= 1, "\"%s\" desbalanceado (%d x %d)", t, he, hd);
+    (*nos)++;
+    return h;
+}
+
+// compara a colecao com 'ref' (n textos ordenados, sem repeticoes): estrutura, percurso e faixas
+static void conferirColecao(const ArvorePistas *arv, const char **ref, size_t n) {
+    size_t nos = 0;
+    conferirNo(arv, arv->raiz, NULL, NULL, &nos);
+    VERIFICAR(nos == n && arv->total == n, "%zu nos (total %zu), esperado %zu", nos, arv->total, n);
+
+    CursorPistas c;
+    abrirCursor(&c, arv, NULL, NULL);
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t id = proximaPista(&c);
+        VERIFICAR(id != TEXTO_VAZIO, "percurso terminou em %zu de %zu", i, n);
+        VERIFICAR(strcmp(textoInterno(arv->textos, id), ref[i]) == 0, "percurso: posicao %zu", i);
+    }
+    VERIFICAR(proximaPista(&c) == TEXTO_VAZIO, "percurso com pistas demais");
+
+    // faixas [de, ate] com limites que existem ou nao na colecao
+    for (int f = 0; f < FAIXAS_TESTE; ++f) {
+        char de[8], ate[8];
+        sortearPista(de);
+        sortearPista(ate);
+        if (strcmp(de, ate) > 0) { char t[8]; strcpy(t, de); strcpy(de, ate); strcpy(ate, t); }
+        abrirCursor(&c, arv, de, ate);
+        for (size_t i = 0; i < n; ++i) {
+            if (strcmp(ref[i], de) < 0 || strcmp(ref[i], ate) > 0) continue;
+            uint32_t id = proximaPista(&c);
+            VERIFICAR(id != TEXTO_VAZIO && strcmp(textoInterno(arv->textos, id), ref[i]) == 0,
+                      "faixa [%s, %s]: faltou \"%s\"", de, ate, ref[i]);
+        }
+        VERIFICAR(proximaPista(&c) == TEXTO_VAZIO, "faixa [%s, %s] com pistas demais", de, ate);
+    }
+}
+
+// =========================
+// INSERCAO UMA A UMA E CONSTRUCAO DE UMA VEZ
+// =========================
+
+typedef enum OrdemInsercao { ORDEM_CRESCENTE, ORDEM_DECRESCENTE, ORDEM_EMBARALHADA, NUM_ORDENS } OrdemInsercao;
+
+static const char *NOMES_ORDEM[NUM_ORDENS] = { "crescente", "decrescente", "embaralhada" };
+
+static void testarColecao(ModoAlocador modo, OrdemInsercao ordem) {
+    InternPool textos;
+    inicializarInternos(&textos);
+    const char **ref = (const char**) memAlocar(MEM_GERAL, PISTAS_TESTE * sizeof(char*));
+    uint32_t *ids = (uint32_t*) memAlocar(MEM_GERAL, PISTAS_TESTE * sizeof(uint32_t));
+    unsigned char *vista = (unsigned char*) memZerada(MEM_GERAL, PISTAS_TESTE + 1, 1);
+    VERIFICAR(ref != NULL && ids != NULL && vista != NULL, "memoria insuficiente");
+
+    // sorteio com repeticoes; a referencia e o vetor ordenado sem elas
+    for (size_t i = 0; i < PISTAS_TESTE; ++i) {
+        char buf[8];
+        sortearPista(buf);
+        ids[i] = internar(&textos, buf, MAXPISTA);
+        ref[i] = textoInterno(&textos, ids[i]);
+    }
+    qsort(ref, PISTAS_TESTE, sizeof(char*), compararTexto);
+    size_t n = 0;
+    for (size_t i = 0; i < PISTAS_TESTE; ++i)
+        if (n == 0 || strcmp(ref[n - 1], ref[i]) != 0) ref[n++] = ref[i];
+    if (ordem != ORDEM_EMBARALHADA) {
+        // a sequencia de insercao e a propria referencia (cada pista duas vezes seguidas)
+        for (size_t i = 0; i < PISTAS_TESTE; ++i) {
+            size_t k = (i / 2) % n;
+            ids[i] = internar(&textos, ref[ordem == ORDEM_CRESCENTE ? k : n - 1 - k], MAXPISTA);
+        }
+    }
+
+    modoAlocadorPistas = modo;
+    ArvorePistas arv;
+    inicializarPistas(&arv, &textos);
+    for (size_t i = 0; i < PISTAS_TESTE; ++i) {
+        int esperado = ids[i] != TEXTO_VAZIO && !vista[ids[i]];
+        vista[ids[i]] = 1;
+        VERIFICAR(inserirPistaId(&arv, ids[i]) == esperado, "%s/%s: insercao %zu devolveu o contrario",
+                  nomesModosAlocador[modo], NOMES_ORDEM[ordem], i);
+    }
+    VERIFICAR(inserirPista(&arv, "") == 0, "pista vazia inserida");
+    conferirColecao(&arv, ref, n);
+
+    // a mesma colecao montada de uma vez, reaproveitando os nos, com 1 e 4 threads
+    for (int threads = 1; threads <= 4; threads += 3) {
+        limparPistas(&arv);
+        VERIFICAR(arv.raiz == NULL && arv.total == 0, "colecao limpa nao esta vazia");
+        VERIFICAR(construirPistas(&arv, ids, PISTAS_TESTE, threads) == n, "construirPistas: total errado");
+        conferirColecao(&arv, ref, n);
+    }
+
+    liberarPistas(&arv);
+    liberarInternos(&textos);
+    memLiberar(ref);
+    memLiberar(ids);
+    memLiberar(vista);
+}
+
+int main(void) {
+    inicializarSementeHash();
+    for (int modo = 0; modo < NUM_MODOS_ALOCADOR; ++modo)
+        for (int ordem = 0; ordem < NUM_ORDENS; ++ordem)
+            testarColecao((ModoAlocador) modo, (OrdemInsercao) ordem);
+    verificarSemVazamentos();
+    printf("teste_avl: ok\n");
+    return 0;
+}
@@ -0,0 +1,75 @@
+// Teste da carga em lote da hash: carregarHashEmLote (usada por popularHash) deve dar a mesma
+// tabela que inserirNaHashId chamada associacao por associacao, na ordem do mapa – mesmos
+// suspeitos na mesma numeracao, mesmo suspeito por pista e os mesmos pesos nas duas direcoes
+
+#include "teste.h"
+
+static const char *MAPAS[] = { "mansoes/padrao.txt", "mansoes/casarao.txt" };
+
+static void compararListas(const char *mapa, const char *direcao, uint32_t chave,
+                           const Postagem *a, uint32_t na, const Postagem *b, uint32_t nb) {
+    VERIFICAR(na == nb, "%s: %s %u com %u postagens em lote e %u por item", mapa, direcao, chave, na, nb);
+    for (uint32_t k = 0; k < na; ++k)
+        VERIFICAR(a[k].id == b[k].id && a[k].peso == b[k].peso,
+                  "%s: %s %u, postagem %u: (%u, peso %u) em lote e (%u, peso %u) por item",
+                  mapa, direcao, chave, k, a[k].id, a[k].peso, b[k].id, b[k].peso);
+}
+
+static void compararCargas(const char *mapa) {
+    Mansao m;
+    VERIFICAR(carregarMansao(mapa, &m), "nao abriu %s", mapa);
+    VERIFICAR(m.numAssociacoes > 0, "%s sem associacoes", mapa);
+
+    HashTable lote, item;
+    inicializarHash(&lote, &m.textos);
+    carregarHashEmLote(&lote, m.associacoes, m.numAssociacoes);
+    inicializarHash(&item, &m.textos);
+    for (uint32_t i = 0; i < m.numAssociacoes; ++i) {
+        const Associacao *a = &m.associacoes[i];
+        inserirNaHashId(&item, a->pista, a->suspeito, a->chave, a->peso);
+    }
+
+    VERIFICAR(lote.quantidade == item.quantidade, "%s: %zu pistas em lote e %zu por item",
+              mapa, lote.quantidade, item.quantidade);
+    VERIFICAR(lote.numAssociacoes == item.numAssociacoes, "%s: %zu associacoes em lote e %zu por item",
+              mapa, lote.numAssociacoes, item.numAssociacoes);
+    VERIFICAR(lote.numSuspeitos == item.numSuspeitos, "%s: %u suspeitos em lote e %u por item",
+              mapa, lote.numSuspeitos, item.numSuspeitos);
+
+    // os indices densos saem da ordem da primeira aparicao: devem coincidir um a um
+    for (uint32_t s = 0; s < lote.numSuspeitos; ++s) {
+        VERIFICAR(lote.chaveSuspeito[s] == item.chaveSuspeito[s] && lote.nomeSuspeito[s] == item.nomeSuspeito[s],
+                  "%s: suspeito %u e %s em lote e %s por item", mapa, s,
+                  textoInterno(&m.textos, lote.nomeSuspeito[s]), textoInterno(&m.textos, item.nomeSuspeito[s]));
+        compararListas(mapa, "suspeito", s, pistasDoSuspeito(&lote, s), lote.pistasSuspeito[s].quantidade,
+                       pistasDoSuspeito(&item, s), item.pistasSuspeito[s].quantidade);
+    }
+
+    for (uint32_t i = 0; i < m.numAssociacoes; ++i) {
+        uint32_t pista = m.associacoes[i].pista;
+        const char *texto = textoInterno(&m.textos, pista);
+        const char *sl = encontrarSuspeito(&lote, texto), *si = encontrarSuspeito(&item, texto);
+        VERIFICAR(sl != NULL && si != NULL && strcmp(sl, si) == 0, "%s: pista \"%s\" aponta %s em lote e %s por item",
+                  mapa, texto, sl ? sl : "(nada)", si ? si : "(nada)");
+        const HashEntrada *el = encontrarEntrada(&lote, pista), *ei = encontrarEntrada(&item, pista);
+        VERIFICAR(el != NULL && ei != NULL, "%s: pista \"%s\" sumiu", mapa, texto);
+        compararListas(mapa, "pista", pista, suspeitosDaPista(&lote, el), el->suspeitos.quantidade,
+                       suspeitosDaPista(&item, ei), ei->suspeitos.quantidade);
+        for (uint32_t s = 0; s < lote.numSuspeitos; ++s)
+            VERIFICAR(pesoContra(&lote, el, s) == pesoContra(&item, ei, s), "%s: pista \"%s\" pesa %u contra %s em lote e %u por item",
+                      mapa, texto, pesoContra(&lote, el, s), textoInterno(&m.textos, lote.nomeSuspeito[s]),
+                      pesoContra(&item, ei, s));
+    }
+
+    liberarHash(&lote);
+    liberarHash(&item);
+    liberarMansao(&m);
+}
+
+int main(void) {
+    inicializarSementeHash();
+    for (size_t i = 0; i < sizeof MAPAS / sizeof MAPAS[0]; ++i) compararCargas(MAPAS[i]);
+    verificarSemVazamentos();
+    printf("teste_carga_lote: ok\n");
+    return 0;
+}
@@ -0,0 +1,150 @@
+// Teste do diario de sessoes: uma sessao restaurada de snapshots e deltas tem a mesma sala,
+// pistas, pontos e trilha de volta ('v') que a original, inclusive depois que o anel da trilha
+// da a volta (TRILHA_MAX) e com 'v' desfazendo parte da trilha entre um registro e outro
+
+#include "teste.h"
+
+#define MOVIMENTOS_ALEATORIOS (3 * TRILHA_MAX)
+#define CONFERENCIAS 6
+
+static uint64_t estadoPasseio = 0x2545f4914f6cdd1dull;
+
+static uint64_t proximoPasseio(void) {
+    estadoPasseio ^= estadoPasseio << 13;
+    estadoPasseio ^= estadoPasseio >> 7;
+    estadoPasseio ^= estadoPasseio << 17;
+    return estadoPasseio;
+}
+
+static void mover(Sessao *se, const Mansao *m, const HashTable *ht, char escolha) {
+    if (moverSessao(se, m, escolha) == MOV_OK) coletarPistaSala(se, m, ht);
+}
+
+// abre o diario gravado numa sessao nova e compara com a original
+static void conferirRestauracao(const char *caminho, const Mansao *m, const HashTable *ht,
+                                const Sessao *orig) {
+    Sessao se;
+    DiarioSessoes d;
+    size_t restauradas;
+    iniciarSessao(&se, m, ht, orig->ev.limiar);
+    VERIFICAR(abrirDiario(&d, caminho, m, ht, &se, 1, &restauradas) && restauradas == 1, "diario nao restaurou");
+    VERIFICAR(se.salaAtual == orig->salaAtual && se.movimentos == orig->movimentos, "sala ou movimentos diferentes");
+    VERIFICAR(se.pistas.total == orig->pistas.total, "pistas: %zu, esperado %zu", se.pistas.total, orig->pistas.total);
+    for (uint32_t i = 0; i < se.ev.numSuspeitos; ++i)
+        VERIFICAR(se.ev.pontos[i] == orig->ev.pontos[i], "pontos do suspeito %u diferentes", i);
+    VERIFICAR(se.profTrilha == orig->profTrilha, "trilha com %u salas, esperado %u", se.profTrilha, orig->profTrilha);
+    for (uint32_t i = 0; i < se.profTrilha; ++i) {
+        int32_t a = se.trilha[(se.inicioTrilha + i) & (se.capTrilha - 1)];
+        int32_t b = orig->trilha[(orig->inicioTrilha + i) & (orig->capTrilha - 1)];
+        VERIFICAR(a == b, "sala %u da trilha: %d, esperado %d", i, a, b);
+    }
+    fecharDiario(&d);
+    liberarSessao(&se);
+}
+
+static void novoDiario(char *caminho) {
+    strcpy(caminho, "/tmp/teste_diarioXXXXXX");
+    int fd = mkstemp(caminho);
+    VERIFICAR(fd >= 0, "mkstemp");
+    close(fd);
+}
+
+// =========================
+// VOLTAR DEPOIS DE RESTAURAR
+// =========================
+
+// a investigacao salva na Biblioteca (folha da mansao padrao) volta pela trilha depois de retomada
+static void testarVoltaRestaurada(const Mansao *m, const HashTable *ht) {
+    char caminho[64];
+    novoDiario(caminho);
+    Sessao se;
+    DiarioSessoes d;
+    size_t restauradas;
+    iniciarSessao(&se, m, ht, 0);
+    VERIFICAR(abrirDiario(&d, caminho, m, ht, &se, 1, &restauradas), "diario novo nao abriu");
+    coletarPistaSala(&se, m, ht);
+    registrarSessao(&d, 0, &se);
+    mover(&se, m, ht, 'e');
+    registrarSessao(&d, 0, &se);
+    mover(&se, m, ht, 'e');
+    registrarSessao(&d, 0, &se);
+    VERIFICAR(strcmp(nomeSala(m, se.salaAtual), "Biblioteca") == 0, "roteiro 'ee' nao chegou a Biblioteca");
+    VERIFICAR(gravarDiario(&d), "falha ao gravar o diario");
+    fecharDiario(&d);
+    liberarSessao(&se);
+
+    iniciarSessao(&se, m, ht, 0);
+    VERIFICAR(abrirDiario(&d, caminho, m, ht, &se, 1, &restauradas) && restauradas == 1, "diario nao restaurou");
+    VERIFICAR(strcmp(nomeSala(m, se.salaAtual), "Biblioteca") == 0, "restaurou fora da Biblioteca");
+    VERIFICAR(moverSessao(&se, m, 'v') == MOV_OK, "'v' recusado depois de restaurar");
+    VERIFICAR(strcmp(nomeSala(m, se.salaAtual), "Sala de Estar") == 0, "'v' foi para %s", nomeSala(m, se.salaAtual));
+    VERIFICAR(moverSessao(&se, m, 'v') == MOV_OK && se.salaAtual == m->raiz, "segundo 'v' nao voltou ao inicio");
+    VERIFICAR(moverSessao(&se, m, 'v') == MOV_INVALIDO, "'v' aceito com a trilha vazia");
+    fecharDiario(&d);
+    liberarSessao(&se);
+    remove(caminho);
+}
+
+// =========================
+// PASSEIO ALEATORIO COM O ANEL CHEIO
+// =========================
+
+// passeio no casarao (com ciclos): saidas e 'v' ao acaso, registros em intervalos irregulares,
+// compactacoes ocasionais e conferencias da restauracao ao longo do caminho
+static void testarPasseio(const Mansao *m, const HashTable *ht) {
+    char caminho[64];
+    novoDiario(caminho);
+    Sessao se;
+    DiarioSessoes d;
+    size_t restauradas;
+    iniciarSessao(&se, m, ht, 0);
+    VERIFICAR(abrirDiario(&d, caminho, m, ht, &se, 1, &restauradas), "diario novo nao abriu");
+    coletarPistaSala(&se, m, ht);
+    registrarSessao(&d, 0, &se);
+    int deuAVolta = 0;
+    for (uint32_t k = 1; k <= MOVIMENTOS_ALEATORIOS; ++k) {
+        uint64_t r = proximoPasseio();
+        // mais saidas que voltas, para a trilha crescer ate encher o anel; as vezes uma sequencia de 'v'
+        if (r % 256 == 0) {
+            for (uint32_t v = (uint32_t) (r >> 8) % 64; v > 0; --v) mover(&se, m, ht, 'v');
+        } else if (r % 8 == 0) {
+            mover(&se, m, ht, 'v');
+        } else {
+            uint32_t n = numSaidasSala(m, se.salaAtual);
+            if (n > 0) mover(&se, m, ht, (char) ('1' + (r >> 8) % n));
+        }
+        deuAVolta |= se.profTrilha == TRILHA_MAX;
+        if (r % 97 == 0) registrarSessao(&d, 0, &se);
+        if (r % 20011 == 0) VERIFICAR(compactarDiario(&d, &se, 1), "falha ao compactar");
+        if (k % (MOVIMENTOS_ALEATORIOS / CONFERENCIAS) == 0) {
+            registrarSessao(&d, 0, &se);
+            VERIFICAR(gravarDiario(&d), "falha ao gravar o diario");
+            conferirRestauracao(caminho, m, ht, &se);
+        }
+    }
+    VERIFICAR(deuAVolta, "a trilha nunca encheu o anel");
+    fecharDiario(&d);
+    liberarSessao(&se);
+    remove(caminho);
+}
+
+int main(void) {
+    inicializarSementeHash();
+    const char *mapas[] = { "mansoes/padrao.txt", "mansoes/casarao.txt" };
+    Mansao m[2];
+    HashTable ht[2];
+    for (int i = 0; i < 2; ++i) {
+        VERIFICAR(carregarMansao(mapas[i], &m[i]), "nao abriu %s", mapas[i]);
+        inicializarHash(&ht[i], &m[i].textos);
+        popularHash(&ht[i], &m[i]);
+    }
+    testarVoltaRestaurada(&m[0], &ht[0]);
+    testarPasseio(&m[1], &ht[1]);
+    for (int i = 0; i < 2; ++i) {
+        liberarHash(&ht[i]);
+        liberarMansao(&m[i]);
+    }
+    verificarSemVazamentos();
+    printf("teste_diario: ok\n");
+    return 0;
+}
@@ -0,0 +1,177 @@
+// Teste da publicacao por epocas (VERSOES DO CASO): uma versao retirada so e liberada depois que
+// nenhum leitor dentro de entrarLeitura/sairLeitura e nenhuma sessao que a prendeu a usam mais.
+// Roda com ASan (make test): um acesso a versao liberada cedo demais derruba o teste, e a
+// contabilidade de memoria (-DINSTRUMENTAR) confere que tudo foi liberado no fim
+
+#include "teste.h"
+
+#define LEITORES_ESTRESSE 3
+#define LEITURAS_ESTRESSE 20000
+#define PUBLICACOES_ESTRESSE 200
+
+// versao nova com a mansao padrao (cada versao e dona da sua mansao e da sua hash)
+static VersaoCaso* novaVersao(void) {
+    Mansao m;
+    HashTable ht;
+    montarMansaoPadrao(&m);
+    inicializarHash(&ht, &m.textos);
+    popularHash(&ht, &m);
+    return montarVersaoCaso(&m, &ht, 0);
+}
+
+// le a versao inteira; com ASan, falha se ela ja tiver sido liberada
+static size_t lerVersao(const VersaoCaso *v) {
+    size_t soma = v->numero;
+    for (uint32_t i = 0; i < v->mansao.numSalas; ++i)
+        soma += strlen(nomeSala(&v->mansao, (int32_t) i)) + strlen(pistaSala(&v->mansao, (int32_t) i));
+    return soma;
+}
+
+static size_t objetosServidor(void) {
+    return atomic_load(&contadoresMemoria[MEM_SERVIDOR].objetos);
+}
+
+// =========================
+// LEITOR DENTRO DA LEITURA DURANTE A PUBLICACAO
+// =========================
+
+typedef struct LeitorPasso {
+    PublicadorCasos *pub;
+    _Atomic int fase;   // 1: dentro da leitura; 2: nova versao publicada; 3: saiu da leitura
+    uint64_t numeroLido;
+} LeitorPasso;
+
+static void* lerDuranteAPublicacao(void *arg) {
+    LeitorPasso *lp = (LeitorPasso*) arg;
+    int leitor = registrarLeitor(lp->pub);
+    VERIFICAR(leitor >= 0, "sem vaga de leitor");
+    VersaoCaso *v = entrarLeitura(lp->pub, leitor);
+    lp->numeroLido = v->numero;
+    atomic_store(&lp->fase, 1);
+    while (atomic_load(&lp->fase) != 2) sched_yield();
+    VERIFICAR(lerVersao(v) > 0, "versao vazia");
+    sairLeitura(lp->pub, leitor);
+    atomic_store(&lp->fase, 3);
+    return NULL;
+}
+
+static void testarLeitorDentro(void) {
+    PublicadorCasos pub;
+    iniciarPublicador(&pub, novaVersao());
+    LeitorPasso lp = { .pub = &pub };
+    atomic_init(&lp.fase, 0);
+    pthread_t t;
+    VERIFICAR(pthread_create(&t, NULL, lerDuranteAPublicacao, &lp) == 0, "pthread_create");
+    while (atomic_load(&lp.fase) != 1) sched_yield();
+
+    size_t antes = objetosServidor();
+    publicarVersao(&pub, novaVersao());
+    VERIFICAR(recolherVersoes(&pub) == 1, "versao 1 liberada com um leitor dentro da leitura");
+    VERIFICAR(objetosServidor() > antes, "a versao retirada sumiu da contabilidade");
+    atomic_store(&lp.fase, 2);
+    while (atomic_load(&lp.fase) != 3) sched_yield();
+    pthread_join(t, NULL);
+
+    VERIFICAR(lp.numeroLido == 1, "leitor leu a versao %llu", (unsigned long long) lp.numeroLido);
+    VERIFICAR(recolherVersoes(&pub) == 0, "versao 1 nao foi liberada depois de sairLeitura");
+    VERIFICAR(atomic_load(&pub.atual)->numero == 2, "versao atual errada");
+    encerrarPublicador(&pub);
+}
+
+// =========================
+// SESSAO COM A VERSAO PRESA
+// =========================
+
+static void testarSessaoPresa(void) {
+    PublicadorCasos pub;
+    iniciarPublicador(&pub, novaVersao());
+    int leitor = registrarLeitor(&pub);
+    VERIFICAR(leitor >= 0, "sem vaga de leitor");
+
+    // a sessao prende a versao e sai da leitura, como o servidor faz entre lotes de eventos
+    VersaoCaso *v = entrarLeitura(&pub, leitor);
+    prenderVersao(v);
+    sairLeitura(&pub, leitor);
+
+    publicarVersao(&pub, novaVersao());
+    publicarVersao(&pub, novaVersao());
+    // a versao 2 nao foi presa: sai logo; a 1 espera a sessao
+    VERIFICAR(recolherVersoes(&pub) == 1, "versao presa liberada (ou outra retida)");
+    VERIFICAR(v->numero == 1 && lerVersao(v) > 0, "versao presa corrompida");
+
+    soltarVersao(v);
+    VERIFICAR(recolherVersoes(&pub) == 0, "versao solta nao foi liberada");
+    encerrarPublicador(&pub);
+}
+
+// =========================
+// LEITORES E PUBLICACOES CONCORRENTES
+// =========================
+
+typedef struct LeitorEstresse {
+    PublicadorCasos *pub;
+    _Atomic int *terminou;
+    size_t soma;
+} LeitorEstresse;
+
+// alterna leituras curtas com sessoes que prendem a versao por algumas leituras seguintes
+static void* lerSemParar(void *arg) {
+    LeitorEstresse *le = (LeitorEstresse*) arg;
+    int leitor = registrarLeitor(le->pub);
+    VERIFICAR(leitor >= 0, "sem vaga de leitor");
+    VersaoCaso *presa = NULL;
+    uint64_t ultimo = 0;
+    for (size_t k = 0; k < LEITURAS_ESTRESSE; ++k) {
+        VersaoCaso *v = entrarLeitura(le->pub, leitor);
+        VERIFICAR(v->numero >= ultimo, "versao voltou no tempo: %llu depois de %llu",
+                  (unsigned long long) v->numero, (unsigned long long) ultimo);
+        ultimo = v->numero;
+        le->soma += lerVersao(v);
+        if (presa == NULL && k % 7 == 0) {
+            presa = v;
+            prenderVersao(presa);
+        }
+        sairLeitura(le->pub, leitor);
+        if (presa != NULL) {
+            le->soma += lerVersao(presa);
+            if (k % 7 == 5) {
+                soltarVersao(presa);
+                presa = NULL;
+            }
+        }
+    }
+    if (presa != NULL) soltarVersao(presa);
+    atomic_fetch_add(le->terminou, 1);
+    return NULL;
+}
+
+static void testarConcorrencia(void) {
+    PublicadorCasos pub;
+    iniciarPublicador(&pub, novaVersao());
+    _Atomic int terminou;
+    atomic_init(&terminou, 0);
+    LeitorEstresse le[LEITORES_ESTRESSE];
+    pthread_t t[LEITORES_ESTRESSE];
+    for (int i = 0; i < LEITORES_ESTRESSE; ++i) {
+        le[i] = (LeitorEstresse) { .pub = &pub, .terminou = &terminou };
+        VERIFICAR(pthread_create(&t[i], NULL, lerSemParar, &le[i]) == 0, "pthread_create");
+    }
+    for (int p = 0; p < PUBLICACOES_ESTRESSE && atomic_load(&terminou) < LEITORES_ESTRESSE; ++p) {
+        publicarVersao(&pub, novaVersao());
+        sched_yield();
+    }
+    for (int i = 0; i < LEITORES_ESTRESSE; ++i) pthread_join(t[i], NULL);
+    VERIFICAR(recolherVersoes(&pub) == 0, "versoes retidas sem leitores nem sessoes");
+    encerrarPublicador(&pub);
+}
+
+int main(void) {
+    inicializarSementeHash();
+    testarLeitorDentro();
+    testarSessaoPresa();
+    testarConcorrencia();
+    VERIFICAR(objetosServidor() == 0, "versoes do caso ainda vivas no fim");
+    verificarSemVazamentos();
+    printf("teste_epocas: ok\n");
+    return 0;
+}
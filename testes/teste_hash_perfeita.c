@@ -0,0 +1,104 @@
+// Teste da hash perfeita (construirHashPerfeita/abrirHashPerfeita) nas duas mansoes de exemplo:
+// cada pista e cada suspeito ficam numa posicao so deles, achada sem sondagem, e as listas de
+// postagens compactadas nos vetores novos sao as mesmas da hash comum de onde sairam
+
+#include "teste.h"
+
+static const char *MAPAS[] = { "mansoes/padrao.txt", "mansoes/casarao.txt" };
+
+static void compararListas(const char *mapa, const char *direcao, uint32_t chave,
+                           const Postagem *a, uint32_t na, const Postagem *b, uint32_t nb) {
+    VERIFICAR(na == nb, "%s: %s %u com %u postagens na hash comum e %u na perfeita", mapa, direcao, chave, na, nb);
+    for (uint32_t k = 0; k < na; ++k)
+        VERIFICAR(a[k].id == b[k].id && a[k].peso == b[k].peso,
+                  "%s: %s %u, postagem %u: (%u, peso %u) na hash comum e (%u, peso %u) na perfeita",
+                  mapa, direcao, chave, k, a[k].id, a[k].peso, b[k].id, b[k].peso);
+}
+
+static void testarMapa(const char *mapa) {
+    Mansao m;
+    VERIFICAR(carregarMansao(mapa, &m), "nao abriu %s", mapa);
+    HashTable ht, perfeita;
+    inicializarHash(&ht, &m.textos);
+    popularHash(&ht, &m);
+    HashPerfeita hp;
+    construirHashPerfeita(&ht, &hp);
+    abrirHashPerfeita(&perfeita, &hp, &m.textos);
+    VERIFICAR(perfeita.deslocPistas != NULL, "%s: a hash aberta nao usa a tabela perfeita", mapa);
+    VERIFICAR(hp.quantidade == ht.quantidade && hp.numSuspeitos == ht.numSuspeitos,
+              "%s: %u pistas e %u suspeitos na perfeita, %zu e %u na comum",
+              mapa, hp.quantidade, hp.numSuspeitos, ht.quantidade, ht.numSuspeitos);
+    // listas compactadas: sem lixo nem folga entre elas
+    VERIFICAR(hp.numPostagensPistas == ht.numAssociacoes && hp.numPostagensSuspeitos == ht.numAssociacoes,
+              "%s: %u/%u postagens na perfeita para %zu associacoes",
+              mapa, hp.numPostagensPistas, hp.numPostagensSuspeitos, ht.numAssociacoes);
+
+    // pistas: cada uma na sua posicao, e nenhuma outra posicao ocupada
+    unsigned char *ocupada = (unsigned char*) memZerada(MEM_HASH, hp.capacidade, 1);
+    VERIFICAR(ocupada != NULL, "memoria insuficiente");
+    for (size_t i = 0; i < ht.capacidade; ++i) {
+        const HashEntrada *e = &ht.entradas[i];
+        if (e->pista == TEXTO_VAZIO) continue;
+        const char *texto = textoInterno(&m.textos, e->pista);
+        const HashEntrada *d = encontrarEntrada(&perfeita, e->pista);
+        VERIFICAR(d != NULL && d->pista == e->pista, "%s: pista \"%s\" nao achada na perfeita", mapa, texto);
+        size_t pos = (size_t) (d - hp.entradas);
+        VERIFICAR(!ocupada[pos], "%s: pista \"%s\" divide a posicao %zu", mapa, texto, pos);
+        ocupada[pos] = 1;
+        compararListas(mapa, "pista", e->pista, suspeitosDaPista(&ht, e), e->suspeitos.quantidade,
+                       suspeitosDaPista(&perfeita, d), d->suspeitos.quantidade);
+        for (uint32_t s = 0; s < ht.numSuspeitos; ++s)
+            VERIFICAR(pesoContra(&ht, e, s) == pesoContra(&perfeita, d, s), "%s: pista \"%s\" pesa %u contra %u na comum e %u na perfeita",
+                      mapa, texto, pesoContra(&ht, e, s), s, pesoContra(&perfeita, d, s));
+        const char *sc = encontrarSuspeito(&ht, texto), *sp = encontrarSuspeito(&perfeita, texto);
+        VERIFICAR(sc != NULL && sp != NULL && strcmp(sc, sp) == 0, "%s: pista \"%s\" aponta %s na comum e %s na perfeita",
+                  mapa, texto, sc ? sc : "(nada)", sp ? sp : "(nada)");
+    }
+    size_t ocupadas = 0;
+    for (uint32_t k = 0; k < hp.capacidade; ++k) {
+        VERIFICAR((hp.entradas[k].pista != TEXTO_VAZIO) == ocupada[k], "%s: posicao %u ocupada sem pista", mapa, k);
+        ocupadas += ocupada[k];
+    }
+    VERIFICAR(ocupadas == hp.quantidade, "%s: %zu posicoes ocupadas para %u pistas", mapa, ocupadas, hp.quantidade);
+    memLiberar(ocupada);
+
+    // textos que nao sao pista (nomes de sala) caem numa posicao vazia ou de outra pista
+    for (uint32_t i = 0; i < m.numSalas; ++i) {
+        uint32_t id = internar(&m.textos, nomeSala(&m, (int32_t) i), MAXNOME);
+        VERIFICAR((encontrarEntrada(&perfeita, id) != NULL) == (encontrarEntrada(&ht, id) != NULL),
+                  "%s: \"%s\" achado so numa das hashes", mapa, nomeSala(&m, (int32_t) i));
+    }
+
+    // suspeitos: indice denso pela chave, uma posicao por suspeito
+    uint32_t *vezes = (uint32_t*) memZerada(MEM_HASH, hp.numSuspeitos + 1, sizeof(uint32_t));
+    VERIFICAR(vezes != NULL, "memoria insuficiente");
+    for (uint32_t k = 0; k < hp.capIndiceSuspeitos; ++k) {
+        const IndiceSuspeito *is = &hp.indiceSuspeitos[k];
+        if (is->idxMais1 == 0) continue;
+        VERIFICAR(is->idxMais1 <= hp.numSuspeitos && is->chave == ht.chaveSuspeito[is->idxMais1 - 1],
+                  "%s: posicao %u do indice de suspeitos com chave errada", mapa, k);
+        vezes[is->idxMais1 - 1]++;
+    }
+    for (uint32_t s = 0; s < ht.numSuspeitos; ++s) {
+        const char *nome = textoInterno(&m.textos, ht.nomeSuspeito[s]);
+        VERIFICAR(vezes[s] == 1, "%s: suspeito %s em %u posicoes", mapa, nome, vezes[s]);
+        VERIFICAR(suspeitoPorNome(&perfeita, nome) == s, "%s: suspeito %s nao achado na perfeita", mapa, nome);
+        VERIFICAR(perfeita.nomeSuspeito[s] == ht.nomeSuspeito[s], "%s: nome do suspeito %u trocado", mapa, s);
+        compararListas(mapa, "suspeito", s, pistasDoSuspeito(&ht, s), ht.pistasSuspeito[s].quantidade,
+                       pistasDoSuspeito(&perfeita, s), perfeita.pistasSuspeito[s].quantidade);
+    }
+    memLiberar(vezes);
+
+    liberarHash(&perfeita);
+    liberarHashPerfeita(&hp);
+    liberarHash(&ht);
+    liberarMansao(&m);
+}
+
+int main(void) {
+    inicializarSementeHash();
+    for (size_t i = 0; i < sizeof MAPAS / sizeof MAPAS[0]; ++i) testarMapa(MAPAS[i]);
+    verificarSemVazamentos();
+    printf("teste_hash_perfeita: ok\n");
+    return 0;
+}
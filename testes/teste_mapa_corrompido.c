@@ -0,0 +1,105 @@
+// Teste de imagens de mansao corrompidas: abrirImagem recusa associacoes com ids fora dos textos
+// (a carga em lote da hash indexa vetores com eles) e, com ASan (make test), nenhuma imagem aceita
+// depois de bytes trocados ao acaso derruba a carga da hash ou a visita das salas
+
+#include "teste.h"
+
+#define IMAGENS_CORROMPIDAS 2000
+
+static const char *MAPAS[] = { "mansoes/padrao.txt", "mansoes/casarao.txt" };
+
+// gerador deterministico (xorshift) para repetir sempre as mesmas corrupcoes
+static uint64_t estadoCorrupcao = 0x9e3779b97f4a7c15ull;
+
+static uint64_t proximoCorrupcao(void) {
+    estadoCorrupcao ^= estadoCorrupcao << 13;
+    estadoCorrupcao ^= estadoCorrupcao >> 7;
+    estadoCorrupcao ^= estadoCorrupcao << 17;
+    return estadoCorrupcao;
+}
+
+// abre a imagem e, se aceita, carrega a hash e percorre salas, saidas e suspeitos
+static int exercitarImagem(const unsigned char *img, size_t tam) {
+    Mansao m;
+    memset(&m, 0, sizeof m);
+    if (!abrirImagem(&m, img, tam)) return 0;
+    HashTable ht;
+    inicializarHash(&ht, &m.textos);
+    popularHash(&ht, &m);
+    for (uint32_t i = 0; i < m.numAssociacoes; ++i)
+        (void) encontrarSuspeito(&ht, textoInterno(&m.textos, m.associacoes[i].pista));
+    liberarHash(&ht);
+    liberarMansao(&m);
+    return 1;
+}
+
+static unsigned char* copiarImagem(const Mansao *m) {
+    unsigned char *img = (unsigned char*) memAlocar(MEM_MAPA, m->tamImagem);
+    VERIFICAR(img != NULL, "memoria insuficiente");
+    memcpy(img, m->imagem, m->tamImagem);
+    return img;
+}
+
+// =========================
+// IDS DE ASSOCIACAO FORA DOS TEXTOS
+// =========================
+
+static void testarIdsForaDosTextos(const Mansao *orig) {
+    const CabecalhoMansao *cab = (const CabecalhoMansao*) orig->imagem;
+    size_t inicioAssoc = sizeof(CabecalhoMansao) + cab->numSalas * sizeof(Sala)
+                       + ((size_t) cab->numSalas + 1) * sizeof(uint32_t) + cab->numSaidas * sizeof(int32_t);
+    VERIFICAR(cab->numAssociacoes > 0, "mapa sem associacoes");
+    unsigned char *img = copiarImagem(orig);
+    VERIFICAR(exercitarImagem(img, orig->tamImagem), "imagem intacta recusada");
+    uint32_t indices[] = { 0, cab->numAssociacoes / 2, cab->numAssociacoes - 1 };
+    for (size_t k = 0; k < sizeof indices / sizeof indices[0]; ++k) {
+        for (size_t campo = 0; campo < 3; ++campo) {
+            uint32_t *id = (uint32_t*) (img + inicioAssoc + indices[k] * sizeof(Associacao)) + campo;
+            uint32_t salvo = *id;
+            *id = cab->numTextos;
+            VERIFICAR(!exercitarImagem(img, orig->tamImagem), "associacao %u campo %zu fora dos textos aceita",
+                      indices[k], campo);
+            *id = UINT32_MAX;
+            VERIFICAR(!exercitarImagem(img, orig->tamImagem), "associacao %u campo %zu = UINT32_MAX aceita",
+                      indices[k], campo);
+            *id = salvo;
+        }
+    }
+    memLiberar(img);
+}
+
+// =========================
+// BYTES TROCADOS AO ACASO
+// =========================
+
+static size_t testarBytesTrocados(const Mansao *orig) {
+    size_t aceitas = 0;
+    unsigned char *img = copiarImagem(orig);
+    for (int n = 0; n < IMAGENS_CORROMPIDAS; ++n) {
+        memcpy(img, orig->imagem, orig->tamImagem);
+        int trocas = 1 + (int) (proximoCorrupcao() % 8);
+        for (int t = 0; t < trocas; ++t) {
+            size_t pos = (size_t) (proximoCorrupcao() % orig->tamImagem);
+            img[pos] ^= (unsigned char) (1 + proximoCorrupcao() % 255);
+        }
+        aceitas += (size_t) exercitarImagem(img, orig->tamImagem);
+    }
+    memLiberar(img);
+    return aceitas;
+}
+
+int main(void) {
+    inicializarSementeHash();
+    for (size_t i = 0; i < sizeof MAPAS / sizeof MAPAS[0]; ++i) {
+        Mansao m;
+        VERIFICAR(carregarMansao(MAPAS[i], &m), "nao abriu %s", MAPAS[i]);
+        VERIFICAR(m.imagem != NULL, "%s sem imagem em memoria", MAPAS[i]);
+        testarIdsForaDosTextos(&m);
+        size_t aceitas = testarBytesTrocados(&m);
+        VERIFICAR(aceitas < IMAGENS_CORROMPIDAS, "%s: nenhuma corrupcao recusada", MAPAS[i]);
+        liberarMansao(&m);
+    }
+    verificarSemVazamentos();
+    printf("teste_mapa_corrompido: ok\n");
+    return 0;
+}
@@ -0,0 +1,117 @@
+// Teste das listas de postagens da hash (pista -> [suspeito, peso] e suspeito -> [pista, peso])
+// contra um modelo por forca bruta: insercoes ao acaso com pares repetidos e pesos trocados
+// fazem as listas crescerem e deixarem lixo; depois de cada recolhimento do lixo (e no fim) as
+// listas compactadas devem ser as mesmas de antes, na ordem de cadastro e com o ultimo peso
+
+#include "teste.h"
+
+#define PISTAS_TESTE 300
+#define SUSPEITOS_TESTE 60
+#define INSERCOES_TESTE 20000
+
+static uint64_t estadoPostagens = 0x9e3779b97f4a7c15ull;
+
+static uint64_t proximoPostagens(void) {
+    estadoPostagens ^= estadoPostagens << 13;
+    estadoPostagens ^= estadoPostagens >> 7;
+    estadoPostagens ^= estadoPostagens << 17;
+    return estadoPostagens;
+}
+
+// modelo: listas nas duas direcoes, na ordem da primeira insercao de cada par
+typedef struct Modelo {
+    uint32_t idPista[PISTAS_TESTE], idSuspeito[SUSPEITOS_TESTE];
+    uint32_t indice[SUSPEITOS_TESTE];    // indice denso do suspeito, ou UINT32_MAX
+    uint32_t numSuspeitos;
+    Postagem porPista[PISTAS_TESTE][SUSPEITOS_TESTE];
+    uint32_t qtdPista[PISTAS_TESTE];
+    Postagem porSuspeito[SUSPEITOS_TESTE][PISTAS_TESTE];
+    uint32_t qtdSuspeito[SUSPEITOS_TESTE];
+} Modelo;
+
+static void inserirNoModelo(Modelo *md, uint32_t p, uint32_t s, uint32_t peso) {
+    if (md->indice[s] == UINT32_MAX) md->indice[s] = md->numSuspeitos++;
+    uint32_t idx = md->indice[s];
+    for (uint32_t k = 0; k < md->qtdPista[p]; ++k)
+        if (md->porPista[p][k].id == idx) {
+            md->porPista[p][k].peso = peso;
+            for (uint32_t j = 0; j < md->qtdSuspeito[idx]; ++j)
+                if (md->porSuspeito[idx][j].id == md->idPista[p]) md->porSuspeito[idx][j].peso = peso;
+            return;
+        }
+    md->porPista[p][md->qtdPista[p]++] = (Postagem) { .id = idx, .peso = peso };
+    md->porSuspeito[idx][md->qtdSuspeito[idx]++] = (Postagem) { .id = md->idPista[p], .peso = peso };
+}
+
+static void conferirListas(const HashTable *ht, const Modelo *md, size_t passo) {
+    VERIFICAR(ht->numSuspeitos == md->numSuspeitos, "passo %zu: %u suspeitos, esperado %u",
+              passo, ht->numSuspeitos, md->numSuspeitos);
+    for (uint32_t p = 0; p < PISTAS_TESTE; ++p) {
+        const HashEntrada *e = encontrarEntrada(ht, md->idPista[p]);
+        if (md->qtdPista[p] == 0) {
+            VERIFICAR(e == NULL, "passo %zu: pista %u sem insercao na hash", passo, p);
+            continue;
+        }
+        VERIFICAR(e != NULL, "passo %zu: pista %u sumiu", passo, p);
+        VERIFICAR(e->suspeitos.quantidade == md->qtdPista[p], "passo %zu: pista %u com %u suspeitos, esperado %u",
+                  passo, p, e->suspeitos.quantidade, md->qtdPista[p]);
+        const Postagem *l = suspeitosDaPista(ht, e);
+        for (uint32_t k = 0; k < md->qtdPista[p]; ++k)
+            VERIFICAR(l[k].id == md->porPista[p][k].id && l[k].peso == md->porPista[p][k].peso,
+                      "passo %zu: pista %u, postagem %u: (%u, peso %u), esperado (%u, peso %u)", passo, p, k,
+                      l[k].id, l[k].peso, md->porPista[p][k].id, md->porPista[p][k].peso);
+    }
+    for (uint32_t s = 0; s < md->numSuspeitos; ++s) {
+        VERIFICAR(ht->pistasSuspeito[s].quantidade == md->qtdSuspeito[s], "passo %zu: suspeito %u com %u pistas, esperado %u",
+                  passo, s, ht->pistasSuspeito[s].quantidade, md->qtdSuspeito[s]);
+        const Postagem *l = pistasDoSuspeito(ht, s);
+        for (uint32_t k = 0; k < md->qtdSuspeito[s]; ++k)
+            VERIFICAR(l[k].id == md->porSuspeito[s][k].id && l[k].peso == md->porSuspeito[s][k].peso,
+                      "passo %zu: suspeito %u, postagem %u: (%u, peso %u), esperado (%u, peso %u)", passo, s, k,
+                      l[k].id, l[k].peso, md->porSuspeito[s][k].id, md->porSuspeito[s][k].peso);
+    }
+}
+
+int main(void) {
+    inicializarSementeHash();
+    InternPool textos;
+    inicializarInternos(&textos);
+    static Modelo md;
+    char buf[32];
+    for (uint32_t p = 0; p < PISTAS_TESTE; ++p) {
+        snprintf(buf, sizeof buf, "pista %u", p);
+        md.idPista[p] = internar(&textos, buf, MAXPISTA);
+    }
+    // nomes ja em minusculas: o id do nome serve de chave
+    for (uint32_t s = 0; s < SUSPEITOS_TESTE; ++s) {
+        snprintf(buf, sizeof buf, "suspeito %u", s);
+        md.idSuspeito[s] = internar(&textos, buf, MAXNOME);
+        md.indice[s] = UINT32_MAX;
+    }
+
+    HashTable ht;
+    inicializarHash(&ht, &textos);
+    size_t recolhidasPistas = 0, recolhidasSuspeitos = 0;
+    for (size_t n = 0; n < INSERCOES_TESTE; ++n) {
+        // poucas pistas e suspeitos "quentes": listas longas, que crescem varias vezes
+        uint32_t p = (uint32_t) (proximoPostagens() % (proximoPostagens() % 4 == 0 ? PISTAS_TESTE : 40));
+        uint32_t s = (uint32_t) (proximoPostagens() % (proximoPostagens() % 4 == 0 ? SUSPEITOS_TESTE : 12));
+        uint32_t peso = (uint32_t) (proximoPostagens() % 5);
+        uint32_t lixoPistas = ht.postagensPistas.lixo, lixoSuspeitos = ht.postagensSuspeitos.lixo;
+        inserirNaHashId(&ht, md.idPista[p], md.idSuspeito[s], md.idSuspeito[s], peso);
+        inserirNoModelo(&md, p, s, peso);
+        int recolheu = 0;
+        if (ht.postagensPistas.lixo < lixoPistas) { recolhidasPistas++; recolheu = 1; }
+        if (ht.postagensSuspeitos.lixo < lixoSuspeitos) { recolhidasSuspeitos++; recolheu = 1; }
+        if (recolheu || n % 1000 == 0) conferirListas(&ht, &md, n);
+    }
+    conferirListas(&ht, &md, INSERCOES_TESTE);
+    VERIFICAR(recolhidasPistas > 0, "o lixo das listas de pistas nunca foi recolhido");
+    VERIFICAR(recolhidasSuspeitos > 0, "o lixo das listas de suspeitos nunca foi recolhido");
+
+    liberarHash(&ht);
+    liberarInternos(&textos);
+    verificarSemVazamentos();
+    printf("teste_postagens: ok (%zu + %zu recolhimentos)\n", recolhidasPistas, recolhidasSuspeitos);
+    return 0;
+}